@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace bench
+{
+    // Set from the command line, only benchmarks containing this are run.
+    inline std::string filter = "";
+
+    inline bool enabled(const char* name)
+    {
+        return filter.empty() || std::strstr(name, filter.c_str()) != nullptr;
+    }
+
+    /**
+     * @brief Runs fn repeatedly for at least minSeconds and returns the average seconds per run.
+     */
+    template <typename Fn>
+    double measure(Fn &&fn, double minSeconds = 0.5)
+    {
+        using clock = std::chrono::steady_clock;
+
+        // Warm up caches and any lazily initialised state.
+        fn();
+
+        size_t runs = 0;
+        auto start = clock::now();
+        double elapsed = 0;
+        do
+        {
+            fn();
+            runs++;
+            elapsed = std::chrono::duration<double>(clock::now() - start).count();
+        } while (elapsed < minSeconds);
+
+        return elapsed / runs;
+    }
+
+    /**
+     * @brief Prints a single result line, bytes and items are per run.
+     */
+    inline void report(const char* name, double seconds, double bytes, double items, const char* itemName)
+    {
+        printf("%-52s %10.3f ms %10.2f MB/s %14.0f %s/s\n",
+            name, seconds * 1000.0, bytes / seconds / (1024.0 * 1024.0), items / seconds, itemName);
+    }
+
+    // Keeps the optimiser from throwing away results.
+    template <typename T>
+    void doNotOptimize(const T &value)
+    {
+        static volatile const void* sink;
+        sink = &value;
+    }
+} // namespace bench
+
+void runReaderBenchmarks();
+void runWriterBenchmarks();
@@ -1,5 +1,13 @@
+/**
+ * @file buffer.hpp
+ * @brief The buffer class HMLanguages and the tools used before BinaryIO, kept as the baseline.
+ */
+
 #pragma once
 
+#include <climits>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <string>
 #include <vector>
@@ -8,11 +16,9 @@
 class buffer {
 	std::vector<char> buff;
 
-	template <typename>
-	struct is_string_type : std::false_type {};
-
-	template <>
-	struct is_string_type<std::string> : std::true_type {};
+	// Was an explicit specialisation in class scope, which only MSVC accepts.
+	template <typename T>
+	struct is_string_type : std::is_same<T, std::string> {};
 
 	template <typename>
 	struct is_vector_type : std::false_type {};
@@ -0,0 +1,12 @@
+#include "bench.hpp"
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1)
+        bench::filter = argv[1];
+
+    runReaderBenchmarks();
+    runWriterBenchmarks();
+
+    return 0;
+}
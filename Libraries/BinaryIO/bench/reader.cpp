@@ -0,0 +1,236 @@
+#include "bench.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <TonyTools/BinaryIO.h>
+
+#include "legacy/buffer.hpp"
+
+using TonyTools::BinaryIO::Reader;
+
+namespace
+{
+    // Mimics the files the library reads: a table of records (hash, size, string, null),
+    // a count prefixed u32 array, and a run of null terminated strings.
+    struct Corpus
+    {
+        std::vector<char> records;
+        std::vector<char> array;
+        std::vector<char> strings;
+        size_t recordCount = 0;
+        size_t arrayCount = 0;
+        size_t stringCount = 0;
+    };
+
+    template <typename T>
+    void append(std::vector<char> &out, T value)
+    {
+        out.insert(out.end(), (const char*)&value, (const char*)&value + sizeof(T));
+    }
+
+    Corpus makeCorpus(size_t count)
+    {
+        std::mt19937 rng(0x42494E49);
+        std::uniform_int_distribution<size_t> length(4, 96);
+        std::uniform_int_distribution<int> letter('a', 'z');
+
+        Corpus corpus;
+        for (size_t i = 0; i < count; i++)
+        {
+            std::string str(length(rng), ' ');
+            for (char &c : str)
+                c = (char)letter(rng);
+
+            append<uint32_t>(corpus.records, (uint32_t)rng());
+            append<uint32_t>(corpus.records, (uint32_t)str.size());
+            corpus.records.insert(corpus.records.end(), str.begin(), str.end());
+            corpus.records.push_back('\0');
+
+            corpus.strings.insert(corpus.strings.end(), str.begin(), str.end());
+            corpus.strings.push_back('\0');
+        }
+
+        corpus.recordCount = count;
+        corpus.stringCount = count;
+
+        corpus.arrayCount = count * 4;
+        append<uint32_t>(corpus.array, (uint32_t)corpus.arrayCount);
+        for (size_t i = 0; i < corpus.arrayCount; i++)
+            append<uint32_t>(corpus.array, (uint32_t)rng());
+
+        return corpus;
+    }
+
+    void check(bool ok, const char* what)
+    {
+        if (!ok)
+        {
+            fprintf(stderr, "[BENCH] BinaryIO %s check failed!\n", what);
+            std::exit(1);
+        }
+    }
+} // namespace
+
+void runReaderBenchmarks()
+{
+    const size_t count = 200000;
+    Corpus corpus = makeCorpus(count);
+
+    printf("Reader (%zu records, %.2f MB)\n", count, corpus.records.size() / (1024.0 * 1024.0));
+
+    // The legacy buffer copies the data it is given, so that copy is part of every legacy read.
+    if (bench::enabled("reader/u32/legacy"))
+    {
+        double t = bench::measure([&] {
+            buffer buff(corpus.array);
+            uint32_t sum = 0;
+            while (buff.index != buff.size())
+                sum += buff.read<uint32_t>();
+            bench::doNotOptimize(sum);
+        });
+        bench::report("reader/u32/legacy", t, corpus.array.size(), corpus.array.size() / 4, "values");
+    }
+
+    if (bench::enabled("reader/u32/binaryio"))
+    {
+        double t = bench::measure([&] {
+            Reader buff(corpus.array);
+            uint32_t sum = 0;
+            while (!buff.atEnd())
+                sum += buff.read<uint32_t>();
+            bench::doNotOptimize(sum);
+        });
+        bench::report("reader/u32/binaryio", t, corpus.array.size(), corpus.array.size() / 4, "values");
+    }
+
+    if (bench::enabled("reader/vector/legacy"))
+    {
+        double t = bench::measure([&] {
+            buffer buff(corpus.array);
+            std::vector<uint32_t> values = buff.read<std::vector<uint32_t>>();
+            bench::doNotOptimize(values);
+        });
+        bench::report("reader/vector/legacy", t, corpus.array.size(), corpus.arrayCount, "values");
+    }
+
+    if (bench::enabled("reader/vector/binaryio"))
+    {
+        double t = bench::measure([&] {
+            Reader buff(corpus.array);
+            std::vector<uint32_t> values = buff.readVector<uint32_t>();
+            bench::doNotOptimize(values);
+        });
+        bench::report("reader/vector/binaryio", t, corpus.array.size(), corpus.arrayCount, "values");
+    }
+
+    if (bench::enabled("reader/string/legacy"))
+    {
+        double t = bench::measure([&] {
+            buffer buff(corpus.strings);
+            for (size_t i = 0; i < corpus.stringCount; i++)
+            {
+                std::string str = buff.read<std::string>();
+                bench::doNotOptimize(str);
+            }
+        });
+        bench::report("reader/string/legacy", t, corpus.strings.size(), corpus.stringCount, "strings");
+    }
+
+    if (bench::enabled("reader/string/binaryio"))
+    {
+        double t = bench::measure([&] {
+            Reader buff(corpus.strings);
+            for (size_t i = 0; i < corpus.stringCount; i++)
+            {
+                std::string str = buff.readString();
+                bench::doNotOptimize(str);
+            }
+        });
+        bench::report("reader/string/binaryio", t, corpus.strings.size(), corpus.stringCount, "strings");
+    }
+
+    if (bench::enabled("reader/string-view/binaryio"))
+    {
+        double t = bench::measure([&] {
+            Reader buff(corpus.strings);
+            for (size_t i = 0; i < corpus.stringCount; i++)
+            {
+                std::string_view str = buff.readStringView();
+                bench::doNotOptimize(str);
+            }
+        });
+        bench::report("reader/string-view/binaryio", t, corpus.strings.size(), corpus.stringCount, "strings");
+    }
+
+    // How LOCR is read: the hash and size, then the string is skipped over and decrypted in place later.
+    if (bench::enabled("reader/records/legacy"))
+    {
+        double t = bench::measure([&] {
+            buffer buff(corpus.records);
+            uint32_t sum = 0;
+            for (size_t i = 0; i < corpus.recordCount; i++)
+            {
+                sum += buff.read<uint32_t>();
+                uint32_t size = buff.read<uint32_t>();
+                buff.index += size + 1;
+            }
+            bench::doNotOptimize(sum);
+        });
+        bench::report("reader/records/legacy", t, corpus.records.size(), corpus.recordCount, "records");
+    }
+
+    if (bench::enabled("reader/records/binaryio"))
+    {
+        double t = bench::measure([&] {
+            Reader buff(corpus.records);
+            uint32_t sum = 0;
+            for (size_t i = 0; i < corpus.recordCount; i++)
+            {
+                sum += buff.read<uint32_t>();
+                uint32_t size = buff.read<uint32_t>();
+                buff.skip(size + 1);
+            }
+            bench::doNotOptimize(sum);
+        });
+        bench::report("reader/records/binaryio", t, corpus.records.size(), corpus.recordCount, "records");
+    }
+
+    // Sanity check against the legacy buffer.
+    buffer legacyArray(corpus.array);
+    Reader array(corpus.array);
+    check(legacyArray.read<std::vector<uint32_t>>() == array.readVector<uint32_t>(), "readVector");
+
+    buffer legacyStrings(corpus.strings);
+    Reader strings(corpus.strings);
+    for (size_t i = 0; i < corpus.stringCount; i++)
+        check(legacyStrings.read<std::string>() == strings.readString(), "readString");
+    check(strings.atEnd(), "readString");
+
+    buffer legacyRecords(corpus.records);
+    Reader records(corpus.records);
+    for (size_t i = 0; i < corpus.recordCount; i++)
+    {
+        check(legacyRecords.read<uint32_t>() == records.read<uint32_t>(), "read");
+        uint32_t size = legacyRecords.read<uint32_t>();
+        check(size == records.read<uint32_t>(), "read");
+        legacyRecords.index += size + 1;
+        records.skip(size + 1);
+    }
+    check(records.atEnd(), "skip");
+
+    // Reads past the end must throw rather than read out of bounds.
+    bool threw = false;
+    try
+    {
+        Reader(corpus.array.data(), 2).read<uint32_t>();
+    }
+    catch (const std::out_of_range &)
+    {
+        threw = true;
+    }
+    check(threw, "bounds check");
+}
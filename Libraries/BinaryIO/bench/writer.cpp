@@ -0,0 +1,193 @@
+#include "bench.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <TonyTools/BinaryIO.h>
+
+#include "legacy/buffer.hpp"
+
+using TonyTools::BinaryIO::Writer;
+
+namespace
+{
+    struct Record
+    {
+        uint32_t hash;
+        std::string str;
+    };
+
+    std::vector<Record> makeRecords(size_t count, size_t &bytes)
+    {
+        std::mt19937 rng(0x42494E4F);
+        std::uniform_int_distribution<size_t> length(4, 96);
+        std::uniform_int_distribution<int> letter('a', 'z');
+
+        std::vector<Record> records;
+        bytes = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            std::string str(length(rng), ' ');
+            for (char &c : str)
+                c = (char)letter(rng);
+
+            bytes += 8 + str.size() + 1;
+            records.push_back({(uint32_t)rng(), std::move(str)});
+        }
+
+        return records;
+    }
+
+    // How the legacy buffer was used: written, then copied out with data().
+    std::vector<char> legacyWriteRecords(const std::vector<Record> &records)
+    {
+        buffer buff;
+        for (const Record &record : records)
+        {
+            buff.write<uint32_t>(record.hash);
+            buff.write<uint32_t>(record.str.size());
+            buff.write<std::string>(record.str);
+        }
+
+        return buff.data();
+    }
+
+    void writeRecords(Writer &buff, const std::vector<Record> &records)
+    {
+        for (const Record &record : records)
+        {
+            buff.write<uint32_t>(record.hash);
+            buff.write<uint32_t>(record.str.size());
+            buff.writeString(record.str);
+        }
+    }
+
+    void check(bool ok, const char* what)
+    {
+        if (!ok)
+        {
+            fprintf(stderr, "[BENCH] BinaryIO %s output does not match the legacy buffer!\n", what);
+            std::exit(1);
+        }
+    }
+} // namespace
+
+void runWriterBenchmarks()
+{
+    const size_t count = 200000;
+    size_t bytes = 0;
+    std::vector<Record> records = makeRecords(count, bytes);
+
+    std::vector<uint32_t> values(count * 4);
+    for (size_t i = 0; i < values.size(); i++)
+        values[i] = (uint32_t)(i * 2654435761u);
+
+    printf("Writer (%zu records, %.2f MB)\n", count, bytes / (1024.0 * 1024.0));
+
+    if (bench::enabled("writer/u32/legacy"))
+    {
+        double t = bench::measure([&] {
+            buffer buff;
+            for (uint32_t value : values)
+                buff.write<uint32_t>(value);
+            std::vector<char> out = buff.data();
+            bench::doNotOptimize(out);
+        });
+        bench::report("writer/u32/legacy", t, values.size() * 4, values.size(), "values");
+    }
+
+    if (bench::enabled("writer/u32/binaryio"))
+    {
+        double t = bench::measure([&] {
+            std::vector<char> out;
+            Writer buff(out);
+            for (uint32_t value : values)
+                buff.write<uint32_t>(value);
+            bench::doNotOptimize(out);
+        });
+        bench::report("writer/u32/binaryio", t, values.size() * 4, values.size(), "values");
+    }
+
+    if (bench::enabled("writer/u32/binaryio-reserved"))
+    {
+        double t = bench::measure([&] {
+            std::vector<char> out;
+            Writer buff(out);
+            buff.reserve(values.size() * 4);
+            for (uint32_t value : values)
+                buff.write<uint32_t>(value);
+            bench::doNotOptimize(out);
+        });
+        bench::report("writer/u32/binaryio-reserved", t, values.size() * 4, values.size(), "values");
+    }
+
+    if (bench::enabled("writer/vector/legacy"))
+    {
+        double t = bench::measure([&] {
+            buffer buff;
+            buff.write<std::vector<uint32_t>>(values);
+            std::vector<char> out = buff.data();
+            bench::doNotOptimize(out);
+        });
+        bench::report("writer/vector/legacy", t, values.size() * 4, values.size(), "values");
+    }
+
+    if (bench::enabled("writer/vector/binaryio"))
+    {
+        double t = bench::measure([&] {
+            std::vector<char> out;
+            Writer buff(out);
+            buff.writeVector(values);
+            bench::doNotOptimize(out);
+        });
+        bench::report("writer/vector/binaryio", t, values.size() * 4, values.size(), "values");
+    }
+
+    if (bench::enabled("writer/records/legacy"))
+    {
+        double t = bench::measure([&] {
+            std::vector<char> out = legacyWriteRecords(records);
+            bench::doNotOptimize(out);
+        });
+        bench::report("writer/records/legacy", t, bytes, count, "records");
+    }
+
+    if (bench::enabled("writer/records/binaryio"))
+    {
+        double t = bench::measure([&] {
+            std::vector<char> out;
+            Writer buff(out);
+            writeRecords(buff, records);
+            bench::doNotOptimize(out);
+        });
+        bench::report("writer/records/binaryio", t, bytes, count, "records");
+    }
+
+    // The same output vector written over and over, as the RebuildInto functions do.
+    if (bench::enabled("writer/records/binaryio-reused"))
+    {
+        std::vector<char> out;
+        double t = bench::measure([&] {
+            out.clear();
+            Writer buff(out);
+            writeRecords(buff, records);
+            bench::doNotOptimize(out);
+        });
+        bench::report("writer/records/binaryio-reused", t, bytes, count, "records");
+    }
+
+    // Sanity check against the legacy buffer.
+    std::vector<char> out;
+    Writer buff(out);
+    writeRecords(buff, records);
+    check(out == legacyWriteRecords(records), "record");
+
+    buffer legacy;
+    legacy.write<std::vector<uint32_t>>(values);
+    out.clear();
+    buff.writeVector(values);
+    check(out == legacy.data(), "writeVector");
+}
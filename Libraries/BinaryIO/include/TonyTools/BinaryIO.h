@@ -0,0 +1,330 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace TonyTools
+{
+namespace BinaryIO
+{
+    /**
+     * @brief Any type that can be read/written by copying its bytes (ints, enums, packed structs, etc.).
+     */
+    template <typename T>
+    concept Trivial = std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>;
+
+    /**
+     * @brief Reads binary data from memory owned by someone else (a file loaded with ReadFile, a span from the caller, etc.).
+     *
+     * Nothing is copied unless asked for. Every read is checked against the end of the data and
+     * throws std::out_of_range instead of reading past it.
+     */
+    class Reader
+    {
+    public:
+        /**
+         * @brief The current read position. It can be moved freely, reads check it.
+         */
+        size_t index = 0;
+
+        Reader() = default;
+
+        explicit Reader(std::span<const char> data) : view(data) {}
+
+        Reader(const void* data, size_t size) : view(static_cast<const char*>(data), size) {}
+
+        size_t size() const { return view.size(); }
+        const char* data() const { return view.data(); }
+
+        /**
+         * @brief The number of bytes left after the current position.
+         */
+        size_t remaining() const { return index < view.size() ? view.size() - index : 0; }
+
+        bool atEnd() const { return index >= view.size(); }
+
+        template <Trivial T>
+        T read()
+        {
+            T value = readAt<T>(index);
+            index += sizeof(T);
+            return value;
+        }
+
+        template <Trivial T>
+        T peek() const
+        {
+            return readAt<T>(index);
+        }
+
+        /**
+         * @brief Reads a value at the given offset without moving the current position.
+         */
+        template <Trivial T>
+        T readAt(size_t offset) const
+        {
+            require(offset, 1, sizeof(T));
+
+            T value;
+            std::memcpy(&value, view.data() + offset, sizeof(T));
+            return value;
+        }
+
+        /**
+         * @brief Reads count values with a single copy.
+         */
+        template <Trivial T>
+        std::vector<T> readArray(size_t count)
+        {
+            std::vector<T> values = readArrayAt<T>(index, count);
+            index += count * sizeof(T);
+            return values;
+        }
+
+        /**
+         * @brief Reads count values at the given offset without moving the current position.
+         */
+        template <Trivial T>
+        std::vector<T> readArrayAt(size_t offset, size_t count) const
+        {
+            require(offset, count, sizeof(T));
+
+            std::vector<T> values(count);
+            if (count)
+                std::memcpy(values.data(), view.data() + offset, count * sizeof(T));
+            return values;
+        }
+
+        /**
+         * @brief Reads a Count prefixed array, the format Writer::writeVector writes.
+         */
+        template <Trivial T, Trivial Count = uint32_t>
+        std::vector<T> readVector()
+        {
+            return readArray<T>(read<Count>());
+        }
+
+        /**
+         * @brief Reads a null terminated string, the position is moved past the null.
+         */
+        std::string readString()
+        {
+            return std::string(readStringView());
+        }
+
+        /**
+         * @brief Same as readString, but the string points into the data instead of being copied.
+         */
+        std::string_view readStringView()
+        {
+            std::string_view str = readStringViewAt(index);
+            index += str.size() + 1;
+            return str;
+        }
+
+        /**
+         * @brief Reads a null terminated string at the given offset without moving the current position.
+         */
+        std::string readStringAt(size_t offset) const
+        {
+            return std::string(readStringViewAt(offset));
+        }
+
+        std::string_view readStringViewAt(size_t offset) const
+        {
+            require(offset, 1, 1);
+
+            const char* start = view.data() + offset;
+            const void* end = std::memchr(start, '\0', view.size() - offset);
+            if (!end)
+                throw std::out_of_range("BinaryIO: string is not terminated before the end of the data");
+
+            return std::string_view(start, static_cast<const char*>(end) - start);
+        }
+
+        /**
+         * @brief Returns the next count bytes without copying them and moves past them.
+         */
+        std::span<const char> bytes(size_t count)
+        {
+            require(index, count, 1);
+
+            std::span<const char> result = view.subspan(index, count);
+            index += count;
+            return result;
+        }
+
+        void skip(size_t count)
+        {
+            require(index, count, 1);
+            index += count;
+        }
+
+        /**
+         * @brief Creates a reader over part of the data, its offsets start at 0.
+         */
+        Reader sub(size_t offset, size_t size) const
+        {
+            require(offset, size, 1);
+            return Reader(view.subspan(offset, size));
+        }
+
+    private:
+        std::span<const char> view;
+
+        void require(size_t offset, size_t count, size_t elementSize) const
+        {
+            // Written so count * elementSize can't overflow.
+            if (offset > view.size() || count > (view.size() - offset) / elementSize)
+                throw std::out_of_range("BinaryIO: read past the end of the data");
+        }
+    };
+
+    /**
+     * @brief Appends binary data to a vector owned by the caller, so the result never has to be copied out.
+     *
+     * The vector grows by at least doubling, reserve can be used up front when the final size is known.
+     */
+    class Writer
+    {
+    public:
+        explicit Writer(std::vector<char> &out) : out(out) {}
+
+        size_t size() const { return out.size(); }
+        char* data() { return out.data(); }
+        const char* data() const { return out.data(); }
+
+        /**
+         * @brief Makes sure the output can hold size bytes in total without growing again.
+         */
+        void reserve(size_t size)
+        {
+            out.reserve(size);
+        }
+
+        template <Trivial T>
+        void write(const T &value)
+        {
+            writeRaw(&value, sizeof(T));
+        }
+
+        /**
+         * @brief Overwrites an already written value, used to fill in offsets and sizes once they are known.
+         */
+        template <Trivial T>
+        void writeAt(size_t offset, const T &value)
+        {
+            if (offset > out.size() || sizeof(T) > out.size() - offset)
+                throw std::out_of_range("BinaryIO: write past the end of the data");
+
+            std::memcpy(out.data() + offset, &value, sizeof(T));
+        }
+
+        /**
+         * @brief Writes the values with a single copy, prefixed with their Count.
+         */
+        template <Trivial T, Trivial Count = uint32_t>
+        void writeVector(std::span<const T> values)
+        {
+            write<Count>(static_cast<Count>(values.size()));
+            writeRaw(values.data(), values.size_bytes());
+        }
+
+        template <Trivial T, Trivial Count = uint32_t>
+        void writeVector(const std::vector<T> &values)
+        {
+            writeVector<T, Count>(std::span<const T>(values));
+        }
+
+        /**
+         * @brief Writes a string followed by a null.
+         */
+        void writeString(std::string_view str)
+        {
+            grow(str.size() + 1);
+            out.insert(out.end(), str.begin(), str.end());
+            out.push_back('\0');
+        }
+
+        void writeRaw(const void* ptr, size_t size)
+        {
+            grow(size);
+
+            const char* bytes = static_cast<const char*>(ptr);
+            out.insert(out.end(), bytes, bytes + size);
+        }
+
+        /**
+         * @brief Writes count copies of value, returns the offset they start at (for writeAt).
+         */
+        size_t pad(size_t count, char value = '\0')
+        {
+            size_t offset = out.size();
+
+            grow(count);
+            out.insert(out.end(), count, value);
+            return offset;
+        }
+
+    private:
+        std::vector<char> &out;
+
+        void grow(size_t count)
+        {
+            size_t needed = out.size() + count;
+            if (needed > out.capacity())
+                out.reserve(std::max(needed, out.capacity() * 2));
+        }
+    };
+
+    /**
+     * @brief Reads a whole file into memory.
+     *
+     * @param path Path to the file.
+     * @return std::vector<char> The file data, empty if it couldn't be read.
+     */
+    inline std::vector<char> ReadFile(const std::filesystem::path &path)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+            return {};
+
+        std::streamsize size = file.tellg();
+        if (size <= 0)
+            return {};
+
+        std::vector<char> data(static_cast<size_t>(size));
+        file.seekg(0);
+        if (!file.read(data.data(), size))
+            return {};
+
+        return data;
+    }
+
+    /**
+     * @brief Writes data to a file, replacing it if it exists.
+     *
+     * @param path Path to the file.
+     * @param data The data to write.
+     * @return bool representing if the file was written.
+     */
+    inline bool WriteFile(const std::filesystem::path &path, std::span<const char> data)
+    {
+        std::ofstream file(path, std::ios::out | std::ios::binary);
+        if (!file)
+            return false;
+
+        file.write(data.data(), data.size());
+        return static_cast<bool>(file);
+    }
+} // namespace BinaryIO
+} // namespace TonyTools
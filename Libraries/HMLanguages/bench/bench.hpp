@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace bench
+{
+    // Set from the command line, only benchmarks containing this are run.
+    inline std::string filter = "";
+
+    // The size of each kind of file in the generated corpus, and its seed (--corpus and --seed).
+    inline size_t corpusMB = 4;
+    inline uint64_t seed = 0x484D4C43;
+
+    inline bool enabled(const char* name)
+    {
+        return filter.empty() || std::strstr(name, filter.c_str()) != nullptr;
+    }
+
+    /**
+     * @brief Runs fn repeatedly for at least minSeconds and returns the average seconds per run.
+     */
+    template <typename Fn>
+    double measure(Fn &&fn, double minSeconds = 0.5)
+    {
+        using clock = std::chrono::steady_clock;
+
+        // Warm up caches and any lazily initialised state.
+        fn();
+
+        size_t runs = 0;
+        auto start = clock::now();
+        double elapsed = 0;
+        do
+        {
+            fn();
+            runs++;
+            elapsed = std::chrono::duration<double>(clock::now() - start).count();
+        } while (elapsed < minSeconds);
+
+        return elapsed / runs;
+    }
+
+    /**
+     * @brief Prints a single result line, bytes and items are per run.
+     */
+    inline void report(const char* name, double seconds, double bytes, double items, const char* itemName)
+    {
+        printf("%-52s %10.3f ms %10.2f MB/s %14.0f %s/s\n",
+            name, seconds * 1000.0, bytes / seconds / (1024.0 * 1024.0), items / seconds, itemName);
+    }
+
+    // The most memory the process has used so far.
+    size_t peakRSS();
+
+    // Keeps the optimiser from throwing away results.
+    template <typename T>
+    void doNotOptimize(const T &value)
+    {
+        static volatile const void* sink;
+        sink = &value;
+    }
+} // namespace bench
+
+void runCorpusBenchmarks();
+void runDLGEBenchmarks();
+void runDocumentBenchmarks();
+void runGamesBenchmarks();
+void runHashListBenchmarks();
+void runHexBenchmarks();
+void runLangMapBenchmarks();
+void runRTLVBenchmarks();
+void runSymmetricBenchmarks();
+void runXteaBenchmarks();
@@ -0,0 +1,503 @@
+#include "bench.hpp"
+#include "corpus.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <format>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace TonyTools::Language;
+
+namespace
+{
+    // Only the raw output of the engine is used, the distributions differ between standard libraries.
+    class Random
+    {
+    public:
+        explicit Random(uint64_t seed) : engine(seed) {}
+
+        size_t below(size_t n) { return (size_t)(engine() % n); }
+        size_t between(size_t min, size_t max) { return min + below(max - min + 1); }
+        bool chance(unsigned percent) { return below(100) < percent; }
+        uint64_t bits(unsigned count) { return engine() >> (64 - count); }
+
+    private:
+        std::mt19937_64 engine;
+    };
+
+    constexpr const char* words[] = {"alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf", "hotel",
+                                     "india", "juliet", "kilo", "lima", "mike", "november", "oscar", "papa"};
+
+    // Subtitle-like text, now and then with non-ASCII characters and characters JSON has to escape.
+    std::string makeText(Random &random, size_t minWords, size_t maxWords)
+    {
+        std::string text;
+        for (size_t i = 0, count = random.between(minWords, maxWords); i < count; i++)
+        {
+            if (i)
+                text += ' ';
+            text += words[random.below(std::size(words))];
+        }
+
+        if (random.chance(15))
+            text += " \xC3\xA9\xE4\xB8\xAD\xF0\x9F\x98\x80"; // é中😀
+        if (random.chance(5))
+            text += " \"quote\" \\ <i>\n\t</i>";
+
+        return text;
+    }
+
+    void appendString(std::string &json, std::string_view str)
+    {
+        json += '"';
+        for (char c : str)
+        {
+            switch (c)
+            {
+            case '"':
+                json += "\\\"";
+                break;
+            case '\\':
+                json += "\\\\";
+                break;
+            case '\n':
+                json += "\\n";
+                break;
+            case '\t':
+                json += "\\t";
+                break;
+            default:
+                json += c;
+            }
+        }
+        json += '"';
+    }
+
+    std::string hex8(Random &random) { return std::format("{:08X}", (uint32_t)random.bits(32)); }
+    std::string hex16(Random &random) { return std::format("00{:014X}", random.bits(56)); }
+
+    // Two hashes in a fixed order (the order function arguments are evaluated in isn't).
+    std::pair<std::string, std::string> hex16Pair(Random &random)
+    {
+        std::string first = hex16(random);
+        return {std::move(first), hex16(random)};
+    }
+
+    std::span<const std::string> languagesOf(const corpus::Kind &kind)
+    {
+        return LanguageMap::BuiltIn(kind.version, kind.type == corpus::Type::DLGE).languages();
+    }
+
+    // Localisation files, a few hundred strings in every language, some languages left empty.
+    std::string makeLOCR(const corpus::Kind &kind, Random &random, size_t id, size_t &strings)
+    {
+        std::string json = std::format(R"({{"hash":"[assets/localization/bench/bench_{}.sweetmenutext].pc_localized-textlist","languages":{{)", id);
+
+        std::span<const std::string> languages = languagesOf(kind);
+        for (size_t l = 0; l < languages.size(); l++)
+        {
+            json += std::format(R"({}"{}":{{)", l ? "," : "", languages[l]);
+
+            size_t count = l && random.chance(10) ? 0 : random.between(50, 400);
+            for (size_t i = 0; i < count; i++)
+            {
+                json += std::format(R"({}"{}":)", i ? "," : "", hex8(random));
+                appendString(json, makeText(random, 1, 20));
+            }
+            strings += count;
+
+            json += '}';
+        }
+
+        return json + "}}";
+    }
+
+    struct DLGEWriter
+    {
+        const corpus::Kind &kind;
+        Random &random;
+        std::string json;
+        size_t strings = 0;
+
+        // Named WavFiles have their wav and FaceFX as paths, so their names get recovered when converting.
+        void wavFile(const std::string &extra)
+        {
+            std::string name = words[random.below(std::size(words))];
+            name += std::format("_{}", random.below(100000));
+            bool named = random.chance(60);
+
+            json += R"({"type":"WavFile","wavName":)";
+            appendString(json, named ? name : hex8(random));
+            json += std::format(R"(,"soundtag":"{}",)", hex8(random));
+            if (named)
+                json += std::format(R"("defaultWav":"[assets/sound/wwise/originals/voices/english(us)/{}.wav].pc_wes",)"
+                                    R"("defaultFfx":"[assets/animations/facefx/{}.animset].pc_animset",)", name, name);
+            else
+            {
+                auto [wav, ffx] = hex16Pair(random);
+                json += std::format(R"("defaultWav":"{}","defaultFfx":"{}",)", wav, ffx);
+            }
+
+            json += R"("languages":{)";
+            bool first = true;
+            for (const std::string &language : languagesOf(kind))
+            {
+                bool isDefault = language == "en";
+                unsigned roll = (unsigned)random.below(100);
+                if (!isDefault && roll < 30)
+                    continue;
+
+                json += std::format(R"({}"{}":)", first ? "" : ",", language);
+                first = false;
+
+                if (isDefault || roll < 60)
+                {
+                    appendString(json, makeText(random, 1, 25));
+                    strings++;
+                    continue;
+                }
+
+                auto [wav, ffx] = hex16Pair(random);
+                json += std::format(R"({{"wav":"{}","ffx":"{}")", wav, ffx);
+                if (random.chance(50))
+                {
+                    json += R"(,"subtitle":)";
+                    appendString(json, makeText(random, 1, 25));
+                    strings++;
+                }
+                json += '}';
+            }
+
+            json += '}' + extra + '}';
+        }
+
+        void randomContainer(const std::string &extra)
+        {
+            json += R"({"type":"Random","containers":[)";
+            for (size_t i = 0, count = random.between(2, 4); i < count; i++)
+            {
+                if (i)
+                    json += ',';
+
+                // Weights are written as hex when converting with hex precision, both are accepted.
+                wavFile(random.chance(50) ? std::format(R"(,"weight":"{:06X}")", random.between(1, 0xFFFFFF))
+                                          : std::format(R"(,"weight":{})", 1.0 / (double)random.between(1, 8)));
+            }
+            json += ']' + extra + '}';
+        }
+
+        std::string cases()
+        {
+            std::string cases = R"(,"cases":[)";
+            for (size_t i = 0, count = random.between(1, 3); i < count; i++)
+                cases += std::format(R"({}"{}")", i ? "," : "", hex8(random));
+            return cases + ']';
+        }
+
+        void switchContainer()
+        {
+            std::string switchKey = hex8(random);
+            json += std::format(R"({{"type":"Switch","switchKey":"{}","default":"{}","containers":[)", switchKey, hex8(random));
+            for (size_t i = 0, count = random.between(2, 5); i < count; i++)
+            {
+                if (i)
+                    json += ',';
+
+                if (random.chance(60))
+                    randomContainer(cases());
+                else
+                    wavFile(cases());
+            }
+            json += "]}";
+        }
+    };
+
+    // Dialogue events, a Sequence of WavFiles and Random containers, with a Switch (at most one is allowed) in half of them.
+    std::string makeDLGE(const corpus::Kind &kind, Random &random, size_t id, size_t &strings)
+    {
+        DLGEWriter writer{kind, random, {}};
+        auto [ditl, clng] = hex16Pair(random);
+        writer.json = std::format(R"({{"hash":"[assets/dialogueevents/bench/bench_{}.dlge].pc_dialogevent","DITL":"{}","CLNG":"{}",)"
+                                  R"("rootContainer":{{"type":"Sequence","containers":[)", id, ditl, clng);
+
+        size_t count = random.between(1, 6);
+        size_t switchAt = random.chance(50) ? random.below(count) : count;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (i)
+                writer.json += ',';
+
+            if (i == switchAt)
+                writer.switchContainer();
+            else if (random.chance(50))
+                writer.randomContainer("");
+            else
+                writer.wavFile("");
+        }
+
+        strings += writer.strings;
+        return writer.json + "]}}";
+    }
+
+    // Soundtag lists, the soundtags of a scene pointing at their dialogue events.
+    std::string makeDITL(Random &random, size_t id, size_t &strings)
+    {
+        std::string json = std::format(R"({{"hash":"[assets/sound/bench/bench_{}.ditl].pc_soundtaglist","soundtags":{{)", id);
+
+        size_t count = random.between(20, 400);
+        for (size_t i = 0; i < count; i++)
+        {
+            json += std::format(R"({}"{}":)", i ? "," : "", hex8(random));
+            if (random.chance(50))
+                json += std::format(R"("[assets/dialogueevents/bench/bench_{}.dlge].pc_dialogevent")", random.below(100000));
+            else
+                json += std::format(R"("{}")", hex16(random));
+        }
+        strings += count;
+
+        return json + "}}";
+    }
+
+    // Language lists, a flag for every language.
+    std::string makeCLNG(const corpus::Kind &kind, Random &random, size_t id, size_t &strings)
+    {
+        std::string json = std::format(R"({{"hash":"[assets/sound/bench/bench_{}.clng].pc_languagelist","languages":{{)", id);
+
+        std::span<const std::string> languages = languagesOf(kind);
+        for (size_t l = 0; l < languages.size(); l++)
+            json += std::format(R"({}"{}":{})", l ? "," : "", languages[l], random.chance(50) ? "true" : "false");
+        strings += languages.size();
+
+        return json + "}}";
+    }
+
+    // Localised videos, a few videos and a subtitle in every language.
+    std::string makeRTLV(const corpus::Kind &kind, Random &random, size_t id, size_t &strings)
+    {
+        std::string json = std::format(R"({{"hash":"[assets/videos/bench/bench_{}.rtlv].pc_rtlv","videos":{{)", id);
+
+        std::span<const std::string> languages = languagesOf(kind);
+        size_t videos = random.between(1, 3);
+        for (size_t i = 0; i < videos; i++)
+            json += std::format(R"({}"{}":"{}")", i ? "," : "", languages[1 + i], hex16(random));
+
+        json += R"(},"subtitles":{)";
+        for (size_t l = 0; l < languages.size(); l++)
+        {
+            json += std::format(R"({}"{}":)", l ? "," : "", languages[l]);
+            appendString(json, makeText(random, 5, 30));
+        }
+        strings += languages.size();
+
+        return json + "}}";
+    }
+
+    bool rebuild(const corpus::Kind &kind, const std::string &json, Rebuilt &out)
+    {
+        switch (kind.type)
+        {
+        case corpus::Type::CLNG:
+            return CLNG::RebuildInto(out, json);
+        case corpus::Type::DITL:
+            return DITL::RebuildInto(out, json);
+        case corpus::Type::DLGE:
+            return DLGE::RebuildInto(out, kind.version, json);
+        case corpus::Type::LOCR:
+            return LOCR::RebuildInto(out, kind.version, json, kind.symmetric);
+        default:
+            return RTLV::RebuildInto(out, kind.version, json);
+        }
+    }
+
+    bool convert(const corpus::Kind &kind, const Rebuilt &file, std::string &out)
+    {
+        switch (kind.type)
+        {
+        case corpus::Type::CLNG:
+            return CLNG::ConvertInto(out, kind.version, file.file, file.meta);
+        case corpus::Type::DITL:
+            return DITL::ConvertInto(out, file.file, file.meta);
+        case corpus::Type::DLGE:
+            return DLGE::ConvertInto(out, kind.version, file.file, file.meta, "en", true);
+        case corpus::Type::LOCR:
+            return LOCR::ConvertInto(out, kind.version, file.file, file.meta, {}, kind.symmetric);
+        default:
+            return RTLV::ConvertInto(out, kind.version, file.file, file.meta);
+        }
+    }
+
+    void check(bool ok, const std::string &what)
+    {
+        if (!ok)
+        {
+            fprintf(stderr, "[BENCH] Corpus %s check failed!\n", what.c_str());
+            std::exit(1);
+        }
+    }
+} // namespace
+
+size_t bench::peakRSS()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return (size_t)usage.ru_maxrss;
+#else
+    return (size_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+std::string corpus::Kind::name() const
+{
+    static constexpr const char* types[] = {"clng", "ditl", "dlge", "locr", "rtlv"};
+    static constexpr const char* versions[] = {"H2016", "H2", "H3"};
+
+    if (type == Type::DITL)
+        return "ditl";
+
+    return std::format("{}/{}{}", types[(int)type], versions[(int)version - (int)Version::H2016], symmetric ? "-symmetric" : "");
+}
+
+std::vector<corpus::Kind> corpus::kinds()
+{
+    std::vector<Kind> kinds;
+    for (Type type : {Type::LOCR, Type::DLGE, Type::DITL, Type::CLNG, Type::RTLV})
+    {
+        for (Version version : {Version::H2016, Version::H2, Version::H3})
+        {
+            if (type == Type::DITL && version != Version::H3)
+                continue;
+
+            kinds.push_back({type, version});
+            if (type == Type::LOCR && version == Version::H2016)
+                kinds.push_back({type, version, true});
+        }
+    }
+    return kinds;
+}
+
+std::vector<corpus::File> corpus::generate(const Kind &kind, size_t targetBytes, uint64_t seed)
+{
+    // Seeded by the kind as well, so a kind's files don't depend on which other kinds are generated.
+    std::string name = kind.name();
+    for (char c : name)
+        seed = seed * 31 + (unsigned char)c;
+    Random random(seed);
+
+    // CLNGs are a few bytes each, the count is capped so they don't take millions of files.
+    const size_t maxFiles = 20000;
+
+    std::vector<File> files;
+    size_t bytes = 0;
+    while (bytes < targetBytes && files.size() < maxFiles)
+    {
+        File file;
+        size_t id = files.size();
+        switch (kind.type)
+        {
+        case Type::CLNG:
+            file.json = makeCLNG(kind, random, id, file.strings);
+            break;
+        case Type::DITL:
+            file.json = makeDITL(random, id, file.strings);
+            break;
+        case Type::DLGE:
+            file.json = makeDLGE(kind, random, id, file.strings);
+            break;
+        case Type::LOCR:
+            file.json = makeLOCR(kind, random, id, file.strings);
+            break;
+        case Type::RTLV:
+            file.json = makeRTLV(kind, random, id, file.strings);
+            break;
+        }
+
+        if (!rebuild(kind, file.json, file.rebuilt))
+            return {};
+
+        bytes += file.rebuilt.file.size();
+        files.push_back(std::move(file));
+    }
+
+    return files;
+}
+
+// Converting and rebuilding a generated corpus of every type, game and cipher. Sized with --corpus <MB> (per kind).
+void runCorpusBenchmarks()
+{
+    printf("Corpus (%zu MB per kind, seed %llu)\n", bench::corpusMB, (unsigned long long)bench::seed);
+
+    for (const corpus::Kind &kind : corpus::kinds())
+    {
+        std::string convertName = "corpus/" + kind.name() + "/convert";
+        std::string rebuildName = "corpus/" + kind.name() + "/rebuild";
+        if (!bench::enabled(convertName.c_str()) && !bench::enabled(rebuildName.c_str()))
+            continue;
+
+        std::vector<corpus::File> files = corpus::generate(kind, bench::corpusMB << 20, bench::seed);
+        check(!files.empty(), kind.name() + " generate");
+
+        size_t fileBytes = 0, jsonBytes = 0, strings = 0;
+        for (const corpus::File &file : files)
+        {
+            fileBytes += file.rebuilt.file.size();
+            jsonBytes += file.json.size();
+            strings += file.strings;
+        }
+
+        // The converted JSON has to rebuild to the same file (hex precision keeps the DLGE weights exact).
+        std::string converted;
+        Rebuilt rebuilt;
+        for (size_t i = 0; i < files.size(); i += std::max<size_t>(1, files.size() / 16))
+        {
+            converted.clear();
+            check(convert(kind, files[i].rebuilt, converted) && rebuild(kind, converted, rebuilt)
+                  && rebuilt.file == files[i].rebuilt.file, kind.name() + " round trip");
+        }
+
+        if (bench::enabled(convertName.c_str()))
+        {
+            std::string out;
+            double t = bench::measure([&] {
+                for (const corpus::File &file : files)
+                {
+                    out.clear();
+                    convert(kind, file.rebuilt, out);
+                }
+                bench::doNotOptimize(out);
+            });
+            bench::report(convertName.c_str(), t, fileBytes, strings, "strings");
+        }
+
+        if (bench::enabled(rebuildName.c_str()))
+        {
+            Rebuilt out;
+            double t = bench::measure([&] {
+                for (const corpus::File &file : files)
+                    rebuild(kind, file.json, out);
+                bench::doNotOptimize(out);
+            });
+            bench::report(rebuildName.c_str(), t, jsonBytes, strings, "strings");
+        }
+
+        // The peak only ever grows, a kind that needs more memory than the ones before it shows up as a jump.
+        printf("%-52s %10zu files %10.2f MB peak RSS\n", ("corpus/" + kind.name()).c_str(), files.size(), bench::peakRSS() / (1024.0 * 1024.0));
+    }
+}
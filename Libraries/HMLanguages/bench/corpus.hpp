@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <TonyTools/Languages.h>
+
+// Generates language files for benchmarking without needing the game's. Every file is generated as a JSON and
+// rebuilt by the library, so the files are valid by construction, and the same seed always gives the same files.
+namespace corpus
+{
+    enum class Type
+    {
+        CLNG,
+        DITL,
+        DLGE,
+        LOCR,
+        RTLV
+    };
+
+    // A kind of file: a type for a game, and for LOCR which cipher it uses.
+    struct Kind
+    {
+        Type type;
+        TonyTools::Language::Version version;
+        bool symmetric = false;
+
+        // i.e. "locr/H2016-symmetric".
+        std::string name() const;
+    };
+
+    struct File
+    {
+        std::string json;
+        TonyTools::Language::Rebuilt rebuilt;
+        size_t strings = 0; // subtitles, LOCR strings, soundtags, or languages, depending on the type
+    };
+
+    // Every type for every game it exists in (DITL is the same in all of them), LOCR for both H2016 ciphers.
+    std::vector<Kind> kinds();
+
+    // Files of a kind, sized like the game's, until the rebuilt files add up to at least targetBytes.
+    // Returns nothing if the library failed to rebuild one.
+    std::vector<File> generate(const Kind &kind, size_t targetBytes, uint64_t seed);
+} // namespace corpus
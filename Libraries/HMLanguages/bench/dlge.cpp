@@ -0,0 +1,151 @@
+#include "bench.hpp"
+
+#include <cstdlib>
+#include <format>
+#include <string>
+#include <vector>
+
+#include <TonyTools/Languages.h>
+
+using namespace TonyTools::Language;
+
+namespace
+{
+    // A H3 DLGE JSON shaped like the larger H3 dialogue events: a Sequence holding a Switch of Random
+    // containers, each with a few WavFiles. A DLGE can only hold one Switch, so the width goes into it.
+    std::string makeDeepDLGEJson(size_t randoms, size_t wavs)
+    {
+        std::string json = R"({"hash":"[assets/bench_deep.dlge].pc_dialogevent","DITL":"00AE3E8AD45EA8AB","CLNG":"0039C99E11FA8AA4",)"
+                           R"("rootContainer":{"type":"Sequence","containers":[)"
+                           R"({"type":"Switch","switchKey":"1A2B3C4D","default":"00000000","containers":[)";
+
+        for (size_t i = 0; i < randoms; i++)
+        {
+            json += std::format(R"({}{{"type":"Random","cases":["{:08X}","{:08X}"],"containers":[)",
+                                i ? "," : "", (uint32_t)(i * 2 + 1), (uint32_t)(i * 2 + 2));
+
+            for (size_t k = 0; k < wavs; k++)
+            {
+                size_t id = i * wavs + k;
+                json += std::format(R"({}{{"type":"WavFile","wavName":"{:08X}","weight":"{:06X}","soundtag":"{:08X}",)"
+                                    R"("defaultWav":"00{:014X}","defaultFfx":"01{:014X}","languages":{{)"
+                                    R"("en":"Line {} of the deep benchmark tree.","fr":{{"wav":"02{:014X}","ffx":"03{:014X}","subtitle":"Ligne {}."}}}}}})",
+                                    k ? "," : "", (uint32_t)id, 0xFFFFFF / wavs, (uint32_t)(id * 2654435761u),
+                                    id, id, id, id, id, id);
+            }
+
+            json += "]}";
+        }
+
+        return json + "]}]}}";
+    }
+
+    // A H3 DLGE JSON whose WavFiles have named depends rather than hashes, so converting has to recover every wav
+    // name from the paths. The FaceFX animsets are shared between WavFiles, the same as in the game files.
+    std::string makeNamedDLGEJson(size_t randoms, size_t wavs)
+    {
+        std::string json = R"({"hash":"[assets/bench_named.dlge].pc_dialogevent","DITL":"00AE3E8AD45EA8AB","CLNG":"0039C99E11FA8AA4",)"
+                           R"("rootContainer":{"type":"Sequence","containers":[)";
+
+        for (size_t i = 0; i < randoms; i++)
+        {
+            json += std::format(R"({}{{"type":"Random","containers":[)", i ? "," : "");
+
+            for (size_t k = 0; k < wavs; k++)
+            {
+                size_t id = i * wavs + k;
+                json += std::format(R"({}{{"type":"WavFile","wavName":"bench_line_{}","weight":"{:06X}","soundtag":"{:08X}",)"
+                                    R"("defaultWav":"[assets/sound/wwise/originals/voices/english(us)/bench_line_{}.wav].pc_wes",)"
+                                    R"("defaultFfx":"[assets/animations/facefx/bench_group_{}.animset].pc_animset","languages":{{)"
+                                    R"("en":"Line {} of the named benchmark tree."}}}})",
+                                    k ? "," : "", id, 0xFFFFFF / wavs, (uint32_t)(id * 2654435761u), id, i, id);
+            }
+
+            json += "]}";
+        }
+
+        return json + "]}}";
+    }
+
+    void check(bool ok, const char* what)
+    {
+        if (!ok)
+        {
+            fprintf(stderr, "[BENCH] DLGE %s check failed!\n", what);
+            std::exit(1);
+        }
+    }
+} // namespace
+
+// Rebuilding (compiling the JSON, then writing the file) deep container trees.
+void runDLGEBenchmarks()
+{
+    // Containers are referenced with 12 bits, which caps both the Random containers and the WavFiles.
+    const size_t randoms = 1000;
+    const size_t wavs = 4;
+
+    std::string json = makeDeepDLGEJson(randoms, wavs);
+    Rebuilt dlge = DLGE::Rebuild(Version::H3, json);
+    check(!dlge.file.empty(), "rebuild");
+
+    printf("DLGE (Sequence > Switch > %zu Random > %zu WavFiles, %.2f MB JSON)\n", randoms, randoms * wavs, json.size() / (1024.0 * 1024.0));
+
+    if (bench::enabled("dlge/rebuild/deep"))
+    {
+        Rebuilt out;
+        double t = bench::measure([&] {
+            DLGE::RebuildInto(out, Version::H3, json);
+            bench::doNotOptimize(out);
+        });
+        bench::report("dlge/rebuild/deep", t, json.size(), randoms * wavs, "wavs");
+    }
+
+    if (bench::enabled("dlge/encode/deep"))
+    {
+        DLGE::Document document;
+        check(DLGE::Decode(document, Version::H3, dlge.file), "decode");
+
+        std::vector<char> out;
+        double t = bench::measure([&] {
+            DLGE::Encode(out, Version::H3, document);
+            bench::doNotOptimize(out);
+        });
+        bench::report("dlge/encode/deep", t, dlge.file.size(), randoms * wavs, "wavs");
+    }
+
+    // Converting should scale linearly, so the per-wav rate should hold as the tree grows.
+    for (size_t count : {randoms / 4, randoms})
+    {
+        std::string name = std::format("dlge/convert/deep-{}", count * wavs);
+        if (!bench::enabled(name.c_str()))
+            continue;
+
+        Rebuilt input = count == randoms ? dlge : DLGE::Rebuild(Version::H3, makeDeepDLGEJson(count, wavs));
+        std::string out;
+        double t = bench::measure([&] {
+            out.clear();
+            DLGE::ConvertInto(out, Version::H3, input.file, input.meta, "en", true);
+            bench::doNotOptimize(out);
+        });
+        bench::report(name.c_str(), t, input.file.size(), count * wavs, "wavs");
+    }
+
+    // Converting named depends recovers the wav name of every WavFile from its path.
+    if (bench::enabled("dlge/convert/named"))
+    {
+        Rebuilt named = DLGE::Rebuild(Version::H3, makeNamedDLGEJson(randoms, wavs));
+        check(!named.file.empty(), "named rebuild");
+        check(DLGE::Convert(Version::H3, named.file, named.meta).find(std::format(R"("wavName":"bench_line_{}")", randoms * wavs - 1)) != std::string::npos, "wav name recovery");
+
+        std::string out;
+        double t = bench::measure([&] {
+            out.clear();
+            DLGE::ConvertInto(out, Version::H3, named.file, named.meta);
+            bench::doNotOptimize(out);
+        });
+        bench::report("dlge/convert/named", t, named.file.size(), randoms * wavs, "wavs");
+    }
+
+    // Converting with hex precision has to give back the same file.
+    check(DLGE::Rebuild(Version::H3, DLGE::Convert(Version::H3, dlge.file, dlge.meta, "en", true)).file == dlge.file, "round trip");
+}
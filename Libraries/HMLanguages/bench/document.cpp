@@ -0,0 +1,147 @@
+#include "bench.hpp"
+
+#include <cstdlib>
+#include <format>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <TonyTools/Languages.h>
+
+using namespace TonyTools::Language;
+
+namespace
+{
+    std::string randomText(std::mt19937 &rng)
+    {
+        std::uniform_int_distribution<size_t> length(4, 96);
+        std::uniform_int_distribution<int> letter('a', 'z');
+
+        std::string str(length(rng), ' ');
+        for (char &c : str)
+            c = (char)letter(rng);
+
+        return str;
+    }
+
+    // A H3 LOCR JSON with every language filled in.
+    std::string makeLOCRJson(size_t count)
+    {
+        std::mt19937 rng(0x4C4F4352);
+        std::string json = R"({"hash":"[assets/bench.locr].pc_localized-textlist","languages":{)";
+
+        const char* languages[] = {"xx", "en", "fr", "it", "de", "es", "ru", "cn", "tc", "jp"};
+        for (size_t i = 0; i < std::size(languages); i++)
+        {
+            json += std::format(R"({}"{}":{{)", i ? "," : "", languages[i]);
+            for (size_t k = 0; k < count; k++)
+                json += std::format(R"({}"{:08X}":"{}")", k ? "," : "", (uint32_t)(k * 2654435761u), randomText(rng));
+            json += "}";
+        }
+
+        return json + "}}";
+    }
+
+    // A H3 DLGE JSON of a Sequence of Random containers, each with a few WavFiles.
+    std::string makeDLGEJson(size_t count)
+    {
+        std::mt19937 rng(0x444C4745);
+        std::string json = R"({"hash":"[assets/bench.dlge].pc_dialogevent","DITL":"00AE3E8AD45EA8AB","CLNG":"0039C99E11FA8AA4",)"
+                           R"("rootContainer":{"type":"Sequence","containers":[)";
+
+        for (size_t i = 0; i < count; i++)
+        {
+            json += std::format(R"({}{{"type":"Random","containers":[)", i ? "," : "");
+            for (size_t k = 0; k < 4; k++)
+            {
+                size_t id = i * 4 + k;
+                json += std::format(R"({}{{"type":"WavFile","wavName":"{:08X}","weight":0.25,"soundtag":"{:08X}",)"
+                                    R"("defaultWav":"00{:014X}","defaultFfx":"01{:014X}","languages":{{)",
+                                    k ? "," : "", (uint32_t)id, (uint32_t)(id * 2654435761u), id, id);
+                json += std::format(R"("en":"{}","fr":{{"wav":"02{:014X}","ffx":"03{:014X}","subtitle":"{}"}},"de":"{}"}}}})",
+                                    randomText(rng), id, id, randomText(rng), randomText(rng));
+            }
+            json += "]}";
+        }
+
+        return json + "]}}";
+    }
+
+    void check(bool ok, const char* what)
+    {
+        if (!ok)
+        {
+            fprintf(stderr, "[BENCH] Document %s check failed!\n", what);
+            std::exit(1);
+        }
+    }
+} // namespace
+
+// The same edit pipeline (file in, file out) through JSON and through a Document.
+void runDocumentBenchmarks()
+{
+    const size_t count = 20000;
+    Rebuilt locr = LOCR::Rebuild(Version::H3, makeLOCRJson(count));
+    check(!locr.file.empty(), "LOCR rebuild");
+
+    printf("Document (LOCR: %zu strings per language, %.2f MB)\n", count, locr.file.size() / (1024.0 * 1024.0));
+
+    if (bench::enabled("document/locr/json-round-trip"))
+    {
+        double t = bench::measure([&] {
+            Rebuilt out = LOCR::Rebuild(Version::H3, LOCR::Convert(Version::H3, locr.file, locr.meta));
+            bench::doNotOptimize(out);
+        });
+        bench::report("document/locr/json-round-trip", t, locr.file.size(), count * 10, "strings");
+    }
+
+    if (bench::enabled("document/locr/decode-encode"))
+    {
+        LOCR::Document document;
+        std::vector<char> out;
+        double t = bench::measure([&] {
+            LOCR::Decode(document, Version::H3, locr.file);
+            LOCR::Encode(out, Version::H3, document);
+            bench::doNotOptimize(out);
+        });
+        bench::report("document/locr/decode-encode", t, locr.file.size(), count * 10, "strings");
+    }
+
+    // Containers are referenced with 12 bits, so a DLGE can only hold 4096 of each type.
+    const size_t randoms = 1000;
+    Rebuilt dlge = DLGE::Rebuild(Version::H3, makeDLGEJson(randoms));
+    check(!dlge.file.empty(), "DLGE rebuild");
+
+    printf("Document (DLGE: %zu WavFiles, %.2f MB)\n", randoms * 4, dlge.file.size() / (1024.0 * 1024.0));
+
+    if (bench::enabled("document/dlge/json-round-trip"))
+    {
+        double t = bench::measure([&] {
+            Rebuilt out = DLGE::Rebuild(Version::H3, DLGE::Convert(Version::H3, dlge.file, dlge.meta));
+            bench::doNotOptimize(out);
+        });
+        bench::report("document/dlge/json-round-trip", t, dlge.file.size(), randoms * 4, "wavs");
+    }
+
+    if (bench::enabled("document/dlge/decode-encode"))
+    {
+        DLGE::Document document;
+        std::vector<char> out;
+        double t = bench::measure([&] {
+            DLGE::Decode(document, Version::H3, dlge.file);
+            DLGE::Encode(out, Version::H3, document);
+            bench::doNotOptimize(out);
+        });
+        bench::report("document/dlge/decode-encode", t, dlge.file.size(), randoms * 4, "wavs");
+    }
+
+    // Both paths have to give back the same file.
+    LOCR::Document locrDocument;
+    std::vector<char> out;
+    check(LOCR::Decode(locrDocument, Version::H3, locr.file) && LOCR::Encode(out, Version::H3, locrDocument), "LOCR decode/encode");
+    check(out == locr.file && out == LOCR::Rebuild(Version::H3, LOCR::Convert(Version::H3, locr.file, locr.meta)).file, "LOCR round trip");
+
+    DLGE::Document dlgeDocument;
+    check(DLGE::Decode(dlgeDocument, Version::H3, dlge.file) && DLGE::Encode(out, Version::H3, dlgeDocument), "DLGE decode/encode");
+    check(out == dlge.file && out == DLGE::Rebuild(Version::H3, DLGE::Convert(Version::H3, dlge.file, dlge.meta)).file, "DLGE round trip");
+}
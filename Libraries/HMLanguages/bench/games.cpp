@@ -0,0 +1,200 @@
+#include "bench.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <string>
+#include <vector>
+
+#include <TonyTools/Languages.h>
+
+#include "games.hpp"
+
+using namespace TonyTools::Language;
+
+namespace
+{
+    const char* versionName(Version version)
+    {
+        return version == Version::H2016 ? "H2016" : version == Version::H2 ? "H2" : "H3";
+    }
+
+    std::span<const std::string_view> dlgeLanguages(Version version)
+    {
+        return dispatch(version, []<Version V>(Game<V>) { return Game<V>::dlgeLanguages; });
+    }
+
+    // A DLGE JSON of a Sequence of Random containers, with a subtitle for every language of every wav.
+    std::string makeDLGEJson(Version version, size_t randoms)
+    {
+        std::span<const std::string_view> languages = dlgeLanguages(version);
+
+        std::string json = R"({"hash":"[assets/bench_games.dlge].pc_dialogevent","DITL":"00AE3E8AD45EA8AB","CLNG":"0039C99E11FA8AA4",)"
+                           R"("rootContainer":{"type":"Sequence","containers":[)";
+
+        for (size_t i = 0; i < randoms; i++)
+        {
+            json += std::format(R"({}{{"type":"Random","containers":[)", i ? "," : "");
+            for (size_t k = 0; k < 4; k++)
+            {
+                size_t id = i * 4 + k;
+                json += std::format(R"({}{{"type":"WavFile","wavName":"{:08X}","weight":"3FFFFF","soundtag":"{:08X}",)"
+                                    R"("defaultWav":"00{:014X}","defaultFfx":"01{:014X}","languages":{{)",
+                                    k ? "," : "", (uint32_t)id, (uint32_t)id, id, id);
+
+                for (size_t l = 0; l < languages.size(); l++)
+                    json += std::format(R"({}"{}":"{} {}")", l ? "," : "", languages[l], languages[l], id);
+
+                json += "}}";
+            }
+            json += "]}";
+        }
+
+        return json + "]}}";
+    }
+
+    // Counts the subtitle bytes of the WavFiles in a DLGE, the same walk the decoder does before decrypting.
+    // The baseline checks the version for every language, the same as the decoder used to.
+    size_t walkRuntime(Version version, const std::vector<char> &data, size_t languageCount)
+    {
+        size_t index = 8, total = 0;
+        while (index + 2 < data.size())
+        {
+            uint8_t type = data[index++];
+            uint32_t value;
+
+            if (type == 0x01)
+            {
+                index += version == Version::H2016 ? 8 : 12;
+                for (size_t i = 0; i < languageCount; i++)
+                {
+                    index += version == Version::H2016 ? 12 : 8;
+                    std::memcpy(&value, data.data() + index, 4);
+                    index += 4 + value;
+                    total += value;
+                }
+                continue;
+            }
+
+            std::memcpy(&value, data.data() + index + 8, 4);
+            index += 12;
+            for (uint32_t i = 0; i < value; i++)
+            {
+                uint32_t hashCount;
+                std::memcpy(&hashCount, data.data() + index + 2, 4);
+                index += 6 + hashCount * 4;
+            }
+        }
+
+        return total;
+    }
+
+    template <Version V>
+    size_t walkGame(const std::vector<char> &data, size_t languageCount)
+    {
+        size_t index = 8, total = 0;
+        while (index + 2 < data.size())
+        {
+            uint8_t type = data[index++];
+            uint32_t value;
+
+            if (type == 0x01)
+            {
+                index += Game<V>::dlgeValuePerLanguage ? 8 : 12;
+                for (size_t i = 0; i < languageCount; i++)
+                {
+                    index += Game<V>::dlgeValuePerLanguage ? 12 : 8;
+                    std::memcpy(&value, data.data() + index, 4);
+                    index += 4 + value;
+                    total += value;
+                }
+                continue;
+            }
+
+            std::memcpy(&value, data.data() + index + 8, 4);
+            index += 12;
+            for (uint32_t i = 0; i < value; i++)
+            {
+                uint32_t hashCount;
+                std::memcpy(&hashCount, data.data() + index + 2, 4);
+                index += 6 + hashCount * 4;
+            }
+        }
+
+        return total;
+    }
+
+    // The walks only give back a number, which has to be used for them not to be optimised away.
+    volatile size_t walked = 0;
+
+    void check(bool ok, const char* what)
+    {
+        if (!ok)
+        {
+            fprintf(stderr, "[BENCH] Games %s check failed!\n", what);
+            std::exit(1);
+        }
+    }
+} // namespace
+
+// The codecs of each game, instantiated per Version rather than checking it per language.
+void runGamesBenchmarks()
+{
+    const size_t randoms = 1000;
+
+    printf("Games (DLGE: %zu WavFiles, every language subtitled)\n", randoms * 4);
+
+    for (Version version : {Version::H2016, Version::H2, Version::H3})
+    {
+        Rebuilt dlge = DLGE::Rebuild(version, makeDLGEJson(version, randoms));
+        check(!dlge.file.empty(), "DLGE rebuild");
+
+        size_t languageCount = dlgeLanguages(version).size();
+        size_t expected = walkRuntime(version, dlge.file, languageCount);
+        check(dispatch(version, [&]<Version V>(Game<V>) { return walkGame<V>(dlge.file, languageCount); }) == expected, "walk");
+
+        std::string name = std::format("games/dlge/walk/runtime/{}", versionName(version));
+        if (bench::enabled(name.c_str()))
+        {
+            double t = bench::measure([&] {
+                walked = walkRuntime(version, dlge.file, languageCount);
+            });
+            bench::report(name.c_str(), t, dlge.file.size(), randoms * 4, "wavs");
+        }
+
+        name = std::format("games/dlge/walk/specialised/{}", versionName(version));
+        if (bench::enabled(name.c_str()))
+        {
+            double t = bench::measure([&] {
+                walked = dispatch(version, [&]<Version V>(Game<V>) { return walkGame<V>(dlge.file, languageCount); });
+            });
+            bench::report(name.c_str(), t, dlge.file.size(), randoms * 4, "wavs");
+        }
+
+        name = std::format("games/dlge/decode/{}", versionName(version));
+        if (bench::enabled(name.c_str()))
+        {
+            DLGE::Document document;
+            double t = bench::measure([&] {
+                DLGE::Decode(document, version, dlge.file);
+                bench::doNotOptimize(document);
+            });
+            bench::report(name.c_str(), t, dlge.file.size(), randoms * 4, "wavs");
+        }
+
+        name = std::format("games/dlge/encode/{}", versionName(version));
+        if (bench::enabled(name.c_str()))
+        {
+            DLGE::Document document;
+            check(DLGE::Decode(document, version, dlge.file), "DLGE decode");
+
+            std::vector<char> out;
+            double t = bench::measure([&] {
+                DLGE::Encode(out, version, document);
+                bench::doNotOptimize(out);
+            });
+            bench::report(name.c_str(), t, dlge.file.size(), randoms * 4, "wavs");
+            check(out == dlge.file, "DLGE encode");
+        }
+    }
+}
@@ -0,0 +1,425 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <TonyTools/Languages.h>
+#include <hash/crc32.h>
+
+#include "hashindex.hpp"
+#include "legacy/bimap.hpp"
+
+using namespace TonyTools::Language;
+
+namespace
+{
+    struct Section
+    {
+        std::vector<uint32_t> hashes;
+        std::vector<std::string> strings;
+    };
+
+    void writeU32(std::vector<char> &file, uint32_t value)
+    {
+        file.insert(file.end(), (const char*)&value, (const char*)&value + 4);
+    }
+
+    // Builds a hash_list.hmla shaped like the real one (a handful of tags/switches, mostly lines).
+    std::vector<char> makeHashList(size_t lineCount, Section &lines)
+    {
+        std::mt19937 rng(0x484D4C41);
+        std::uniform_int_distribution<size_t> length(8, 48);
+        std::uniform_int_distribution<int> letter('A', 'Z');
+
+        CRC32 crc32;
+        auto makeSection = [&](size_t count, const char* prefix) {
+            Section section;
+            for (size_t i = 0; i < count; i++)
+            {
+                std::string str = prefix;
+                str.resize(str.size() + length(rng));
+                for (size_t k = std::strlen(prefix); k < str.size(); k++)
+                    str[k] = (char)letter(rng);
+                str += std::to_string(i);
+
+                section.hashes.push_back(crc32(str.data(), str.size()));
+                section.strings.push_back(std::move(str));
+            }
+
+            return section;
+        };
+
+        Section sections[3] = {
+            makeSection(2000, "Tag_"),
+            makeSection(500, "Switch_"),
+            makeSection(lineCount, "LINE_")
+        };
+
+        std::vector<char> file;
+        writeU32(file, 'ALMH');
+        writeU32(file, 1);
+        writeU32(file, 0);
+
+        for (const Section &section : sections)
+        {
+            writeU32(file, (uint32_t)section.hashes.size());
+            for (size_t i = 0; i < section.hashes.size(); i++)
+            {
+                writeU32(file, section.hashes[i]);
+                file.insert(file.end(), section.strings[i].begin(), section.strings[i].end());
+                file.push_back('\0');
+            }
+        }
+
+        uint32_t checksum = crc32(file.data() + 12, file.size() - 12);
+        std::memcpy(file.data() + 8, &checksum, 4);
+
+        lines = std::move(sections[2]);
+        return file;
+    }
+
+    // Reads the lines section of a real hash list, the path is given through HMLANGUAGES_BENCH_HASHLIST.
+    std::vector<char> loadHashList(const char* path, Section &lines)
+    {
+        std::ifstream stream(path, std::ios::binary);
+        std::vector<char> file((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+        size_t index = 12;
+        for (int section = 0; section < 3 && index + 4 <= file.size(); section++)
+        {
+            uint32_t count;
+            std::memcpy(&count, file.data() + index, 4);
+            index += 4;
+
+            for (uint32_t i = 0; i < count && index + 4 <= file.size(); i++)
+            {
+                uint32_t hash;
+                std::memcpy(&hash, file.data() + index, 4);
+                index += 4;
+
+                std::string str(file.data() + index);
+                index += str.size() + 1;
+
+                if (section == 2)
+                {
+                    lines.hashes.push_back(hash);
+                    lines.strings.push_back(std::move(str));
+                }
+            }
+        }
+
+        return file;
+    }
+} // namespace
+
+void runHashListBenchmarks()
+{
+    Section lines;
+    const char* path = std::getenv("HMLANGUAGES_BENCH_HASHLIST");
+    std::vector<char> file = path ? loadHashList(path, lines) : makeHashList(600000, lines);
+    const size_t count = lines.hashes.size();
+
+    if (!count)
+    {
+        fprintf(stderr, "[BENCH] Hash list has no lines!\n");
+        std::exit(1);
+    }
+
+    printf("Hash list (%zu lines, %.2f MB, %s)\n", count, file.size() / (1024.0 * 1024.0), path ? path : "synthetic");
+
+    // Lookups are done in a shuffled order so neither index gets to walk memory linearly.
+    std::vector<size_t> order(count);
+    for (size_t i = 0; i < count; i++)
+        order[i] = i;
+    std::shuffle(order.begin(), order.end(), std::mt19937(0x484D4C41));
+
+    std::vector<uint32_t> missHashes(count);
+    std::vector<std::string> missStrings(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        missHashes[i] = lines.hashes[i] ^ 0x5A5A5A5A;
+        missStrings[i] = lines.strings[i] + "_MISS";
+    }
+
+    stde::bimap<uint32_t, std::string> legacy;
+    HashIndex index;
+    std::vector<HashIndexEntry> entries;
+    std::vector<char> pool;
+    for (size_t i = 0; i < count; i++)
+    {
+        entries.push_back({ lines.hashes[i], (uint32_t)pool.size(), (uint32_t)lines.strings[i].size() });
+        pool.insert(pool.end(), lines.strings[i].begin(), lines.strings[i].end());
+    }
+
+    if (bench::enabled("hashlist/load/legacy"))
+    {
+        double t = bench::measure([&] {
+            legacy.clear();
+            for (size_t i = 0; i < count; i++)
+                legacy.insert(lines.hashes[i], lines.strings[i]);
+        }, 1.0);
+        bench::report("hashlist/load/legacy-bimap", t, file.size(), count, "entries");
+    }
+    else
+    {
+        for (size_t i = 0; i < count; i++)
+            legacy.insert(lines.hashes[i], lines.strings[i]);
+    }
+
+    if (bench::enabled("hashlist/load/index"))
+    {
+        double t = bench::measure([&] {
+            index.build(pool.data(), entries);
+        }, 1.0);
+        bench::report("hashlist/load/index", t, file.size(), count, "entries");
+    }
+
+    if (!index.build(pool.data(), entries))
+    {
+        fprintf(stderr, "[BENCH] Failed to build the hash list index!\n");
+        std::exit(1);
+    }
+
+    if (bench::enabled("hashlist/load/public"))
+    {
+        double t = bench::measure([&] {
+            HashList::Load(file);
+        }, 1.0);
+        bench::report("hashlist/load/public (copy + checksum)", t, file.size(), count, "entries");
+    }
+
+    if (bench::enabled("hashlist/load/mapped"))
+    {
+        // The synthetic list has to exist on disk to be mapped.
+        std::string mappedPath = path ? path : (std::filesystem::temp_directory_path() / "hmlanguages_bench.hmla").string();
+        if (!path)
+        {
+            std::ofstream stream(mappedPath, std::ios::binary);
+            stream.write(file.data(), file.size());
+        }
+
+        // Cleared first, replacing a loaded list checks the checksum straight away.
+        double t = bench::measure([&] {
+            HashList::Clear();
+            HashList::LoadFile(mappedPath);
+        });
+        bench::report("hashlist/load/mapped (header only)", t, file.size(), count, "entries");
+
+        t = bench::measure([&] {
+            HashList::Clear();
+            HashList::LoadFile(mappedPath);
+            bench::doNotOptimize(HashList::GetStatus());
+        }, 1.0);
+        bench::report("hashlist/load/mapped + checksum", t, file.size(), count, "entries");
+
+        t = bench::measure([&] {
+            HashList::Clear();
+            HashList::LoadFile(mappedPath);
+            std::string str = HashList::GetLine(lines.hashes[0]);
+            bench::doNotOptimize(str);
+        }, 1.0);
+        bench::report("hashlist/load/mapped + first GetLine", t, file.size(), count, "entries");
+
+        // Same again with the precompiled (v2) layout, there is nothing to build on first use.
+        std::string compiledPath = (std::filesystem::temp_directory_path() / "hmlanguages_bench_v2.hmla").string();
+        std::vector<char> compiled = HashList::Compile(file);
+        {
+            std::ofstream stream(compiledPath, std::ios::binary);
+            stream.write(compiled.data(), compiled.size());
+        }
+
+        t = bench::measure([&] {
+            HashList::Clear();
+            HashList::LoadFile(compiledPath);
+            bench::doNotOptimize(HashList::GetStatus());
+        }, 1.0);
+        bench::report("hashlist/load/mapped v2 + checksum", t, compiled.size(), count, "entries");
+
+        t = bench::measure([&] {
+            HashList::Clear();
+            HashList::LoadFile(compiledPath);
+            std::string str = HashList::GetLine(lines.hashes[0]);
+            bench::doNotOptimize(str);
+        }, 1.0);
+        bench::report("hashlist/load/mapped v2 + first GetLine", t, compiled.size(), count, "entries");
+
+        HashList::Clear();
+        std::filesystem::remove(compiledPath);
+        if (!path)
+            std::filesystem::remove(mappedPath);
+    }
+
+    if (bench::enabled("hashlist/compile"))
+    {
+        double t = bench::measure([&] {
+            std::vector<char> compiled = HashList::Compile(file);
+            bench::doNotOptimize(compiled);
+        }, 1.0);
+        bench::report("hashlist/compile (v1 -> v2)", t, file.size(), count, "entries");
+    }
+
+    if (bench::enabled("hashlist/value/legacy"))
+    {
+        double t = bench::measure([&] {
+            for (size_t i : order)
+            {
+                std::string str = legacy.has_key(lines.hashes[i]) ? legacy.get_value(lines.hashes[i]) : std::string();
+                bench::doNotOptimize(str);
+            }
+        });
+        bench::report("hashlist/value/legacy-bimap", t, 0, count, "lookups");
+    }
+
+    if (bench::enabled("hashlist/value/index"))
+    {
+        double t = bench::measure([&] {
+            for (size_t i : order)
+                bench::doNotOptimize(index.value(lines.hashes[i]));
+        });
+        bench::report("hashlist/value/index", t, 0, count, "lookups");
+    }
+
+    if (bench::enabled("hashlist/value/index-miss"))
+    {
+        double t = bench::measure([&] {
+            for (size_t i : order)
+                bench::doNotOptimize(index.value(missHashes[i]));
+        });
+        bench::report("hashlist/value/index-miss", t, 0, count, "lookups");
+    }
+
+    if (bench::enabled("hashlist/key/legacy"))
+    {
+        double t = bench::measure([&] {
+            for (size_t i : order)
+            {
+                uint32_t hash = legacy.has_value(lines.strings[i]) ? legacy.get_key(lines.strings[i]) : 0;
+                bench::doNotOptimize(hash);
+            }
+        });
+        bench::report("hashlist/key/legacy-bimap", t, 0, count, "lookups");
+    }
+
+    if (bench::enabled("hashlist/key/index"))
+    {
+        double t = bench::measure([&] {
+            for (size_t i : order)
+                bench::doNotOptimize(index.key(lines.strings[i]));
+        });
+        bench::report("hashlist/key/index", t, 0, count, "lookups");
+    }
+
+    if (bench::enabled("hashlist/key/index-miss"))
+    {
+        double t = bench::measure([&] {
+            for (size_t i : order)
+                bench::doNotOptimize(index.key(missStrings[i]));
+        });
+        bench::report("hashlist/key/index-miss", t, 0, count, "lookups");
+    }
+
+    // Both layouts have to resolve every line the same way.
+    {
+        std::vector<char> compiled = HashList::Compile(file);
+        std::vector<std::string> v1Lines(count);
+
+        HashList::Load(file);
+        for (size_t i = 0; i < count; i++)
+            v1Lines[i] = HashList::GetLine(lines.hashes[i]);
+
+        bool ok = HashList::Load(compiled) && HashList::GetStatus().loaded;
+        for (size_t i = 0; i < count && ok; i++)
+            ok = HashList::GetLine(lines.hashes[i]) == v1Lines[i] && (path || HashList::GetLineHash(v1Lines[i]) == std::format("{:08X}", lines.hashes[i]));
+
+        if (!ok)
+        {
+            fprintf(stderr, "[BENCH] Precompiled hash list does not match the plain one!\n");
+            std::exit(1);
+        }
+    }
+
+    if (bench::enabled("hashlist/public/GetLine"))
+    {
+        HashList::Load(file);
+        double t = bench::measure([&] {
+            for (size_t i : order)
+            {
+                std::string str = HashList::GetLine(lines.hashes[i]);
+                bench::doNotOptimize(str);
+            }
+        });
+        bench::report("hashlist/public/GetLine", t, 0, count, "lookups");
+    }
+
+    // A context is separate from the default one, and can be reloaded while it's being used.
+    {
+        HashListContext context;
+        HashList::Clear();
+
+        bool ok = context.Load(file) && context.GetStatus().loaded && !HashList::GetStatus().loaded;
+        ok = ok && context.GetLine(lines.hashes[0]) == lines.strings[0] && HashList::GetLine(lines.hashes[0]) == std::format("{:08X}", lines.hashes[0]);
+
+        if (!ok)
+        {
+            fprintf(stderr, "[BENCH] Hash list context is not separate from the default one!\n");
+            std::exit(1);
+        }
+
+        // Reloading the precompiled list, a plain one would have its lines indexed again on first use after every reload.
+        if (bench::enabled("hashlist/context/GetLine-reloading"))
+        {
+            std::vector<char> compiled = HashList::Compile(file);
+            context.Load(compiled);
+
+            std::atomic<bool> stop = false;
+            std::thread reloader([&] {
+                while (!stop)
+                {
+                    context.Load(compiled);
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                }
+            });
+
+            double t = bench::measure([&] {
+                for (size_t i : order)
+                {
+                    std::string str = context.GetLine(lines.hashes[i]);
+                    bench::doNotOptimize(str);
+                }
+            });
+
+            stop = true;
+            reloader.join();
+            bench::report("hashlist/context/GetLine-reloading", t, 0, count, "lookups");
+        }
+    }
+
+    // Sanity check, every line resolves both ways. Colliding hashes resolve to their first string, which still has to hash back.
+    for (size_t i = 0; i < count; i++)
+    {
+        std::optional<std::string_view> value = index.value(lines.hashes[i]);
+        bool ok = value && index.key(*value).has_value() && index.key(lines.strings[i]).has_value();
+        ok = ok && (path || index.key(lines.strings[i]) == lines.hashes[i]);
+        ok = ok && !index.key(missStrings[i]).has_value();
+
+        if (!ok)
+        {
+            fprintf(stderr, "[BENCH] Hash list index lookup failed for %s!\n", lines.strings[i].c_str());
+            std::exit(1);
+        }
+    }
+
+    HashList::Clear();
+}
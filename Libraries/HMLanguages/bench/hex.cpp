@@ -0,0 +1,186 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <TonyTools/Languages.h>
+
+#include "hex.hpp"
+
+using namespace TonyTools::Language;
+
+// Every heap allocation of the benchmarks is counted, so the checks below can see what allocates.
+static std::atomic<size_t> allocations{0};
+
+void* operator new(size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace
+{
+    // A H3 LOCR JSON of strings that aren't in any hash list, so every one is written as a hex hash.
+    std::string makeUnknownLOCRJson(size_t count)
+    {
+        std::string json = R"({"hash":"[assets/bench_hex.locr].pc_localized-textlist","languages":{"en":{)";
+        for (size_t i = 0; i < count; i++)
+            json += std::format(R"({}"{:08X}":"Line {}")", i ? "," : "", (uint32_t)(i * 2654435761u), i);
+
+        return json + "}}}";
+    }
+
+    // The allocations made by converting a LOCR again into the same output, once everything has warmed up.
+    size_t convertAllocations(const Rebuilt &locr, std::string &out)
+    {
+        out.clear();
+        LOCR::ConvertInto(out, Version::H3, locr.file, locr.meta);
+
+        out.clear();
+        size_t before = allocations.load();
+        LOCR::ConvertInto(out, Version::H3, locr.file, locr.meta);
+        return allocations.load() - before;
+    }
+
+    void check(bool ok, const char* what)
+    {
+        if (!ok)
+        {
+            fprintf(stderr, "[BENCH] Hex %s check failed!\n", what);
+            std::exit(1);
+        }
+    }
+} // namespace
+
+// Formatting, validating and parsing hashes, and the allocations made per unknown hash.
+void runHexBenchmarks()
+{
+    const size_t count = 200000;
+
+    std::mt19937_64 rng(0x48455821);
+    std::vector<uint64_t> values(count);
+    std::vector<std::string> ids(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        values[i] = rng();
+        ids[i] = std::format("{:016X}", values[i]);
+    }
+
+    printf("Hex (%zu hashes)\n", count);
+
+    // Every hash has to be unknown.
+    HashList::Clear();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        check(hex8((uint32_t)values[i]) == std::format("{:08X}", (uint32_t)values[i]), "hex8");
+        check(hex16(values[i]) == ids[i] && isResourceID(ids[i]) && parseResourceID(ids[i]) == values[i], "hex16");
+    }
+
+    check(!isResourceID("00123456789ABCDG") && !isResourceID("00123456789ABCD") && !isResourceID("00123456789ABC\x80") &&
+          isResourceID("00abcdef01234567") && isHex("") && !isHex("0x12") && parseHex32("00c0FFEE") == 0xC0FFEE, "validation");
+
+    // The hash layer itself never allocates. Unknown lines are 8 characters, which fit in any string's small buffer.
+    size_t before = allocations.load();
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        HexChars<8> hex = hex8((uint32_t)values[i]);
+        total += isResourceID(ids[i]) + parseHex32(hex.view()) + HashList::GetLine((uint32_t)values[i]).size() + HashList::GetLineHash(hex.view()).size();
+    }
+    bench::doNotOptimize(total);
+    check(allocations.load() == before, "zero allocations per hash");
+
+    // Converting allocates per file, not per unknown hash: four times the hashes may only add the few reallocations
+    // of the tables growing geometrically.
+    std::string out;
+    Rebuilt small = LOCR::Rebuild(Version::H3, makeUnknownLOCRJson(count / 16));
+    Rebuilt large = LOCR::Rebuild(Version::H3, makeUnknownLOCRJson(count / 4));
+    size_t smallAllocations = convertAllocations(small, out);
+    size_t largeAllocations = convertAllocations(large, out);
+    printf("LOCR convert allocations: %zu for %zu unknown hashes, %zu for %zu\n", smallAllocations, count / 16, largeAllocations, count / 4);
+    check(largeAllocations <= smallAllocations + 4, "LOCR convert allocations");
+
+    if (bench::enabled("hex/format/std-format"))
+    {
+        double t = bench::measure([&] {
+            for (size_t i = 0; i < count; i++)
+            {
+                std::string hex = std::format("{:08X}", (uint32_t)values[i]);
+                bench::doNotOptimize(hex);
+            }
+        });
+        bench::report("hex/format/std-format", t, count * 8, count, "hashes");
+    }
+
+    if (bench::enabled("hex/format/fixed"))
+    {
+        double t = bench::measure([&] {
+            for (size_t i = 0; i < count; i++)
+            {
+                HexChars<8> hex = hex8((uint32_t)values[i]);
+                bench::doNotOptimize(hex);
+            }
+        });
+        bench::report("hex/format/fixed", t, count * 8, count, "hashes");
+    }
+
+    // The old is_valid_hash and hexStringToNum, through all_of/isxdigit and strtoull.
+    if (bench::enabled("hex/resource-id/isxdigit-strtoull"))
+    {
+        double t = bench::measure([&] {
+            uint64_t sum = 0;
+            for (const std::string &id : ids)
+            {
+                if (id.size() == 16 && std::all_of(id.begin(), id.end(), ::isxdigit))
+                    sum += std::strtoull(id.c_str(), nullptr, 16);
+            }
+            bench::doNotOptimize(sum);
+        });
+        bench::report("hex/resource-id/isxdigit-strtoull", t, count * 16, count, "ids");
+    }
+
+    if (bench::enabled("hex/resource-id/simd"))
+    {
+        double t = bench::measure([&] {
+            uint64_t sum = 0;
+            for (const std::string &id : ids)
+            {
+                if (isResourceID(id))
+                    sum += parseResourceID(id);
+            }
+            bench::doNotOptimize(sum);
+        });
+        bench::report("hex/resource-id/simd", t, count * 16, count, "ids");
+    }
+
+    if (bench::enabled("hex/locr-convert/unknown"))
+    {
+        double t = bench::measure([&] {
+            out.clear();
+            LOCR::ConvertInto(out, Version::H3, large.file, large.meta);
+            bench::doNotOptimize(out);
+        });
+        bench::report("hex/locr-convert/unknown", t, large.file.size(), count / 4, "strings");
+    }
+}
@@ -0,0 +1,103 @@
+#include "bench.hpp"
+
+#include <cstdlib>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include <TonyTools/Languages.h>
+
+using namespace TonyTools::Language;
+
+namespace
+{
+    // The split every call used to run on its langMap argument.
+    std::vector<std::string> regexSplit(std::string_view str)
+    {
+        std::regex regex{R"([,]+)"};
+        std::cregex_token_iterator it{str.data(), str.data() + str.size(), regex, -1};
+        return std::vector<std::string>{it, {}};
+    }
+
+    void check(bool ok, const char* what)
+    {
+        if (!ok)
+        {
+            fprintf(stderr, "[BENCH] LanguageMap %s check failed!\n", what);
+            std::exit(1);
+        }
+    }
+} // namespace
+
+// Resolving a langmap per call, the way a tool converting a directory of small files does.
+void runLangMapBenchmarks()
+{
+    const char* langMap = "xx,en,fr,it,de,es,ru,mx,br,pl,cn,jp,tc";
+    const size_t calls = 10000;
+
+    printf("LanguageMap (%zu calls with \"%s\")\n", calls, langMap);
+
+    check(LanguageMap(langMap).languages() == regexSplit(langMap), "split");
+    check(LanguageMap(",en,,fr,").languages() == regexSplit(",en,,fr,"), "split runs");
+    check(LanguageMap::BuiltIn(Version::H2).languages() == regexSplit(langMap), "built-in");
+
+    if (bench::enabled("langmap/parse/regex"))
+    {
+        double t = bench::measure([&] {
+            for (size_t i = 0; i < calls; i++)
+            {
+                std::vector<std::string> languages = regexSplit(langMap);
+                bench::doNotOptimize(languages);
+            }
+        });
+        bench::report("langmap/parse/regex", t, 0, calls, "calls");
+    }
+
+    if (bench::enabled("langmap/parse/cached"))
+    {
+        double t = bench::measure([&] {
+            for (size_t i = 0; i < calls; i++)
+            {
+                LanguageMap map(langMap);
+                bench::doNotOptimize(map);
+            }
+        });
+        bench::report("langmap/parse/cached", t, 0, calls, "calls");
+    }
+
+    // A tiny CLNG converted over and over, where parsing the langmap used to be a good part of the call.
+    Rebuilt rebuilt = CLNG::Rebuild(R"({"hash":"[assets/bench.clng].pc_clng","languages":{"xx":false,"en":true,"fr":true,"it":true,"de":true,"es":true,"ru":true,"mx":true,"br":true,"pl":true,"cn":true,"jp":true,"tc":true}})");
+    check(!rebuilt.file.empty(), "CLNG rebuild");
+
+    const std::vector<char> &clng = rebuilt.file;
+    const std::string &meta = rebuilt.meta;
+
+    if (bench::enabled("langmap/clng-convert/parsed-once"))
+    {
+        LanguageMap map(langMap);
+        std::string out;
+        double t = bench::measure([&] {
+            for (size_t i = 0; i < calls; i++)
+            {
+                out.clear();
+                CLNG::ConvertInto(out, Version::H2, clng, meta, map);
+            }
+            bench::doNotOptimize(out);
+        });
+        bench::report("langmap/clng-convert/parsed-once", t, clng.size() * calls, calls, "files");
+    }
+
+    if (bench::enabled("langmap/clng-convert/string"))
+    {
+        std::string out;
+        double t = bench::measure([&] {
+            for (size_t i = 0; i < calls; i++)
+            {
+                out.clear();
+                CLNG::ConvertInto(out, Version::H2, clng, meta, langMap);
+            }
+            bench::doNotOptimize(out);
+        });
+        bench::report("langmap/clng-convert/string", t, clng.size() * calls, calls, "files");
+    }
+}
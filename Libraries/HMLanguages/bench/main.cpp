@@ -0,0 +1,30 @@
+#include "bench.hpp"
+
+#include <cstdlib>
+
+int main(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--corpus" && i + 1 < argc)
+            bench::corpusMB = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--seed" && i + 1 < argc)
+            bench::seed = std::strtoull(argv[++i], nullptr, 10);
+        else
+            bench::filter = arg;
+    }
+
+    runXteaBenchmarks();
+    runSymmetricBenchmarks();
+    runHexBenchmarks();
+    runHashListBenchmarks();
+    runLangMapBenchmarks();
+    runDocumentBenchmarks();
+    runDLGEBenchmarks();
+    runRTLVBenchmarks();
+    runGamesBenchmarks();
+    runCorpusBenchmarks();
+
+    return 0;
+}
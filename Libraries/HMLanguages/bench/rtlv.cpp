@@ -0,0 +1,89 @@
+#include "bench.hpp"
+
+#include <cstdlib>
+#include <format>
+#include <string>
+#include <vector>
+
+#include <TonyTools/Languages.h>
+
+using namespace TonyTools::Language;
+
+namespace
+{
+    // A H3 RTLV JSON with a video for a few languages and a subtitle for every one, the size of the ones in the game.
+    std::string makeRTLVJson(size_t id)
+    {
+        static constexpr const char* languages[] = {"xx", "en", "fr", "it", "de", "es", "ru", "cn", "tc", "jp"};
+
+        std::string json = std::format(R"({{"hash":"[assets/bench_{}.rtlv].pc_rtlv","videos":{{)", id);
+        json += std::format(R"("en":"00{:014X}","fr":"00{:014X}","jp":"[assets/videos/bench_{}.bk2].pc_binkvid"}},"subtitles":{{)", id, id + 1, id);
+        for (size_t l = 0; l < std::size(languages); l++)
+            json += std::format(R"({}"{}":"<font color=\"#FFFFFF\">Subtitle {} for video {}</font>")", l ? "," : "", languages[l], languages[l], id);
+
+        return json + "}}";
+    }
+
+    void check(bool ok, const char* what)
+    {
+        if (!ok)
+        {
+            fprintf(stderr, "[BENCH] RTLV %s check failed!\n", what);
+            std::exit(1);
+        }
+    }
+} // namespace
+
+// Converting and rebuilding a directory worth of small RTLVs. The first file of each direction also goes through
+// ResourceLib to check the native codec, every file after it is read and written natively.
+void runRTLVBenchmarks()
+{
+    const size_t count = 1000;
+
+    std::vector<std::string> jsons(count);
+    std::vector<Rebuilt> rebuilt(count);
+    size_t fileBytes = 0, jsonBytes = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        jsons[i] = makeRTLVJson(i);
+        rebuilt[i] = RTLV::Rebuild(Version::H3, jsons[i]);
+        check(!rebuilt[i].file.empty(), "rebuild");
+
+        fileBytes += rebuilt[i].file.size();
+        jsonBytes += jsons[i].size();
+    }
+
+    printf("RTLV (%zu files)\n", count);
+
+    // Rebuilding the converted JSON has to give back the same file.
+    for (size_t i = 0; i < count; i += 97)
+    {
+        std::string converted = RTLV::Convert(Version::H3, rebuilt[i].file, rebuilt[i].meta);
+        check(!converted.empty() && RTLV::Rebuild(Version::H3, converted).file == rebuilt[i].file, "round trip");
+    }
+
+    if (bench::enabled("rtlv/convert"))
+    {
+        std::string out;
+        double t = bench::measure([&] {
+            for (const Rebuilt &rtlv : rebuilt)
+            {
+                out.clear();
+                RTLV::ConvertInto(out, Version::H3, rtlv.file, rtlv.meta);
+            }
+            bench::doNotOptimize(out);
+        });
+        bench::report("rtlv/convert", t, fileBytes, count, "files");
+    }
+
+    if (bench::enabled("rtlv/rebuild"))
+    {
+        Rebuilt out;
+        double t = bench::measure([&] {
+            for (const std::string &json : jsons)
+                RTLV::RebuildInto(out, Version::H3, json);
+            bench::doNotOptimize(out);
+        });
+        bench::report("rtlv/rebuild", t, jsonBytes, count, "files");
+    }
+}
@@ -0,0 +1,91 @@
+#include "bench.hpp"
+
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "crypto.hpp"
+
+namespace
+{
+    // The per-string, copying implementation LOCR used before the table/pshufb kernels, kept as the baseline.
+    std::string legacySymmetricDecrypt(std::vector<char> data)
+    {
+        for (char &value : data)
+        {
+            value = (value & 1) | (value & 2) << 3 | (value & 4) >> 1 | (value & 8) << 2 | (value & 16) >> 2 | (value & 32) << 1 |
+                (value & 64) >> 3 | (value & 128);
+            value ^= 226;
+        }
+
+        return std::string(data.begin(), data.end());
+    }
+} // namespace
+
+void runSymmetricBenchmarks()
+{
+    const size_t count = 200000;
+
+    std::mt19937 rng(0x484D4C41);
+    std::uniform_int_distribution<size_t> length(4, 96);
+    std::uniform_int_distribution<int> byte(0, 255);
+
+    std::vector<char> file;
+    std::vector<std::pair<size_t, size_t>> spans;
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t size = length(rng);
+        file.insert(file.end(), 8, '\0');
+        spans.emplace_back(file.size(), size);
+        for (size_t k = 0; k < size; k++)
+            file.push_back((char)byte(rng));
+        file.push_back('\0');
+    }
+
+    printf("Symmetric (%zu strings, %.2f MB, kernel: %s)\n", count, file.size() / (1024.0 * 1024.0), symmetricKernelName());
+
+    if (bench::enabled("symmetric/decrypt/legacy"))
+    {
+        double t = bench::measure([&] {
+            for (const auto &[offset, size] : spans)
+            {
+                std::string str = legacySymmetricDecrypt(std::vector<char>(file.begin() + offset, file.begin() + offset + size));
+                bench::doNotOptimize(str);
+            }
+        });
+        bench::report("symmetric/decrypt/legacy", t, file.size(), count, "strings");
+    }
+
+    if (bench::enabled("symmetric/decrypt/in-place"))
+    {
+        std::vector<char> copy = file;
+        double t = bench::measure([&] {
+            for (const auto &[offset, size] : spans)
+                symmetricDecryptInPlace(copy.data() + offset, size);
+            bench::doNotOptimize(copy);
+        });
+        bench::report("symmetric/decrypt/in-place", t, file.size(), count, "strings");
+    }
+
+    if (bench::enabled("symmetric/decrypt/whole-file"))
+    {
+        std::vector<char> copy = file;
+        double t = bench::measure([&] {
+            symmetricDecryptInPlace(copy.data(), copy.size());
+            bench::doNotOptimize(copy);
+        });
+        bench::report("symmetric/decrypt/whole-file", t, file.size(), count, "strings");
+    }
+
+    // Sanity check against the legacy implementation.
+    std::vector<char> copy = file;
+    for (const auto &[offset, size] : spans)
+    {
+        symmetricDecryptInPlace(copy.data() + offset, size);
+        if (std::string(copy.data() + offset, size) != legacySymmetricDecrypt(std::vector<char>(file.begin() + offset, file.begin() + offset + size)))
+        {
+            fprintf(stderr, "[BENCH] Symmetric kernel output does not match the legacy implementation!\n");
+            std::exit(1);
+        }
+    }
+}
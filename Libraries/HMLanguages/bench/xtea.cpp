@@ -0,0 +1,186 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "crypto.hpp"
+
+namespace
+{
+    // The per-string, copying implementation LOCR/DLGE used before the batch engine, kept as the baseline.
+    constexpr uint32_t legacyKeys[4] = {0x53527737, 0x7506499E, 0xBD39AEE3, 0xA59E7268};
+    constexpr uint32_t legacyDelta = 0x9E3779B9;
+    constexpr uint32_t legacyRounds = 32;
+
+    std::string legacyXteaDecrypt(std::vector<char> data)
+    {
+        for (uint32_t i = 0; i < data.size() / 8; i++)
+        {
+            uint32_t* v0 = (uint32_t*)(data.data() + (i * 8));
+            uint32_t* v1 = (uint32_t*)(data.data() + (i * 8) + 4);
+
+            uint32_t sum = legacyDelta * legacyRounds;
+
+            for (uint32_t j = 0; j < legacyRounds; j++)
+            {
+                *v1 -= (*v0 << 4 ^ *v0 >> 5) + *v0 ^ sum + legacyKeys[sum >> 11 & 3];
+                sum -= legacyDelta;
+                *v0 -= (*v1 << 4 ^ *v1 >> 5) + *v1 ^ sum + legacyKeys[sum & 3];
+            }
+        }
+
+        return std::string(data.begin(), std::find(data.begin(), data.end(), '\0'));
+    }
+
+    std::vector<char> legacyXteaEncrypt(std::string str)
+    {
+        std::vector<char> data(str.begin(), str.end());
+        uint32_t paddedSize = data.size() + (data.size() % 8 == 0 ? 0 : 8 - (data.size() % 8));
+        data.resize(paddedSize, '\0');
+
+        for (uint32_t i = 0; i < paddedSize / 8; i++)
+        {
+            uint32_t* v0 = (uint32_t*)(data.data() + (i * 8));
+            uint32_t* v1 = (uint32_t*)(data.data() + (i * 8) + 4);
+
+            uint32_t sum = 0;
+
+            for (uint32_t j = 0; j < legacyRounds; j++)
+            {
+                *v0 += (((*v1 << 4) ^ (*v1 >> 5)) + *v1) ^ (sum + legacyKeys[sum & 3]);
+                sum += legacyDelta;
+                *v1 += (((*v0 << 4) ^ (*v0 >> 5)) + *v0) ^ (sum + legacyKeys[(sum >> 11) & 3]);
+            }
+        }
+
+        return data;
+    }
+
+    // Mimics a LOCR string table: many short strings, each prefixed with a hash and size and followed by a null.
+    struct Corpus
+    {
+        std::vector<char> file;
+        std::vector<std::pair<size_t, size_t>> spans;
+        std::vector<std::string> plaintext;
+        size_t bytes = 0;
+    };
+
+    Corpus makeCorpus(size_t count)
+    {
+        std::mt19937 rng(0x484D4C41);
+        std::uniform_int_distribution<size_t> length(4, 96);
+        std::uniform_int_distribution<int> letter('a', 'z');
+
+        Corpus corpus;
+        for (size_t i = 0; i < count; i++)
+        {
+            std::string str(length(rng), ' ');
+            for (char &c : str)
+                c = (char)letter(rng);
+
+            size_t padded = xteaPaddedSize(str.size());
+            corpus.file.insert(corpus.file.end(), 8, '\0');
+            corpus.spans.emplace_back(corpus.file.size(), padded);
+            corpus.file.insert(corpus.file.end(), str.begin(), str.end());
+            corpus.file.insert(corpus.file.end(), padded - str.size() + 1, '\0');
+            corpus.bytes += padded;
+            corpus.plaintext.push_back(std::move(str));
+        }
+
+        for (const auto &[offset, size] : corpus.spans)
+            xteaEncryptInPlace(corpus.file.data() + offset, size);
+
+        return corpus;
+    }
+} // namespace
+
+void runXteaBenchmarks()
+{
+    const size_t count = 200000;
+    Corpus corpus = makeCorpus(count);
+
+    printf("XTEA (%zu strings, %.2f MB, batch kernel: %s)\n", count, corpus.bytes / (1024.0 * 1024.0), xteaKernelName());
+
+    if (bench::enabled("xtea/decrypt/legacy"))
+    {
+        double t = bench::measure([&] {
+            for (const auto &[offset, size] : corpus.spans)
+            {
+                std::string str = legacyXteaDecrypt(std::vector<char>(corpus.file.begin() + offset, corpus.file.begin() + offset + size));
+                bench::doNotOptimize(str);
+            }
+        });
+        bench::report("xtea/decrypt/legacy", t, corpus.bytes, count, "strings");
+    }
+
+    if (bench::enabled("xtea/decrypt/scalar-in-place"))
+    {
+        std::vector<char> file = corpus.file;
+        double t = bench::measure([&] {
+            for (const auto &[offset, size] : corpus.spans)
+                xteaDecryptInPlace(file.data() + offset, size);
+            bench::doNotOptimize(file);
+        });
+        bench::report("xtea/decrypt/scalar-in-place", t, corpus.bytes, count, "strings");
+    }
+
+    if (bench::enabled("xtea/decrypt/batch"))
+    {
+        std::vector<char> file = corpus.file;
+        XteaBatch batch;
+        double t = bench::measure([&] {
+            batch.clear();
+            for (const auto &[offset, size] : corpus.spans)
+                batch.add(offset, size);
+            batch.decrypt(file.data());
+            bench::doNotOptimize(file);
+        });
+        bench::report("xtea/decrypt/batch", t, corpus.bytes, count, "strings");
+    }
+
+    if (bench::enabled("xtea/encrypt/legacy"))
+    {
+        double t = bench::measure([&] {
+            for (const std::string &str : corpus.plaintext)
+            {
+                std::vector<char> data = legacyXteaEncrypt(str);
+                bench::doNotOptimize(data);
+            }
+        });
+        bench::report("xtea/encrypt/legacy", t, corpus.bytes, count, "strings");
+    }
+
+    if (bench::enabled("xtea/encrypt/batch"))
+    {
+        std::vector<char> file = corpus.file;
+        XteaBatch batch;
+        double t = bench::measure([&] {
+            batch.clear();
+            for (const auto &[offset, size] : corpus.spans)
+                batch.add(offset, size);
+            batch.encrypt(file.data());
+            bench::doNotOptimize(file);
+        });
+        bench::report("xtea/encrypt/batch", t, corpus.bytes, count, "strings");
+    }
+
+    // Sanity check that the batch engine gets the original plaintext back.
+    std::vector<char> file = corpus.file;
+    XteaBatch batch;
+    for (const auto &[offset, size] : corpus.spans)
+        batch.add(offset, size);
+    batch.decrypt(file.data());
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const auto &[offset, size] = corpus.spans[i];
+        if (xteaPlaintext(file.data() + offset, size) != corpus.plaintext[i])
+        {
+            fprintf(stderr, "[BENCH] XTEA batch output does not match the plaintext!\n");
+            std::exit(1);
+        }
+    }
+}
@@ -1,7 +1,11 @@
 #pragma once
 
 #include <vector>
+#include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <cstdint>
 
 namespace TonyTools
@@ -22,13 +26,76 @@ namespace Language
 
     /**
      * @brief Rebuilt data struct containing raw file data and a .meta.json string.
+     * 
+     * The same Rebuilt can be passed to the RebuildInto functions over and over, the file and meta
+     * are cleared but keep their capacity, so rebuilding many files doesn't keep reallocating them.
      */
     struct Rebuilt
     {
         std::vector<char> file;
         std::string meta;
+
+        /**
+         * @brief Empties the file and meta without releasing their memory.
+         */
+        void clear()
+        {
+            file.clear();
+            meta.clear();
+        }
+    };
+
+    /**
+     * @brief A parsed language map, i.e. "xx,en,fr,it,de,es,ru,mx,br,pl,cn,jp,tc".
+     *
+     * Parsed maps are cached by their string, so passing the same langmap for any number of files only
+     * parses it once, and copies share the parsed languages. Every langMap parameter takes one of these,
+     * or the string to parse. An empty map means the version's built-in map is used.
+     */
+    class LanguageMap
+    {
+    public:
+        LanguageMap() = default;
+        LanguageMap(std::string_view langMap);
+        LanguageMap(const std::string &langMap) : LanguageMap(std::string_view(langMap)) {}
+        LanguageMap(const char* langMap) : LanguageMap(std::string_view(langMap)) {}
+
+        /**
+         * @brief The built-in map of a version, the one an empty map resolves to.
+         *
+         * H2016 and H2 share a map, H3 has its own. DLGEs from H2016 use the H2 map without "tc".
+         */
+        static LanguageMap BuiltIn(Version version, bool dlge = false);
+
+        bool empty() const { return !entry; }
+
+        /**
+         * @brief The languages in the order of the map, empty for an empty map.
+         */
+        const std::vector<std::string> &languages() const;
+
+        /**
+         * @brief The string the map was parsed from.
+         */
+        std::string_view str() const;
+
+    private:
+        struct Entry;
+        std::shared_ptr<const Entry> entry;
     };
 
+    /*
+     * Inputs are taken as views (std::span/std::string_view), so a vector, string, or memory owned by
+     * the caller can be passed without being copied. The data is only read, never kept after the call.
+     *
+     * The ConvertInto functions append to the given string and return if the conversion was successful,
+     * the string is left as it was on failure. The RebuildInto functions write into the given Rebuilt
+     * (see above) and leave it empty on failure.
+     *
+     * LOCR and DLGE can also be decoded to, and encoded from, a Document (see their namespaces) to work on
+     * them without going through JSON. Convert and Rebuild are built on the same decoding and encoding.
+     */
+
     namespace HashList
     {
         /**
@@ -40,10 +107,12 @@ namespace Language
         };
 
         /**
-         * @brief Load the hash list from a vector.
+         * @brief Load the hash list from a vector, both plain (v1) and precompiled (v2) hash lists are accepted.
+         * 
+         * The header, the layout of every section, and the checksum are all checked here.
          * 
          * @param data A vector of the hash list file data.
-         * @return bool representing if loading was successful.
+         * @return bool representing if the hash list is valid. If not, no hash list is loaded.
          */
         bool Load(std::vector<char> data);
 
@@ -52,10 +121,69 @@ namespace Language
          * 
          * @param ptr Pointer to the start of the data.
          * @param size Size of the data.
-         * @return bool representing if loading was successful. 
+         * @return bool representing if the hash list is valid. If not, no hash list is loaded.
          */
         bool Load(const char* ptr, uint32_t size);
 
+        /**
+         * @brief Load the hash list by memory mapping it from disk.
+         * 
+         * The header and the layout of every section are checked here. If no hash list is loaded yet, only the
+         * checksum is deferred, it's validated the first time the hash list is used (GetStatus counts as a use),
+         * and if it doesn't match the hash list is treated as not loaded from then on. When replacing a hash list
+         * the checksum is checked here too. Each section is indexed the first time it's used.
+         * 
+         * The file stays mapped while the hash list is loaded, so it must never be rewritten in place until then
+         * (on Linux that crashes the process). Replace it by writing a new file and renaming it over this one.
+         * 
+         * @param path Path to the hash list file.
+         * @return bool representing if the file could be mapped and is valid. If not, the hash list that was
+         *         loaded is kept. Check GetStatus().loaded to also validate a deferred checksum.
+         */
+        bool LoadFile(const std::string &path);
+
+        /**
+         * @brief Compiles a hash list into the precompiled (v2) format.
+         * 
+         * The v2 format stores the lookup tables alongside the strings, so loading it
+         * (especially through LoadFile) doesn't need to build anything.
+         * 
+         * @param data The (v1) hash list file data.
+         * @return std::vector<char> The v2 hash list, empty if the input is invalid.
+         */
+        std::vector<char> Compile(std::span<const char> data);
+
+        /**
+         * @brief A hash and the string it is the CRC32 of.
+         */
+        struct Entry
+        {
+            uint32_t hash;
+            std::string value;
+        };
+
+        /**
+         * @brief Entries to add to a hash list, per section.
+         */
+        struct Entries
+        {
+            std::vector<Entry> soundtags;
+            std::vector<Entry> switches;
+            std::vector<Entry> lines;
+        };
+
+        /**
+         * @brief Adds entries to a hash list, i.e. newly cracked hashes.
+         * 
+         * Entries whose hash is already in their section are skipped, so existing strings are never replaced.
+         * The version is incremented and the output is in the same format (v1 or v2) as the input.
+         * 
+         * @param data The hash list file data, or empty to start a new (v1) hash list.
+         * @param entries The entries to add.
+         * @return std::vector<char> The extended hash list, empty if the input is invalid.
+         */
+        std::vector<char> Extend(std::span<const char> data, const Entries &entries);
+
         /**
          * @brief Clear the currently loaded hash list.
          */
@@ -74,7 +202,7 @@ namespace Language
          * @param value The string to find the hash of.
          * @return std::string The zero-padded, 4-byte, string of the hash, or the input if not found/loaded.
          */
-        std::string GetLineHash(std::string value);
+        std::string GetLineHash(std::string_view value);
 
         /**
          * @brief Gets the LINE value from a given hash.
@@ -85,6 +213,129 @@ namespace Language
         std::string GetLine(uint32_t hash);
     } // namespace HashList
 
+    /**
+     * @brief A hash list that conversions resolve hashes through, the functions in HashList use the default one.
+     *
+     * Loading a new hash list swaps it in atomically. Each conversion takes the list that is loaded when it starts and
+     * keeps using it until it's done, so a context can be reloaded (or cleared) while other threads are converting
+     * with it. The old list is freed once the last conversion using it finishes.
+     *
+     * The Convert/Rebuild functions of formats that contain hashes take a context, the default one if not supplied.
+     */
+    class HashListContext
+    {
+    public:
+        HashListContext();
+        ~HashListContext();
+
+        HashListContext(const HashListContext &) = delete;
+        HashListContext &operator=(const HashListContext &) = delete;
+
+        /**
+         * @brief The context used by the functions in HashList, and by conversions that aren't given one.
+         */
+        static HashListContext &Default();
+
+        /**
+         * @brief Same as HashList::Load, for this context. The current list is kept until the new one is swapped in,
+         *        and if the new one isn't valid it stays loaded.
+         */
+        bool Load(std::vector<char> data);
+
+        /**
+         * @brief Same as Load above, for this context.
+         */
+        bool Load(const char* ptr, uint32_t size);
+
+        /**
+         * @brief Same as HashList::LoadFile, for this context.
+         */
+        bool LoadFile(const std::string &path);
+
+        /**
+         * @brief Loads the hash list other has loaded (or none, if it has none), sharing it rather than copying it.
+         *
+         * This context keeps the list when other is reloaded, so i.e. a job can take one snapshot of the hash list
+         * and use it for everything it does, even if other is reloaded halfway through.
+         */
+        void Share(const HashListContext &other);
+
+        void Clear();
+        HashList::Status GetStatus() const;
+        std::string GetLineHash(std::string_view value) const;
+        std::string GetLine(uint32_t hash) const;
+
+    private:
+        friend class HashListScope;
+
+        struct State;
+        std::unique_ptr<State> state;
+    };
+
+    /**
+     * @brief Where the conversions on a thread spend their time, and how much work they do, see StatsScope.
+     *
+     * The times of the phases don't overlap, a phase that runs inside another (decryption while decoding) is only
+     * counted once. The streaming rebuilds write the file as the JSON is parsed, so for those it's all JSON parsing.
+     */
+    struct Stats
+    {
+        enum class Phase : uint8_t
+        {
+            ParseMeta, // Parsing the .meta.json
+            ParseJson, // Parsing the HMLanguages JSON
+            Decrypt,
+            Encrypt,
+            BuildTree, // Reading the raw file, or the parsed JSON, into the structures it's converted from
+            Encode, // Writing the raw file
+            Dump, // Writing the HMLanguages JSON, or the .meta.json
+            Count
+        };
+
+        static constexpr const char* PhaseNames[] = {"meta parsing", "JSON parsing", "decryption", "encryption", "tree building", "encoding", "dump"};
+
+        uint64_t phaseNanoseconds[(size_t)Phase::Count] = {};
+        uint64_t totalNanoseconds = 0; // The time the scopes were alive for, including anything outside the phases
+
+        uint64_t bytesDecrypted = 0;
+        uint64_t bytesEncrypted = 0;
+        uint64_t strings = 0; // LOCR strings, DLGE and RTLV subtitles
+        uint64_t hashHits = 0; // Hashes resolved (or looked up) through the hash list
+        uint64_t hashMisses = 0;
+        uint64_t allocations = 0; // Only counted if the program calls CountAllocation
+        uint64_t allocatedBytes = 0;
+
+        Stats &operator+=(const Stats &other);
+
+        /**
+         * @brief Counts a heap allocation towards the stats being collected on this thread, if there are any.
+         *
+         * The library can't see allocations on its own, a program that wants them counted calls this from its operator new.
+         */
+        static void CountAllocation(size_t size);
+    };
+
+    /**
+     * @brief Collects the stats of every conversion run on this thread into a Stats while it's alive.
+     *
+     * Without a scope nothing is timed or counted, all a conversion pays is checking if there's a scope.
+     */
+    class StatsScope
+    {
+    public:
+        explicit StatsScope(Stats &stats);
+        ~StatsScope();
+
+        StatsScope(const StatsScope &) = delete;
+        StatsScope &operator=(const StatsScope &) = delete;
+
+    private:
+        Stats* previous;
+        uint8_t previousPhase;
+        uint64_t previousStart;
+        uint64_t start;
+    };
+
     namespace CLNG
     {
         /**
@@ -96,7 +347,14 @@ namespace Language
          * @param langMap Optional language map, will resolve from version if not supplied. [Default: ""]
          * @return std::string HMLanguages CLNG JSON representation of the input file.
          */
-        std::string Convert(Language::Version version, std::vector<char> data, std::string metaJson, std::string langMap = "");
+        std::string Convert(Language::Version version, std::span<const char> data, std::string_view metaJson, const LanguageMap &langMap = {});
+
+        /**
+         * @brief Same as Convert, but appends the JSON to output. The data is read in place.
+         * 
+         * @return bool representing if the conversion was successful.
+         */
+        bool ConvertInto(std::string &output, Language::Version version, std::span<const char> data, std::string_view metaJson, const LanguageMap &langMap = {});
         
         /**
          * @brief Rebuilds a HMLanguages CLNG JSON representation to a raw CLNG file + .meta.json.
@@ -104,7 +362,14 @@ namespace Language
          * @param jsonString The HMLanguages CLNG JSON.
          * @return Rebuilt struct containing the raw file + .meta.json string. 
          */
-        Rebuilt Rebuild(std::string jsonString);
+        Rebuilt Rebuild(std::string_view jsonString);
+
+        /**
+         * @brief Same as Rebuild, but writes into output, reusing its memory.
+         * 
+         * @return bool representing if the rebuild was successful.
+         */
+        bool RebuildInto(Rebuilt &output, std::string_view jsonString);
     } // namespace CLNG
 
     namespace DITL
@@ -114,17 +379,33 @@ namespace Language
          * 
          * @param data The raw DITL data.
          * @param metaJson The .meta.json file (from RPKG Tool) as a string.
+         * @param hashList Optional hash list context, the default one (see HashList) if not supplied.
          * @return std::string HMLanguages DITL JSON representation of the input file.
          */
-        std::string Convert(std::vector<char> data, std::string metaJson);
+        std::string Convert(std::span<const char> data, std::string_view metaJson, const HashListContext &hashList = HashListContext::Default());
+
+        /**
+         * @brief Same as Convert, but appends the JSON to output. The data is read in place.
+         * 
+         * @return bool representing if the conversion was successful.
+         */
+        bool ConvertInto(std::string &output, std::span<const char> data, std::string_view metaJson, const HashListContext &hashList = HashListContext::Default());
 
         /**
          * @brief Rebuilds a HMLanguages DITL JSON representation to a raw DITL file + .meta.json.
          * 
          * @param jsonString The HMLanguages DITL JSON.
+         * @param hashList Optional hash list context, the default one (see HashList) if not supplied.
          * @return Rebuilt struct containing the raw file + .meta.json string.
          */
-        Rebuilt Rebuild(std::string jsonString);
+        Rebuilt Rebuild(std::string_view jsonString, const HashListContext &hashList = HashListContext::Default());
+
+        /**
+         * @brief Same as Rebuild, but writes into output, reusing its memory.
+         * 
+         * @return bool representing if the rebuild was successful.
+         */
+        bool RebuildInto(Rebuilt &output, std::string_view jsonString, const HashListContext &hashList = HashListContext::Default());
     } // namespace DITL
 
     namespace DLGE
@@ -138,14 +419,32 @@ namespace Language
          * @param defaultLocale Optional default locale to set the default values for a WavFile. [Default: "en"]
          * @param hexPrecision Optional flag to output random weights as their hex value for higher precision. [Default: false]
          * @param langMap Optional language map, will resolve from version if not supplied. [Default: ""]
+         * @param hashList Optional hash list context, the default one (see HashList) if not supplied.
          * @return std::string HMLanguages DLGE JSON representation of the input file.
          */
         std::string Convert(Language::Version version,
-                            std::vector<char> data,
-                            std::string metaJson,
-                            std::string defaultLocale = "en",
+                            std::span<const char> data,
+                            std::string_view metaJson,
+                            std::string_view defaultLocale = "en",
                             bool hexPrecision = false,
-                            std::string langMap = "");
+                            const LanguageMap &langMap = {},
+                            const HashListContext &hashList = HashListContext::Default());
+
+        /**
+         * @brief Same as Convert, but appends the JSON to output.
+         * 
+         * The subtitles are decrypted in place, so the data is copied once (into a working copy that is then read in place).
+         * 
+         * @return bool representing if the conversion was successful.
+         */
+        bool ConvertInto(std::string &output,
+                         Language::Version version,
+                         std::span<const char> data,
+                         std::string_view metaJson,
+                         std::string_view defaultLocale = "en",
+                         bool hexPrecision = false,
+                         const LanguageMap &langMap = {},
+                         const HashListContext &hashList = HashListContext::Default());
 
         /**
          * @brief Rebuilds a HMLanguages DLGE JSON representation to a raw DLGE file + .meta.json.
@@ -154,9 +453,121 @@ namespace Language
          * @param jsonString The HMLanguages DLGE JSON.
          * @param defaultLocale Optional default locale for where to use the default values in a WavFile. [Default: "en"]
          * @param langMap Optional language map, will resolve from version if not supplied. [Default: ""]
+         * @param hashList Optional hash list context, the default one (see HashList) if not supplied.
          * @return Rebuilt struct containing the raw file + .meta.json string.
          */
-        Rebuilt Rebuild(Language::Version version, std::string jsonString, std::string defaultLocale = "en", std::string langMap = "");
+        Rebuilt Rebuild(Language::Version version,
+                        std::string_view jsonString,
+                        std::string_view defaultLocale = "en",
+                        const LanguageMap &langMap = {},
+                        const HashListContext &hashList = HashListContext::Default());
+
+        /**
+         * @brief Same as Rebuild, but writes into output, reusing its memory.
+         * 
+         * @return bool representing if the rebuild was successful.
+         */
+        bool RebuildInto(Rebuilt &output,
+                         Language::Version version,
+                         std::string_view jsonString,
+                         std::string_view defaultLocale = "en",
+                         const LanguageMap &langMap = {},
+                         const HashListContext &hashList = HashListContext::Default());
+
+        /**
+         * @brief Container types, the values are the ones used in the file.
+         */
+        enum class ContainerType : uint8_t
+        {
+            WavFile = 0x01,
+            Random,
+            Switch,
+            Sequence
+        };
+
+        /**
+         * @brief The wav/ffx index of a language without audio.
+         */
+        inline constexpr uint32_t NoDepend = UINT32_MAX;
+
+        /**
+         * @brief The audio and subtitle of a WavFile in one language.
+         */
+        struct Localization
+        {
+            uint32_t wav = NoDepend;    // Index of the WWES/WWEM in Document::depends
+            uint32_t ffx = NoDepend;    // Index of the FaceFX in Document::depends
+            std::optional<std::string> subtitle; // An empty subtitle is written as no subtitle
+        };
+
+        /**
+         * @brief A container in the DLGE tree, which members are used depends on its type and the type of its parent.
+         */
+        struct Container
+        {
+            ContainerType type = ContainerType::WavFile;
+
+            // WavFile
+            uint32_t soundtag = 0;
+            uint32_t wavName = 0;
+            std::vector<Localization> localizations; // One per Document::languages entry
+
+            // Switch
+            uint32_t switchKey = 0;
+            uint32_t defaultCase = 0;
+
+            // Set on the children of a Random (weight, 0 - 0xFFFFFF) or Switch (cases) container.
+            uint32_t weight = 0;
+            std::vector<uint32_t> cases;
+
+            // Random, Switch, and Sequence
+            std::vector<Container> containers;
+        };
+
+        /**
+         * @brief An entry of the .meta.json hash_reference_data.
+         */
+        struct Depend
+        {
+            std::string hash;
+            std::string flag;
+        };
+
+        /**
+         * @brief A DLGE as a tree of containers, everything in it maps directly to the file.
+         */
+        struct Document
+        {
+            std::vector<std::string> languages;
+            std::vector<Depend> depends;
+            uint32_t ditl = 0;  // Index of the DITL in depends
+            uint32_t clng = 1;  // Index of the CLNG in depends
+            Container root;
+        };
+
+        /**
+         * @brief Decodes a raw DLGE into a Document.
+         *
+         * Only the file is read, so the depends are left empty and the indices in the document refer
+         * to the hash_reference_data of the .meta.json, which the caller can fill them in from if needed.
+         *
+         * @param document The document to decode into, it is only changed on success.
+         * @param version The game version the DLGE is from, used for langmap resolution and version specific quirks.
+         * @param data The raw DLGE data.
+         * @param langMap Optional language map, will resolve from version if not supplied. [Default: ""]
+         * @return bool representing if decoding was successful.
+         */
+        bool Decode(Document &document, Language::Version version, std::span<const char> data, const LanguageMap &langMap = {});
+
+        /**
+         * @brief Encodes a Document into a raw DLGE, the depends of the document aren't used (they belong in the .meta.json).
+         *
+         * @param output The raw DLGE, it is cleared first and left empty on failure.
+         * @param version The game version to encode the DLGE for.
+         * @param document The document to encode.
+         * @return bool representing if encoding was successful.
+         */
+        bool Encode(std::vector<char> &output, Language::Version version, const Document &document);
     } // namespace DLGE
 
     namespace LOCR
@@ -169,9 +580,30 @@ namespace Language
          * @param metaJson The .meta.json file (from RPKG Tool) as a string.
          * @param langMap Optional language map, will resolve from version if not supplied. [Default: ""]
          * @param symmetric Optional flag for if a symmetric cipher should be used. [Default: false]
+         * @param hashList Optional hash list context, the default one (see HashList) if not supplied.
          * @return std::string HMLanguages LOCR JSON representation of the input file.
          */
-        std::string Convert(Language::Version version, std::vector<char> data, std::string metaJson, std::string langMap = "", bool symmetric = false);
+        std::string Convert(Language::Version version,
+                            std::span<const char> data,
+                            std::string_view metaJson,
+                            const LanguageMap &langMap = {},
+                            bool symmetric = false,
+                            const HashListContext &hashList = HashListContext::Default());
+
+        /**
+         * @brief Same as Convert, but appends the JSON to output.
+         * 
+         * The strings are decrypted in place, so the data is copied once (into a working copy that is then read in place).
+         * 
+         * @return bool representing if the conversion was successful.
+         */
+        bool ConvertInto(std::string &output,
+                         Language::Version version,
+                         std::span<const char> data,
+                         std::string_view metaJson,
+                         const LanguageMap &langMap = {},
+                         bool symmetric = false,
+                         const HashListContext &hashList = HashListContext::Default());
 
         /**
          * @brief Rebuilds a HMLanguages LOCR JSON representation to a raw LOCR file + .meta.json.
@@ -179,9 +611,66 @@ namespace Language
          * @param version The game version the LOCR is from, used for version specific quirks.
          * @param jsonString The HMLanguages LOCR JSON.
          * @param symmetric Optional flag for if a symmetric cipher should be used. [Default: false]
+         * @param hashList Optional hash list context, the default one (see HashList) if not supplied.
          * @return Rebuilt struct containing the raw file + .meta.json string.
          */
-        Rebuilt Rebuild(Language::Version version, std::string jsonString, bool symmetric = false);
+        Rebuilt Rebuild(Language::Version version, std::string_view jsonString, bool symmetric = false, const HashListContext &hashList = HashListContext::Default());
+
+        /**
+         * @brief Same as Rebuild, but writes into output, reusing its memory. The JSON is parsed in place.
+         * 
+         * @return bool representing if the rebuild was successful.
+         */
+        bool RebuildInto(Rebuilt &output, Language::Version version, std::string_view jsonString, bool symmetric = false, const HashListContext &hashList = HashListContext::Default());
+
+        /**
+         * @brief A string of a LOCR and its LINE hash.
+         */
+        struct Line
+        {
+            uint32_t hash;
+            std::string text;
+        };
+
+        /**
+         * @brief The strings of one language, a table without lines is written as an empty language.
+         */
+        struct Table
+        {
+            std::string language;
+            std::vector<Line> lines;
+        };
+
+        /**
+         * @brief A LOCR as its per-language string tables, in the order they are in the file.
+         */
+        struct Document
+        {
+            std::vector<Table> tables;
+            bool symmetric = false; // Only used for H2016
+        };
+
+        /**
+         * @brief Decodes a raw LOCR into a Document.
+         *
+         * @param document The document to decode into, it is only changed on success.
+         * @param version The game version the LOCR is from, used for langmap resolution and version specific quirks.
+         * @param data The raw LOCR data.
+         * @param langMap Optional language map, will resolve from version if not supplied. [Default: ""]
+         * @param symmetric Optional flag for if a symmetric cipher should be used. [Default: false]
+         * @return bool representing if decoding was successful.
+         */
+        bool Decode(Document &document, Language::Version version, std::span<const char> data, const LanguageMap &langMap = {}, bool symmetric = false);
+
+        /**
+         * @brief Encodes a Document into a raw LOCR.
+         *
+         * @param output The raw LOCR, it is cleared first.
+         * @param version The game version to encode the LOCR for.
+         * @param document The document to encode.
+         * @return bool representing if encoding was successful.
+         */
+        bool Encode(std::vector<char> &output, Language::Version version, const Document &document);
     } // namespace LOCR
 
     namespace RTLV
@@ -194,7 +683,16 @@ namespace Language
          * @param metaJson The .meta.json file (from RPKG Tool) as a string.
          * @return std::string HMLanguages RTLV JSON representation of the input file.
          */
-        std::string Convert(Language::Version version, std::vector<char> data, std::string metaJson);
+        std::string Convert(Language::Version version, std::span<const char> data, std::string_view metaJson);
+
+        /**
+         * @brief Same as Convert, but appends the JSON to output.
+         * 
+         * The RTLV is read natively, once the first one for the version has matched ResourceLib.
+         * 
+         * @return bool representing if the conversion was successful.
+         */
+        bool ConvertInto(std::string &output, Language::Version version, std::span<const char> data, std::string_view metaJson);
 
         /**
          * @brief Rebuilds a HMLanguages RTLV JSON representation to a raw RTLV file + .meta.json.
@@ -204,7 +702,93 @@ namespace Language
          * @param langMap Optional language map, will resolve from version if not supplied. [Default: ""]
          * @return Rebuilt struct containing the raw file + .meta.json string.
          */
-        Rebuilt Rebuild(Language::Version version, std::string jsonString, std::string langMap = "");
+        Rebuilt Rebuild(Language::Version version, std::string_view jsonString, const LanguageMap &langMap = {});
+
+        /**
+         * @brief Same as Rebuild, but writes into output, reusing its memory.
+         * 
+         * @return bool representing if the rebuild was successful.
+         */
+        bool RebuildInto(Rebuilt &output, Language::Version version, std::string_view jsonString, const LanguageMap &langMap = {});
     } // namespace RTLV
+
+    /**
+     * @brief The types of language resource, see Verify.
+     */
+    enum class ResourceType : uint8_t
+    {
+        CLNG,
+        DITL,
+        DLGE,
+        LOCR,
+        RTLV
+    };
+
+    namespace Verify
+    {
+        /**
+         * @brief The options a file is converted and rebuilt with, the same as the Convert/Rebuild parameters of its type.
+         *
+         * DLGEs are always converted with hex precision, the random weights can't round trip without it.
+         */
+        struct Options
+        {
+            LanguageMap langMap;
+            std::string defaultLocale = "en";
+            bool symmetric = false;
+        };
+
+        /**
+         * @brief How a file compares to the original after being converted to JSON and rebuilt.
+         */
+        struct Result
+        {
+            bool converted = false;
+            bool rebuilt = false;
+
+            size_t originalSize = 0;
+            size_t rebuiltSize = 0;
+            size_t firstDifference = SIZE_MAX; // Byte offset of the first difference, SIZE_MAX if the files are the same
+            size_t differentBytes = 0; // Differing bytes in the part both files have
+
+            bool hashMatches = false; // If the hash_value of the .meta.json is the same
+            size_t originalReferences = 0;
+            size_t rebuiltReferences = 0;
+            size_t firstReferenceDifference = SIZE_MAX; // Index of the first depend with a different hash or flag, SIZE_MAX if none
+
+            /**
+             * @brief If the file was rebuilt byte for byte, with the same hash and reference table.
+             */
+            bool Matches() const;
+
+            /**
+             * @brief A one line description of what differs, i.e. "file differs at 0x1C (3 bytes), depends differ at #2 (5 -> 4)".
+             */
+            std::string Summary() const;
+        };
+
+        /**
+         * @brief Converts a raw file + .meta.json to JSON and rebuilds it, all in memory, then compares the rebuilt file
+         * and the hash and reference table of its .meta.json to the originals.
+         *
+         * Depends are compared by their ResourceID, so a depend that the hash list resolved to a path still matches.
+         *
+         * @param result The comparison, reset first.
+         * @param type The type of the file.
+         * @param version The game version the file is from.
+         * @param data The raw file data.
+         * @param metaJson The .meta.json file (from RPKG Tool) as a string.
+         * @param options Optional options to convert and rebuild with.
+         * @param hashList Optional hash list context, the default one (see HashList) if not supplied.
+         * @return bool representing if the file round trips, the same as result.Matches().
+         */
+        bool RoundTrip(Result &result,
+                       ResourceType type,
+                       Language::Version version,
+                       std::span<const char> data,
+                       std::string_view metaJson,
+                       const Options &options = {},
+                       const HashListContext &hashList = HashListContext::Default());
+    } // namespace Verify
 } // namespace Language
 } // namespace TonyTools
\ No newline at end of file
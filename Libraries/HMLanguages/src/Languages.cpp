@@ -1,51 +1,178 @@
 #include "TonyTools/Languages.h"
 
 #include <iostream>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iterator>
-#include <regex>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <ResourceLib_HM2016.h>
 #include <ResourceLib_HM2.h>
 #include <ResourceLib_HM3.h>
 #include <nlohmann/json.hpp>
+#include <TonyTools/BinaryIO.h>
 #include <hash/md5.h>
 #include <hash/crc32.h>
 #include <tsl/ordered_map.h>
 
 #include "zip.hpp"
-#include "bimap.hpp"
-#include "buffer.hpp"
+#include "arena.hpp"
+#include "crypto.hpp"
+#include "games.hpp"
+#include "hashindex.hpp"
+#include "hex.hpp"
+#include "jsonwriter.hpp"
+#include "mapping.hpp"
 
 using namespace TonyTools::Language;
-using json = nlohmann::ordered_json;
+using TonyTools::BinaryIO::Reader;
+using TonyTools::BinaryIO::Writer;
 
-#pragma region Utility Functions
-bool is_valid_hash(std::string hash)
+#pragma region Stats
+// The stats being collected on this thread, and the phase being timed (Count for none). Without stats nothing is
+// timed or counted, so all the instrumentation costs when they're off is checking for them.
+struct StatsCollector
 {
-    const std::string valid_chars = "0123456789ABCDEF";
+    Stats* stats = nullptr;
+    uint8_t phase = (uint8_t)Stats::Phase::Count;
+    uint64_t phaseStart = 0;
+};
 
-    if (hash.length() != 16)
-        return false;
+constinit thread_local StatsCollector statsCollector;
+
+uint64_t statsClock()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Adds the time since the current phase started to it, and starts timing another.
+void switchPhase(uint8_t phase)
+{
+    uint64_t now = statsClock();
+    if (statsCollector.phase != (uint8_t)Stats::Phase::Count)
+        statsCollector.stats->phaseNanoseconds[statsCollector.phase] += now - statsCollector.phaseStart;
+
+    statsCollector.phase = phase;
+    statsCollector.phaseStart = now;
+}
+
+// Times a phase until it's destroyed (or moved on to the next one), the phase it was started in is paused meanwhile.
+class PhaseTimer
+{
+public:
+    explicit PhaseTimer(Stats::Phase phase) : active(statsCollector.stats != nullptr)
+    {
+        if (!active)
+            return;
+
+        previous = statsCollector.phase;
+        switchPhase((uint8_t)phase);
+    }
+
+    ~PhaseTimer()
+    {
+        if (active)
+            switchPhase(previous);
+    }
+
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+    void next(Stats::Phase phase)
+    {
+        if (active)
+            switchPhase((uint8_t)phase);
+    }
+
+private:
+    bool active;
+    uint8_t previous = 0;
+};
+
+void countStat(uint64_t Stats::*counter, uint64_t count = 1)
+{
+    if (statsCollector.stats)
+        statsCollector.stats->*counter += count;
+}
+
+Stats &Stats::operator+=(const Stats &other)
+{
+    for (size_t i = 0; i < (size_t)Phase::Count; i++)
+        phaseNanoseconds[i] += other.phaseNanoseconds[i];
+
+    totalNanoseconds += other.totalNanoseconds;
+    bytesDecrypted += other.bytesDecrypted;
+    bytesEncrypted += other.bytesEncrypted;
+    strings += other.strings;
+    hashHits += other.hashHits;
+    hashMisses += other.hashMisses;
+    allocations += other.allocations;
+    allocatedBytes += other.allocatedBytes;
+
+    return *this;
+}
+
+void Stats::CountAllocation(size_t size)
+{
+    if (Stats* stats = statsCollector.stats)
+    {
+        stats->allocations++;
+        stats->allocatedBytes += size;
+    }
+}
+
+// A scope inside another pauses the outer one's phase, which starts again once the inner scope ends.
+StatsScope::StatsScope(Stats &stats) : previous(statsCollector.stats), previousPhase(statsCollector.phase), start(statsClock())
+{
+    if (previousPhase != (uint8_t)Stats::Phase::Count)
+        previous->phaseNanoseconds[previousPhase] += start - statsCollector.phaseStart;
+
+    statsCollector = {&stats, (uint8_t)Stats::Phase::Count, 0};
+}
 
-    return std::all_of(hash.begin(), hash.end(), ::isxdigit);
+StatsScope::~StatsScope()
+{
+    switchPhase((uint8_t)Stats::Phase::Count);
+
+    uint64_t now = statsClock();
+    statsCollector.stats->totalNanoseconds += now - start;
+    statsCollector = {previous, previousPhase, now};
 }
+#pragma endregion
 
-std::string computeHash(std::string str)
+#pragma region Utility Functions
+// The ResourceID of a path: the MD5 of it, with the top byte cleared.
+HexChars<16> computeHash(std::string_view str)
 {
     MD5 md5;
-    str = "00" + md5(str).substr(2, 14);
-    std::transform(str.begin(), str.end(), str.begin(), ::toupper);
+    md5.add(str.data(), str.size());
 
-    return str;
+    unsigned char digest[MD5::HashBytes];
+    md5.getHash(digest);
+
+    uint64_t id = 0;
+    for (size_t i = 1; i < 8; i++)
+        id = (id << 8) | digest[i];
+
+    return hex16(id);
 }
 
 std::string generateMeta(std::string hash, uint32_t size, std::string type, tsl::ordered_map<std::string, std::string> depends)
 {
+    PhaseTimer timer(Stats::Phase::Dump);
+
     json j = {
-        {"hash_value", is_valid_hash(hash) ? hash : computeHash(hash)},
+        {"hash_value", isResourceID(hash) ? hash : std::string(computeHash(hash))},
         {"hash_offset", 0x10000000},
         {"hash_size", 0x80000000 + size},
         {"hash_resource_type", type},
@@ -141,520 +268,2030 @@ ResourceGenerator* getGenerator(Version version, const char *resourceType)
     }
 }
 
-std::vector<std::string> split(std::string str)
+// Splits a langmap on runs of commas, the same as the regex split it replaces: a leading empty language is kept,
+// a trailing one isn't (",en,,fr," is "", "en" and "fr").
+std::vector<std::string> split(std::string_view str)
 {
-    std::regex regex{R"([,]+)"};
-    std::sregex_token_iterator it{str.begin(), str.end(), regex, -1};
-    return std::vector<std::string>{it, {}};
-}
+    std::vector<std::string> languages;
 
-// From https://github.com/glacier-modding/RPKG-Tool/blob/145d8d7d9711d57f1434489706c3d81b2feeed73/src/crypto.cpp#L3-L41
-constexpr uint32_t xteaKeys[4] = {0x53527737, 0x7506499E, 0xBD39AEE3, 0xA59E7268};
-constexpr uint32_t xteaDelta = 0x9E3779B9;
-constexpr uint32_t xteaRounds = 32;
-
-std::string xteaDecrypt(std::vector<char> data)
-{
-    for (uint32_t i = 0; i < data.size() / 8; i++)
+    size_t start = 0;
+    while (true)
     {
-        uint32_t* v0 = (uint32_t*)(data.data() + (i * 8));
-        uint32_t* v1 = (uint32_t*)(data.data() + (i * 8) + 4);
-
-        uint32_t sum = xteaDelta * xteaRounds;
-
-        for (uint32_t j = 0; j < xteaRounds; j++)
+        size_t comma = str.find(',', start);
+        if (comma == std::string_view::npos)
         {
-            *v1 -= (*v0 << 4 ^ *v0 >> 5) + *v0 ^ sum + xteaKeys[sum >> 11 & 3];
-            sum -= xteaDelta;
-            *v0 -= (*v1 << 4 ^ *v1 >> 5) + *v1 ^ sum + xteaKeys[sum & 3];
+            languages.emplace_back(str.substr(start));
+            break;
         }
+
+        languages.emplace_back(str.substr(start, comma - start));
+
+        start = str.find_first_not_of(',', comma);
+        if (start == std::string_view::npos)
+            break;
     }
 
-    return std::string(data.begin(), std::find(data.begin(), data.end(), '\0'));
+    return languages;
 }
 
-std::vector<char> xteaEncrypt(std::string str)
+struct LanguageMap::Entry
 {
-    std::vector<char> data(str.begin(), str.end());
-    uint32_t paddedSize = data.size() + (data.size() % 8 == 0 ? 0 : 8 - (data.size() % 8));
-    data.resize(paddedSize, '\0');
+    std::string str;
+    std::vector<std::string> languages;
+};
 
-    for (uint32_t i = 0; i < paddedSize / 8; i++)
-    {
-        uint32_t* v0 = (uint32_t*)(data.data() + (i * 8));
-        uint32_t* v1 = (uint32_t*)(data.data() + (i * 8) + 4);
+LanguageMap::LanguageMap(std::string_view langMap)
+{
+    if (langMap.empty())
+        return;
 
-        uint32_t sum = 0;
+    // Only a handful of different langmaps are ever used, the limit is just in case something feeds in a lot of them.
+    static std::mutex mutex;
+    static std::unordered_map<std::string, std::shared_ptr<const Entry>> cache;
 
-        for (uint32_t j = 0; j < xteaRounds; j++)
-        {
-            *v0 += (((*v1 << 4) ^ (*v1 >> 5)) + *v1) ^ (sum + xteaKeys[sum & 3]);
-            sum += xteaDelta;
-            *v1 += (((*v0 << 4) ^ (*v0 >> 5)) + *v0) ^ (sum + xteaKeys[(sum >> 11) & 3]);
-        }
+    std::string key(langMap);
+    std::lock_guard lock(mutex);
+
+    if (auto it = cache.find(key); it != cache.end())
+    {
+        entry = it->second;
+        return;
     }
 
-    return data;
+    if (cache.size() >= 256)
+        cache.clear();
+
+    entry = std::make_shared<const Entry>(Entry{key, split(langMap)});
+    cache.emplace(std::move(key), entry);
 }
 
-std::vector<char> symmetricEncrypt(std::string str)
+LanguageMap LanguageMap::BuiltIn(Version version, bool dlge)
 {
-    std::vector<char> data(str.begin(), str.end());
+    return dispatch(version, [dlge]<Version V>(Game<V>) {
+        std::string langMap;
+        for (std::string_view language : dlge ? Game<V>::dlgeLanguages : Game<V>::languages)
+            langMap.append(langMap.empty() ? "" : ",").append(language);
 
-    for (char &value : data)
-    {
-        value ^= 226;
-        value = (value & 0x81) | (value & 2) << 1 | (value & 4) << 2 | (value & 8) << 3 | (value & 0x10) >> 3 |
-           (value & 0x20) >> 2 | (value & 0x40) >> 1;
-    }
-
-    return data;
+        return LanguageMap(langMap);
+    });
 }
 
-std::string symmetricDecrypt(std::vector<char> data)
+const std::vector<std::string> &LanguageMap::languages() const
 {
-    for (char &value : data)
-    {
-        value = (value & 1) | (value & 2) << 3 | (value & 4) >> 1 | (value & 8) << 2 | (value & 16) >> 2 | (value & 32) << 1 |
-            (value & 64) >> 3 | (value & 128);
-        value ^= 226;
-    }
-    
-    return std::string(data.begin(), data.end());
+    static const std::vector<std::string> none;
+    return entry ? entry->languages : none;
 }
 
-std::string getWavName(std::string path, std::string ffxPath, std::string hash)
+std::string_view LanguageMap::str() const
 {
-    if (is_valid_hash(path) && is_valid_hash(ffxPath))
-        return hash;
-
-    std::regex r{R"([^\/]*(?=\.wav))"};
-    std::regex ffxR{R"([^\/]*(?=\.animset))"};
-    std::smatch m;
-    std::regex_search(path, m, r);
-
-    if (m.size() != 1)
-    {
-        std::regex_search(ffxPath, m, ffxR);
-        if (m.size() != 1)
-            return hash;
-    }
-
-    CRC32 crc32;
-
-    std::string hashedName = std::format("{:08X}", crc32(m[0]));
-
-    return hashedName == hash ? m[0] : hash;
+    return entry ? std::string_view(entry->str) : std::string_view();
 }
 
-uint32_t hexStringToNum(std::string string)
+// The languages of a langmap property in a JSON. Unlike a langMap argument, an empty property isn't the
+// built-in map, it's a map of one empty language. The given map keeps the languages alive.
+const std::vector<std::string> &propertyLanguages(LanguageMap &map, const std::string &langMap)
 {
-    CRC32 crc32;
+    static const std::vector<std::string> emptyLanguage = {""};
 
-    uint32_t num = std::strtoul(string.c_str(), nullptr, 16);
-    if (!std::all_of(string.begin(), string.end(), ::isxdigit))
-        return crc32(string);
-
-    return num;
+    map = LanguageMap(langMap);
+    return map.empty() ? emptyLanguage : map.languages();
 }
-#pragma endregion
 
-#pragma region Hash List
-static stde::bimap<uint32_t, std::string> TagMap = {};
-static stde::bimap<uint32_t, std::string> SwitchMap = {};
-static stde::bimap<uint32_t, std::string> LineMap = {};
-static HashList::Status HashListStatus = { false, (uint32_t)-1 };
+// A name found in a depend path, and the CRC32 of it the wav name is checked against.
+struct PathName
+{
+    bool found = false;
+    std::string name;
+    HexChars<8> crc;
+};
 
-HashList::Status HashList::GetStatus() { return HashListStatus; }
+// Finds the name the same way the regex [^/]*(?=\.wav) did: the first path segment holding the extension,
+// up to the last place it's in that segment. Paths repeat a lot across DLGEs (FaceFX animsets especially),
+// so each is only parsed and hashed once per thread, which keeps the parallel batch paths lock-free.
+const PathName &pathName(const std::string &path, std::string_view extension)
+{
+    thread_local std::unordered_map<std::string, PathName> wavs, animsets;
+    std::unordered_map<std::string, PathName> &cache = extension == ".wav" ? wavs : animsets;
 
-void HashList::Clear() {
-    TagMap.clear();
-    SwitchMap.clear();
-    LineMap.clear();
-    HashListStatus = { false, (uint32_t)-1 };
-}
+    if (auto it = cache.find(path); it != cache.end())
+        return it->second;
 
-bool HashList::Load(std::vector<char> data) {
-    buffer buff(data);
+    if (cache.size() >= 65536)
+        cache.clear();
 
-    Clear();
+    PathName pathName;
+    for (size_t start = 0;;)
+    {
+        size_t end = path.find('/', start);
+        std::string_view segment = std::string_view(path).substr(start, end == std::string::npos ? std::string::npos : end - start);
 
-    // Magic
-    if (buff.read<uint32_t>() != 'ALMH')
-        return false;
+        if (size_t found = segment.rfind(extension); found != std::string_view::npos)
+        {
+            CRC32 crc32;
+            pathName.found = true;
+            pathName.name = segment.substr(0, found);
+            pathName.crc = hex8(crc32(pathName.name.data(), pathName.name.size()));
+            break;
+        }
 
-    // Version
-    HashListStatus.version = buff.read<uint32_t>();
+        if (end == std::string::npos)
+            break;
 
-    // Checksum
-    uint32_t checksum = buff.read<uint32_t>();
-    CRC32 crc32;
-    if (checksum != crc32(buff.data().data() + buff.index, buff.size() - buff.index)) {
-        HashListStatus.version = -1;
-        return false;
+        start = end + 1;
     }
 
-    // Soundtags
-    uint32_t nSoundtags = buff.read<uint32_t>();
-    for (uint32_t i = 0; i < nSoundtags; i++) {
-        uint32_t hash = buff.read<uint32_t>();
-        std::string value = buff.read<std::string>();
-        TagMap.insert(hash, value);
-    }
+    return cache.emplace(path, std::move(pathName)).first->second;
+}
 
-    uint32_t nSwitches = buff.read<uint32_t>();
-    for (uint32_t i = 0; i < nSwitches; i++) {
-        uint32_t hash = buff.read<uint32_t>();
-        std::string value = buff.read<std::string>();
-        SwitchMap.insert(hash, value);
-    }
+// The view is only valid until the next call.
+std::string_view getWavName(const std::string &path, const std::string &ffxPath, std::string_view hash)
+{
+    if (isResourceID(path) && isResourceID(ffxPath))
+        return hash;
 
-    uint32_t nLines = buff.read<uint32_t>();
-    for (uint32_t i = 0; i < nLines; i++) {
-        uint32_t hash = buff.read<uint32_t>();
-        std::string value = buff.read<std::string>();
-        LineMap.insert(hash, value);
+    const PathName* name = &pathName(path, ".wav");
+    if (!name->found)
+    {
+        name = &pathName(ffxPath, ".animset");
+        if (!name->found)
+            return hash;
     }
 
-    if (buff.index != buff.size()) {
-        Clear();
-        return false;
-    }
+    return name->crc == hash ? std::string_view(name->name) : hash;
+}
+
+uint32_t hexStringToNum(std::string_view string)
+{
+    CRC32 crc32;
 
-    HashListStatus.loaded = true;
+    if (!isHex(string))
+        return crc32(string.data(), string.size());
 
-    return true;
+    return parseHex32(string);
 }
 
-bool HashList::Load(const char* ptr, uint32_t size) {
-    return Load(std::vector<char>(ptr, ptr + size));
+// Same as get<std::string>() (and the same error for non-strings), without the copy.
+const std::string &jsonStringRef(const json &value)
+{
+    if (!value.is_string())
+        throw json::type_error::create(302, std::string("type must be string, but is ") + value.type_name(), &value);
+
+    return value.get_ref<const std::string&>();
 }
 
-std::string HashList::GetLineHash(std::string value) {
-    if (!HashListStatus.loaded) return value;
+// Writes a string as a padded XTEA array in plaintext, the batch encrypts it once the whole file has been written.
+void writeXteaString(Writer &buff, std::string_view str, XteaBatch &batch)
+{
+    size_t paddedSize = xteaPaddedSize(str.size());
 
-    return LineMap.has_value(value) ? std::format("{:08X}", LineMap.get_key(value)) : value;
+    buff.write<uint32_t>(paddedSize);
+    batch.add(buff.size(), paddedSize);
+    buff.writeRaw(str.data(), str.size());
+    buff.pad(paddedSize - str.size());
 }
 
-std::string HashList::GetLine(uint32_t hash) {
-    if (!HashListStatus.loaded) return std::format("{:08X}", hash);
+// A hash resolved through a hash list index, or the zero-padded, 4-byte, hex of it held in place if it isn't in there.
+struct ResolvedHash
+{
+    std::optional<std::string_view> value;
+    HexChars<8> hex;
+
+    std::string_view view() const { return value ? *value : hex.view(); }
+};
 
-    return LineMap.has_key(hash) ? LineMap.get_value(hash) : std::format("{:08X}", hash);
+ResolvedHash resolveHash(const HashIndex &index, uint32_t hash)
+{
+    std::optional<std::string_view> value = index.value(hash);
+    countStat(value ? &Stats::hashHits : &Stats::hashMisses);
+
+    if (value)
+        return {value, {}};
+
+    return {std::nullopt, hex8(hash)};
 }
-#pragma endregion
 
-#pragma region RTLV
-std::string RTLV::Convert(Version version, std::vector<char> data, std::string metaJson)
+// The keys already written to a JSON object, for the formats that only keep the first of a repeated key.
+// The table is sized for every key up front, so inserting never allocates. The keys have to outlive the set.
+class KeySet
 {
-    ResourceConverter *converter = getConverter(version, "RTLV");
-    if (!converter)
+public:
+    void reset(size_t count)
     {
-        fprintf(stderr, "[LANG//RTLV] Could not get converter!\n");
-        return "";
-    }
+        size_t size = 16;
+        while (size < count * 2)
+            size *= 2;
 
-    JsonString *converted = converter->FromMemoryToJsonString(data.data(), data.size());
-    if (!converted)
-    {
-        fprintf(stderr, "[LANG//RTLV] Could not convert RTLV to ResourceLib JSON!\n");
-        return "";
+        slots.assign(size, std::string_view());
+        mask = size - 1;
     }
 
-    json j = {
-        {"$schema", "https://tonytools.win/schemas/rtlv.schema.json"},
-        {"hash", ""},
-        {"videos", json::object()},
-        {"subtitles", json::object()}
-    };
-
-    try
+    // Gives false if the key is already in the set.
+    bool insert(std::string_view key)
     {
-        json jConv = json::parse(converted->JsonData);
-        converter->FreeJsonString(converted);
-
-        if (jConv.at("AudioLanguages").size() != jConv.at("VideoRidsPerAudioLanguage").size())
+        for (size_t i = std::hash<std::string_view>{}(key) & mask;; i = (i + 1) & mask)
         {
-            fprintf(stderr, "[LANG//RTLV] Mismatch in languages and resource IDs in RL JSON!\n");
-            return "";
-        }
-
-        for (const auto &[lang, id] : c9::zip(jConv.at("AudioLanguages"), jConv.at("VideoRidsPerAudioLanguage")))
-            j.at("videos").push_back({lang, std::format("{:08X}{:08X}", id.at("m_IDHigh").get<uint32_t>(), id.at("m_IDLow").get<uint32_t>())});
+            if (!slots[i].data())
+            {
+                slots[i] = key;
+                return true;
+            }
 
-        if (jConv.at("SubtitleLanguages").size() != jConv.at("SubtitleMarkupsPerLanguage").size())
-        {
-            fprintf(stderr, "[LANG//RTLV] Mismatch in subtitle languages and content in RL JSON!\n");
-            return "";
+            if (slots[i] == key)
+                return false;
         }
+    }
 
-        for (const auto &[lang, text] : c9::zip(jConv.at("SubtitleLanguages"), jConv.at("SubtitleMarkupsPerLanguage")))
-            j.at("subtitles").push_back({lang, text});
-
-        json meta = json::parse(metaJson);
-        j.at("hash") = meta["hash_path"].is_null() ? meta.at("hash_value") : meta.at("hash_path");
+private:
+    std::vector<std::string_view> slots; // Empty slots have no data, every key does.
+    size_t mask = 0;
+};
 
-        return j.dump();
-    }
-    catch (const json::exception& err)
-    {
-        if (converted)
-            converter->FreeJsonString(converted);
+// Gets the hash of a string through a hash list index, otherwise parses (or CRC32s) the string itself.
+uint32_t lookupHash(const HashIndex &index, std::string_view value)
+{
+    std::optional<uint32_t> hash = index.key(value);
+    countStat(hash ? &Stats::hashHits : &Stats::hashMisses);
 
-        fprintf(stderr, "[LANG//RTLV] JSON error:\n"
-                        "\t%s\n", err.what());
-    }
+    if (hash)
+        return *hash;
 
-    return "";
+    return hexStringToNum(value);
 }
 
-Rebuilt RTLV::Rebuild(Version version, std::string jsonString, std::string langMap)
+// Base for the SAX driven rebuilds, these write the output while the JSON is being parsed instead of building a DOM first.
+// Any input the handler doesn't expect makes it stop, the caller then falls back to the DOM rebuild which handles (and reports) it as before.
+class StreamingRebuild : public json::json_sax_t
 {
-    ResourceGenerator *generator = getGenerator(version, "RTLV");
-    if (!generator)
+public:
+    bool null() override { return value(Scalar::Null); }
+    bool boolean(bool val) override
     {
-        fprintf(stderr, "[LANG//RTLV] Could not get generator!\n");
-        return {};
+        booleanValue = val;
+        return value(Scalar::Boolean);
     }
-
-    Rebuilt out{};
-    tsl::ordered_map<std::string, std::string> depends{};
-
-    std::unordered_map<std::string, uint32_t> languages;
-    if (!langMap.empty())
+    bool number_integer(number_integer_t) override { return value(Scalar::Number); }
+    bool number_unsigned(number_unsigned_t) override { return value(Scalar::Number); }
+    bool number_float(number_float_t, const string_t &) override { return value(Scalar::Number); }
+    bool string(string_t &val) override
     {
-        std::vector<std::string> langs = split(langMap);
-        for (int i = 0; i < langs.size(); i++)
-            languages[langs.at(i)] = i;
+        stringValue = &val;
+        return value(Scalar::String);
     }
-    else if (version == Version::H3)
-        languages = {{"xx", 0}, {"en", 1}, {"fr", 2}, {"it", 3}, {"de", 4}, {"es", 5}, {"ru", 6}, {"cn", 7}, {"tc", 8}, {"jp", 9}};
-    else
-        languages = {{"xx", 0}, {"en", 1}, {"fr", 2}, {"it", 3}, {"de", 4}, {"es", 5}, {"ru", 6}, {"mx", 7}, {"br", 8}, {"pl", 9}, {"cn", 10}, {"jp", 11}, {"tc", 12}};
+    bool binary(binary_t &) override { return false; }
 
-    try
+    bool start_object(std::size_t) override { return start(true); }
+    bool end_object() override { return end(); }
+    bool start_array(std::size_t) override { return start(false); }
+    bool end_array() override { return end(); }
+
+    bool key(string_t &val) override
     {
-        json jSrc = json::parse(jsonString);
+        if (skipLevel)
+            return true;
 
-        if (jSrc.at("videos").size() < 1)
-        {
-            fprintf(stderr, "[LANG//RTLV] Videos object is empty!\n");
-            return {};
-        }
+        return onKey(val);
+    }
 
-        // The langmap property overrides any argument passed languages maps.
-        // This property ensures easy compat with tools like SMF.
-        if (jSrc.contains("langmap"))
-        {
-            languages.clear();
-            std::vector<std::string> langs = split(jSrc.at("langmap").get<std::string>());
-            for (int i = 0; i < langs.size(); i++)
-                languages[langs.at(i)] = i;
-        }
+    bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &) override { return false; }
 
-        json j = {
-            {"AudioLanguages", json::array()},
-            {"VideoRidsPerAudioLanguage", json::array()},
-            {"SubtitleLanguages", json::array()},
-            {"SubtitleMarkupsPerLanguage", json::array()}
-        };
+protected:
+    enum class Scalar
+    {
+        Null,
+        Boolean,
+        Number,
+        String
+    };
 
-        for (const auto &[lang, video] : jSrc.at("videos").items())
-        {
-            if (!languages.contains(lang))
-            {
-                fprintf(stderr, "[LANG//RTLV] Language map does not contain language \"%s\".\n", lang.c_str());
-                return {};
-            }
+    // Number of objects/arrays currently open, the root object is depth 1.
+    size_t depth = 0;
 
-            j.at("AudioLanguages").push_back(lang);
+    bool booleanValue = false;
+    std::string* stringValue = nullptr;
 
-            std::string vidHash = video.get<std::string>();
-            if (!is_valid_hash(vidHash))
-                vidHash = computeHash(vidHash);
+    virtual bool onKey(std::string &key) = 0;
+    virtual bool onValue(Scalar type) = 0;
+    virtual bool onStart(bool object) = 0;
+    virtual bool onEnd() = 0;
 
-            uint64_t id = std::strtoull(vidHash.c_str(), nullptr, 16);
+    // Ignores the value of the key that was just read, whatever it is.
+    void skipValue() { skipNext = true; }
 
-            j.at("VideoRidsPerAudioLanguage").push_back(json::object({{"m_IDHigh", id >> 32}, {"m_IDLow", id & ULONG_MAX}}));
+private:
+    bool skipNext = false;
+    size_t skipLevel = 0;
 
-            depends[vidHash] = std::format("{:2X}", 0x80 + languages[lang]);
-        }
+    bool value(Scalar type)
+    {
+        if (skipLevel)
+            return true;
 
-        for (const auto &[lang, text] : jSrc.at("subtitles").items())
+        if (skipNext)
         {
-            j.at("SubtitleLanguages").push_back(lang);
-            j.at("SubtitleMarkupsPerLanguage").push_back(text);
+            skipNext = false;
+            return true;
         }
 
-        std::string rlJson = j.dump();
-        ResourceMem *generated = generator->FromJsonStringToResourceMem(rlJson.c_str(), rlJson.size(), false);
-        if (!generated)
+        return onValue(type);
+    }
+
+    bool start(bool object)
+    {
+        if (skipLevel)
         {
-            fprintf(stderr, "[LANG//RTLV] Could not convert ResourceLib JSON to RTLV!\n");
-            return {};
+            skipLevel++;
+            return true;
         }
 
-        out.file.resize(generated->DataSize);
-        std::memcpy(out.file.data(), generated->ResourceData, generated->DataSize);
-        generator->FreeResourceMem(generated);
-
-        out.meta = generateMeta(jSrc.at("hash"), out.file.size(), "RTLV", depends);
+        if (skipNext)
+        {
+            skipNext = false;
+            skipLevel = 1;
+            return true;
+        }
 
-        return out;
+        depth++;
+        return onStart(object);
     }
-    catch (const json::exception& err)
+
+    bool end()
     {
-        fprintf(stderr, "[LANG//RTLV] JSON error:\n"
-                        "\t%s\n", err.what());
-    }
+        if (skipLevel)
+        {
+            skipLevel--;
+            return true;
+        }
 
-    return {};
-}
+        bool ok = onEnd();
+        depth--;
+        return ok;
+    }
+};
 #pragma endregion
 
-#pragma region LOCR
-std::string LOCR::Convert(Version version, std::vector<char> data, std::string metaJson, std::string langMap, bool symmetric)
+#pragma region Hash List
+// A loaded hash list, the file is either owned or mapped and the indices point into it.
+// The layout of every section is checked when loading, but sections are only indexed the first
+// time they're used, so a job that never resolves LINEs never pays for the (by far largest) lines section.
+struct LoadedHashList
 {
-    buffer buff(data);
+    std::vector<char> owned;
+    MappedFile mapped;
+    const char* data = nullptr;
+    size_t size = 0;
+    uint32_t version = 0;
 
-    bool isLOCRv2 = false;
-    if (version != Version::H2016)
-    {
-        buff.read<uint8_t>();
-        isLOCRv2 = true;
-    }
+    // Precompiled (v2) hash lists store their index tables, so sections are viewed rather than built.
+    bool precompiled = false;
 
-    json j = {
-        {"$schema", "https://tonytools.win/schemas/locr.schema.json"},
-        {"hash", ""},
-        {"symmetric", true},
-        {"languages", json::object()}
-    };
+    // Mapped files have their checksum validated on first use instead of when loading.
+    bool checksumPending = false;
+    std::once_flag checksumFlag;
+    std::atomic<bool> valid = true;
 
-    if (!symmetric || version != Version::H2016)
-        j.erase("symmetric");
+    struct Section
+    {
+        std::once_flag flag;
+        HashIndex index;
+        size_t start = 0; // Where the section's count is, for plain (v1) hash lists
+    } sections[3];
+};
 
-    uint32_t numLanguages = (buff.read<uint32_t>() - isLOCRv2) / 4;
-    buff.index -= 4;
-    std::vector<std::string> languages = {"xx", "en", "fr", "it", "de", "es", "ru", "mx", "br", "pl", "cn", "jp", "tc"};;
-    if (!langMap.empty())
-        languages = split(langMap);
-    else if (version == Version::H3)
-        languages = {"xx", "en", "fr", "it", "de", "es", "ru", "cn", "tc", "jp"};
+struct HashListContext::State
+{
+    std::atomic<std::shared_ptr<LoadedHashList>> list;
+};
+
+bool verifyHashList(LoadedHashList &list);
 
-    if (numLanguages > languages.size())
+// Declared as a friend of HashListContext, so it has to live in its namespace.
+namespace TonyTools::Language
+{
+// Pins the hash list of a context for the conversion running on this thread, a reload in the meantime
+// swaps in a new list for later conversions but this one keeps using (and owning) the one it started with.
+class HashListScope
+{
+public:
+    // Whether the list is used is decided here, once, so it can't change partway through the conversion.
+    HashListScope(const HashListContext &context) : list(context.state->list.load()), previous(active)
     {
-        fprintf(stderr, "[LANG//LOCR] Language map is smaller than the number of languages in the file!\n");
-        return "";
+        if (list && !verifyHashList(*list))
+            list.reset();
+
+        active = list.get();
     }
 
-    size_t oldIndex = buff.index;
-    for (int i = 0; i < numLanguages; i++)
-    {
-        j.at("languages").push_back({languages.at(i), json::object()});
+    ~HashListScope() { active = previous; }
 
-        uint32_t oldOffset = buff.index;
-        uint32_t offset;
-        buff.index = oldIndex;
-        if ((offset = buff.read<uint32_t>()) == ULONG_MAX)
-        {
-            buff.index = oldOffset;
-            oldIndex += 4;
-            continue;
-        }
-        buff.index = offset;
-        oldIndex += 4;
+    HashListScope(const HashListScope &) = delete;
+    HashListScope &operator=(const HashListScope &) = delete;
 
-        uint32_t numStrings = buff.read<uint32_t>();
-        for (int k = 0; k < numStrings; k++)
-        {
-            uint32_t hashNum = buff.read<uint32_t>();
-            std::string str = (symmetric && version == Version::H2016)
-                                ? symmetricDecrypt(buff.read<std::vector<char>>())
-                                : xteaDecrypt(buff.read<std::vector<char>>());
-            buff.index += 1;
+    static LoadedHashList* current() { return active; }
 
-            std::string hash = LineMap.has_key(hashNum) ? LineMap.get_value(hashNum) : std::format("{:08X}", hashNum);
-            j.at("languages").at(languages.at(i)).push_back({hash, str});
-        }
-    }
+    static std::shared_ptr<LoadedHashList> snapshot(const HashListContext &context) { return context.state->list.load(); }
+    static void install(HashListContext &context, std::shared_ptr<LoadedHashList> list) { context.state->list.store(std::move(list)); }
 
-    if (buff.index != buff.size())
-    {
-        fprintf(stderr, "[LANG//LOCR] Did not read to end of file! Report this!\n");
-        return "";
-    }
+private:
+    static thread_local LoadedHashList* active;
 
-    try
-    {
-        json meta = json::parse(metaJson);
-        j["hash"] = meta["hash_path"].is_null() ? meta.at("hash_value") : meta.at("hash_path");
+    std::shared_ptr<LoadedHashList> list;
+    LoadedHashList* previous;
+};
 
-        return j.dump();
+thread_local LoadedHashList* HashListScope::active = nullptr;
+} // namespace TonyTools::Language
+
+enum HashListSection : uint32_t
+{
+    Soundtags,
+    Switches,
+    Lines
+};
+
+// On-disk layout of a precompiled (v2) hash list, see the hash list format in the documentation.
+struct HashListIndexHeader
+{
+    uint32_t entriesOffset;
+    uint32_t nEntries;
+    uint32_t hashSeedsOffset;
+    uint32_t nHashSeeds;
+    uint32_t hashSlotsOffset;
+    uint32_t nHashSlots;
+    uint32_t stringSeedsOffset;
+    uint32_t nStringSeeds;
+    uint32_t stringSlotsOffset;
+    uint32_t nStringSlots;
+};
+
+struct HashListV2Header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t checksum;
+    uint32_t poolOffset;
+    uint32_t poolSize;
+    HashListIndexHeader sections[3];
+};
+
+static_assert(sizeof(HashListIndexHeader) == 40 && sizeof(HashListV2Header) == 140);
+static_assert(sizeof(HashIndexEntry) == 12);
+
+static const HashIndex EmptyHashIndex = {};
+
+// Reads the entries of a section, the strings are referenced in place rather than copied.
+bool readHashListSection(const char* data, size_t size, size_t &index, std::vector<HashIndexEntry> &entries)
+{
+    uint32_t count;
+    if (index + 4 > size)
+        return false;
+
+    std::memcpy(&count, data + index, 4);
+    index += 4;
+
+    entries.clear();
+    entries.reserve(std::min<size_t>(count, (size - index) / 5));
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t hash;
+        if (index + 4 > size)
+            return false;
+
+        std::memcpy(&hash, data + index, 4);
+        index += 4;
+
+        const char* start = data + index;
+        const char* end = (const char*)std::memchr(start, '\0', size - index);
+        if (!end)
+            return false;
+
+        entries.push_back({ hash, (uint32_t)index, (uint32_t)(end - start) });
+        index += (end - start) + 1;
+    }
+
+    return true;
+}
+
+// Walks a section without reading its entries, for checking the layout of a hash list when it's loaded.
+bool skipHashListSection(const char* data, size_t size, size_t &index)
+{
+    uint32_t count;
+    if (index + 4 > size)
+        return false;
+
+    std::memcpy(&count, data + index, 4);
+    index += 4;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (index + 4 > size)
+            return false;
+
+        index += 4;
+
+        const char* end = (const char*)std::memchr(data + index, '\0', size - index);
+        if (!end)
+            return false;
+
+        index = (end - data) + 1;
+    }
+
+    return true;
+}
+
+// Checks that a table lies within the file and is aligned for its element type.
+bool hashListTableValid(const LoadedHashList &list, uint32_t offset, uint32_t count, size_t elementSize)
+{
+    return offset % 4 == 0 && offset <= list.size && count <= (list.size - offset) / elementSize;
+}
+
+bool viewHashListSection(const LoadedHashList &list, HashListSection section, HashIndex &index)
+{
+    HashListV2Header header;
+    std::memcpy(&header, list.data, sizeof(header));
+
+    const HashListIndexHeader &tables = header.sections[section];
+    if (header.poolOffset > list.size || header.poolSize > list.size - header.poolOffset)
+        return false;
+
+    if (!hashListTableValid(list, tables.entriesOffset, tables.nEntries, sizeof(HashIndexEntry)) ||
+        !hashListTableValid(list, tables.hashSeedsOffset, tables.nHashSeeds, 4) ||
+        !hashListTableValid(list, tables.hashSlotsOffset, tables.nHashSlots, 4) ||
+        !hashListTableValid(list, tables.stringSeedsOffset, tables.nStringSeeds, 4) ||
+        !hashListTableValid(list, tables.stringSlotsOffset, tables.nStringSlots, 4))
+        return false;
+
+    auto table = [&list](uint32_t offset) { return (const uint32_t*)(list.data + offset); };
+
+    return index.view(list.data + header.poolOffset, header.poolSize, {
+        (const HashIndexEntry*)(list.data + tables.entriesOffset), tables.nEntries,
+        table(tables.hashSeedsOffset), tables.nHashSeeds,
+        table(tables.hashSlotsOffset), tables.nHashSlots,
+        table(tables.stringSeedsOffset), tables.nStringSeeds,
+        table(tables.stringSlotsOffset), tables.nStringSlots
+    });
+}
+
+bool verifyHashList(LoadedHashList &list)
+{
+    if (list.checksumPending) {
+        std::call_once(list.checksumFlag, [&list] {
+            uint32_t checksum;
+            std::memcpy(&checksum, list.data + 8, 4);
+
+            CRC32 crc32;
+            if (checksum != crc32(list.data + 12, list.size - 12)) {
+                fprintf(stderr, "[LANG//HashList] Checksum mismatch, the hash list will not be used!\n");
+                list.valid = false;
+            }
+        });
+    }
+
+    return list.valid;
+}
+
+// The list has already been checked (and its checksum validated) by the HashListScope that made it current.
+const HashIndex &hashListSection(LoadedHashList* list, HashListSection section)
+{
+    if (!list)
+        return EmptyHashIndex;
+
+    // Precompiled sections were viewed when loading.
+    LoadedHashList::Section &current = list->sections[section];
+    if (list->precompiled)
+        return current.index;
+
+    std::call_once(current.flag, [list, &current] {
+        size_t index = current.start;
+        std::vector<HashIndexEntry> entries;
+
+        // The layout was checked when loading, so this only fails if no perfect hash could be found. The section
+        // is left empty rather than the list being dropped, as other sections may already be in use.
+        if (!readHashListSection(list->data, list->size, index, entries) || !current.index.build(list->data, std::move(entries)))
+            fprintf(stderr, "[LANG//HashList] Failed to index a section of the hash list, its hashes will not be resolved!\n");
+    });
+
+    return current.index;
+}
+
+// The sections of the hash list of the current HashListScope, empty outside of one.
+const HashIndex &tagMap() { return hashListSection(HashListScope::current(), Soundtags); }
+const HashIndex &switchMap() { return hashListSection(HashListScope::current(), Switches); }
+const HashIndex &lineMap() { return hashListSection(HashListScope::current(), Lines); }
+
+HashListContext::HashListContext() : state(std::make_unique<State>()) {}
+HashListContext::~HashListContext() = default;
+
+HashListContext &HashListContext::Default() {
+    static HashListContext context;
+    return context;
+}
+
+HashList::Status HashListContext::GetStatus() const {
+    std::shared_ptr<LoadedHashList> list = HashListScope::snapshot(*this);
+    if (!list || !verifyHashList(*list))
+        return { false, (uint32_t)-1 };
+
+    return { true, list->version };
+}
+
+void HashListContext::Clear() {
+    HashListScope::install(*this, nullptr);
+}
+
+// Checks the layout of every section, so a list that loads can't be found to be malformed later. Plain (v1)
+// sections are only walked, they're indexed on first use. Precompiled (v2) ones are viewed, which builds nothing.
+bool checkHashListSections(LoadedHashList &list) {
+    if (list.precompiled) {
+        for (uint32_t section = Soundtags; section <= Lines; section++) {
+            if (!viewHashListSection(list, (HashListSection)section, list.sections[section].index))
+                return false;
+        }
+
+        return true;
+    }
+
+    size_t index = 12;
+    for (LoadedHashList::Section &section : list.sections) {
+        section.start = index;
+        if (!skipHashListSection(list.data, list.size, index))
+            return false;
+    }
+
+    return index == list.size;
+}
+
+// Checks the header and sections of a hash list, the checksum is either checked now or on first use.
+bool checkHashList(LoadedHashList &list, bool deferChecksum) {
+    if (list.size < 12)
+        return false;
+
+    uint32_t header[3];
+    std::memcpy(header, list.data, sizeof(header));
+
+    // Magic, either a plain (v1) or precompiled (v2) hash list
+    if (header[0] == '2LMH')
+        list.precompiled = true;
+    else if (header[0] != 'ALMH')
+        return false;
+
+    if (list.precompiled && list.size < sizeof(HashListV2Header))
+        return false;
+
+    list.version = header[1];
+    list.checksumPending = true;
+
+    if (!checkHashListSections(list)) {
+        fprintf(stderr, "[LANG//HashList] The hash list is malformed, it will not be used!\n");
+        return false;
+    }
+
+    return deferChecksum || verifyHashList(list);
+}
+
+// Swaps a checked hash list in, one that isn't valid is never installed and the current list is kept. The
+// checksum is only deferred for a first load, a reload checks it before replacing a list that may be working.
+bool installHashList(HashListContext &context, std::shared_ptr<LoadedHashList> list, bool deferChecksum) {
+    if (!checkHashList(*list, deferChecksum && !HashListScope::snapshot(context)))
+        return false;
+
+    HashListScope::install(context, std::move(list));
+    return true;
+}
+
+bool HashListContext::Load(std::vector<char> data) {
+    auto list = std::make_shared<LoadedHashList>();
+
+    // The file itself becomes the string pool.
+    list->owned = std::move(data);
+    list->data = list->owned.data();
+    list->size = list->owned.size();
+
+    return installHashList(*this, std::move(list), false);
+}
+
+bool HashListContext::Load(const char* ptr, uint32_t size) {
+    return Load(std::vector<char>(ptr, ptr + size));
+}
+
+bool HashListContext::LoadFile(const std::string &path) {
+    auto list = std::make_shared<LoadedHashList>();
+    if (!list->mapped.open(path))
+        return false;
+
+    list->data = list->mapped.data();
+    list->size = list->mapped.size();
+
+    return installHashList(*this, std::move(list), true);
+}
+
+void HashListContext::Share(const HashListContext &other) {
+    HashListScope::install(*this, HashListScope::snapshot(other));
+}
+
+std::string HashListContext::GetLineHash(std::string_view value) const {
+    HashListScope scope(*this);
+
+    std::optional<uint32_t> hash = lineMap().key(value);
+    return hash ? std::string(hex8(*hash)) : std::string(value);
+}
+
+std::string HashListContext::GetLine(uint32_t hash) const {
+    HashListScope scope(*this);
+    return std::string(resolveHash(lineMap(), hash).view());
+}
+
+// These have always left no hash list loaded when they fail, unlike a context which keeps its current one.
+bool HashList::Load(std::vector<char> data) {
+    HashListContext &context = HashListContext::Default();
+    if (context.Load(std::move(data)))
+        return true;
+
+    context.Clear();
+    return false;
+}
+
+bool HashList::Load(const char* ptr, uint32_t size) {
+    return Load(std::vector<char>(ptr, ptr + size));
+}
+
+bool HashList::LoadFile(const std::string &path) {
+    return HashListContext::Default().LoadFile(path);
+}
+
+void HashList::Clear() {
+    HashListContext::Default().Clear();
+}
+
+HashList::Status HashList::GetStatus() {
+    return HashListContext::Default().GetStatus();
+}
+
+std::string HashList::GetLineHash(std::string_view value) {
+    return HashListContext::Default().GetLineHash(value);
+}
+
+std::string HashList::GetLine(uint32_t hash) {
+    return HashListContext::Default().GetLine(hash);
+}
+
+std::vector<char> HashList::Compile(std::span<const char> data) {
+    if (data.size() < 12)
+        return {};
+
+    uint32_t header[3];
+    std::memcpy(header, data.data(), sizeof(header));
+
+    if (header[0] != 'ALMH')
+        return {};
+
+    CRC32 crc32;
+    if (header[2] != crc32(data.data() + 12, data.size() - 12))
+        return {};
+
+    // Strings are moved into one pool (without the hashes between them), each section indexes into it.
+    std::vector<char> pool;
+    HashIndex indices[3];
+    size_t index = 12;
+
+    for (HashIndex &sectionIndex : indices) {
+        std::vector<HashIndexEntry> entries;
+        if (!readHashListSection(data.data(), data.size(), index, entries))
+            return {};
+
+        for (HashIndexEntry &entry : entries) {
+            const char* str = data.data() + entry.offset;
+            entry.offset = (uint32_t)pool.size();
+            pool.insert(pool.end(), str, str + entry.length + 1);
+        }
+
+        if (!sectionIndex.build(pool.data(), std::move(entries)))
+            return {};
+    }
+
+    if (index != data.size())
+        return {};
+
+    HashListV2Header v2 = {};
+    v2.magic = '2LMH';
+    v2.version = header[1];
+
+    std::vector<char> out(sizeof(HashListV2Header));
+    auto writeTable = [&out](const void* table, size_t size) {
+        uint32_t offset = (uint32_t)out.size();
+        out.insert(out.end(), (const char*)table, (const char*)table + size);
+
+        return offset;
+    };
+
+    for (uint32_t i = 0; i < 3; i++) {
+        HashIndex::Tables tables = indices[i].tables();
+        HashListIndexHeader &section = v2.sections[i];
+
+        section.nEntries = tables.entryCount;
+        section.entriesOffset = writeTable(tables.entries, tables.entryCount * sizeof(HashIndexEntry));
+        section.nHashSeeds = tables.hashSeedCount;
+        section.hashSeedsOffset = writeTable(tables.hashSeeds, tables.hashSeedCount * 4);
+        section.nHashSlots = tables.hashSlotCount;
+        section.hashSlotsOffset = writeTable(tables.hashSlots, tables.hashSlotCount * 4);
+        section.nStringSeeds = tables.stringSeedCount;
+        section.stringSeedsOffset = writeTable(tables.stringSeeds, tables.stringSeedCount * 4);
+        section.nStringSlots = tables.stringSlotCount;
+        section.stringSlotsOffset = writeTable(tables.stringSlots, tables.stringSlotCount * 4);
+    }
+
+    v2.poolSize = (uint32_t)pool.size();
+    v2.poolOffset = writeTable(pool.data(), pool.size());
+
+    std::memcpy(out.data(), &v2, sizeof(v2));
+
+    uint32_t checksum = crc32(out.data() + 12, out.size() - 12);
+    std::memcpy(out.data() + 8, &checksum, 4);
+
+    return out;
+}
+
+// The entries of every section of a checked hash list, the strings are referenced in place.
+bool readHashListEntries(LoadedHashList &list, std::vector<std::pair<uint32_t, std::string_view>> (&sections)[3]) {
+    if (!list.precompiled) {
+        size_t index = 12;
+        for (auto &section : sections) {
+            std::vector<HashIndexEntry> entries;
+            if (!readHashListSection(list.data, list.size, index, entries))
+                return false;
+
+            for (const HashIndexEntry &entry : entries)
+                section.push_back({ entry.hash, std::string_view(list.data + entry.offset, entry.length) });
+        }
+
+        return index == list.size;
+    }
+
+    HashListV2Header header;
+    std::memcpy(&header, list.data, sizeof(header));
+
+    for (uint32_t i = 0; i < 3; i++) {
+        HashIndex index;
+        if (!viewHashListSection(list, (HashListSection)i, index))
+            return false;
+
+        HashIndex::Tables tables = index.tables();
+        for (uint32_t k = 0; k < tables.entryCount; k++) {
+            const HashIndexEntry &entry = tables.entries[k];
+            if (entry.offset > header.poolSize || entry.length > header.poolSize - entry.offset)
+                return false;
+
+            sections[i].push_back({ entry.hash, std::string_view(list.data + header.poolOffset + entry.offset, entry.length) });
+        }
+    }
+
+    return true;
+}
+
+std::vector<char> HashList::Extend(std::span<const char> data, const Entries &entries) {
+    LoadedHashList list;
+    list.data = data.data();
+    list.size = data.size();
+
+    std::vector<std::pair<uint32_t, std::string_view>> sections[3];
+    if (!data.empty() && (!checkHashList(list, false) || !readHashListEntries(list, sections)))
+        return {};
+
+    const std::vector<Entry>* additions[3] = { &entries.soundtags, &entries.switches, &entries.lines };
+
+    std::vector<char> out;
+    auto writeU32 = [&out](uint32_t value) {
+        out.insert(out.end(), (const char*)&value, (const char*)&value + 4);
+    };
+
+    writeU32('ALMH');
+    writeU32(list.version + 1);
+    writeU32(0);
+
+    for (uint32_t i = 0; i < 3; i++) {
+        std::unordered_set<uint32_t> hashes;
+        for (const auto &[hash, value] : sections[i])
+            hashes.insert(hash);
+
+        for (const Entry &entry : *additions[i]) {
+            if (hashes.insert(entry.hash).second)
+                sections[i].push_back({ entry.hash, entry.value });
+        }
+
+        writeU32((uint32_t)sections[i].size());
+        for (const auto &[hash, value] : sections[i]) {
+            writeU32(hash);
+            out.insert(out.end(), value.begin(), value.end());
+            out.push_back('\0');
+        }
+    }
+
+    CRC32 crc32;
+    uint32_t checksum = crc32(out.data() + 12, out.size() - 12);
+    std::memcpy(out.data() + 8, &checksum, 4);
+
+    return list.precompiled ? Compile(out) : out;
+}
+#pragma endregion
+
+#pragma region RTLV
+// The contents of a RTLV, SLocalizedVideoDataDecrypted in ResourceLib.
+struct RTLV_Data
+{
+    std::vector<std::string> audioLanguages;
+    std::vector<uint64_t> videos; // The ResourceID of each audio language's video.
+    std::vector<std::string> subtitleLanguages;
+    std::vector<std::string> subtitles;
+
+    bool operator==(const RTLV_Data &) const = default;
+};
+
+/*
+ * RTLVs are a BIN1 resource: a 16-byte header (with the size of the data big endian at 8), the data, then its segments.
+ * Pointers in the data are 64-bit and relative to the start of it, the relocation segment lists where they are.
+ * The data starts with four TArrays of begin, end and allocation end pointers, one for each member of RTLV_Data in order.
+ * The elements of an array are preceded by their count, and a ZString is its length (the top two bits are flags),
+ * padding, and a pointer to its characters.
+ */
+constexpr uint32_t RTLV_Magic = '1NIB';
+constexpr uint32_t RTLV_RelocationSegment = 0x12EBA5ED;
+constexpr uint64_t RTLV_NullPointer = UINT64_MAX;
+constexpr size_t RTLV_ArraySize = 24;
+constexpr size_t RTLV_StringSize = 16;
+
+uint32_t byteSwap32(uint32_t value)
+{
+    return (value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24);
+}
+
+// Reads a RTLV without ResourceLib, only following the pointers so it doesn't depend on how the data was laid out.
+// Gives false for anything it doesn't understand, which is left to ResourceLib (and its errors).
+bool readRTLV(RTLV_Data &rtlv, std::span<const char> data)
+{
+    try
+    {
+        Reader file(data);
+        if (file.read<uint32_t>() != RTLV_Magic)
+            return false;
+
+        file.skip(4);
+        uint32_t dataSize = byteSwap32(file.read<uint32_t>());
+        file.skip(4);
+
+        Reader buff = file.sub(file.index, dataSize);
+
+        // Gives where the elements of the array at offset start, and how many of them there are.
+        auto array = [&](size_t offset, size_t elementSize) -> std::pair<size_t, size_t> {
+            uint64_t begin = buff.readAt<uint64_t>(offset);
+            uint64_t end = buff.readAt<uint64_t>(offset + 8);
+            if (begin == end)
+                return {0, 0};
+
+            if (end < begin || end > buff.size() || (end - begin) % elementSize)
+                throw std::out_of_range("RTLV: invalid array");
+
+            return {begin, (end - begin) / elementSize};
+        };
+
+        auto strings = [&](size_t offset, std::vector<std::string> &values) {
+            auto [begin, count] = array(offset, RTLV_StringSize);
+
+            values.resize(count);
+            for (size_t i = 0; i < count; i++)
+            {
+                size_t element = begin + i * RTLV_StringSize;
+                uint32_t length = buff.readAt<uint32_t>(element) & 0x3FFFFFFF;
+
+                if (length == 0)
+                    values[i].clear();
+                else
+                {
+                    Reader chars = buff.sub(buff.readAt<uint64_t>(element + 8), length);
+                    values[i].assign(chars.data(), length);
+                }
+            }
+        };
+
+        strings(0, rtlv.audioLanguages);
+
+        auto [begin, count] = array(RTLV_ArraySize, 8);
+        rtlv.videos.resize(count);
+        for (size_t i = 0; i < count; i++)
+            rtlv.videos[i] = ((uint64_t)buff.readAt<uint32_t>(begin + i * 8) << 32) | buff.readAt<uint32_t>(begin + i * 8 + 4);
+
+        strings(RTLV_ArraySize * 2, rtlv.subtitleLanguages);
+        strings(RTLV_ArraySize * 3, rtlv.subtitles);
+
+        return rtlv.audioLanguages.size() == rtlv.videos.size() && rtlv.subtitleLanguages.size() == rtlv.subtitles.size();
+    }
+    catch (const std::out_of_range &)
+    {
+        return false;
+    }
+}
+
+// Writes a RTLV without ResourceLib, laid out the same as ResourceLib does (the root, then every array followed by its strings).
+void writeRTLV(std::vector<char> &out, const RTLV_Data &rtlv)
+{
+    out.clear();
+    Writer buff(out);
+
+    buff.write<uint32_t>(RTLV_Magic);
+    buff.write<uint8_t>(0);
+    buff.write<uint8_t>(8); // Alignment
+    buff.write<uint8_t>(1); // Segments
+    buff.write<uint8_t>(0);
+    size_t sizeOffset = buff.pad(4);
+    buff.write<uint32_t>(0);
+
+    const size_t base = buff.size();
+    std::vector<uint32_t> relocations;
+
+    auto pointer = [&](size_t field, uint64_t target) {
+        buff.writeAt<uint64_t>(base + field, target);
+        relocations.push_back((uint32_t)field);
+    };
+
+    // Pads so that a prefix of the given size ends aligned.
+    auto align = [&](size_t alignment, size_t prefix) {
+        size_t misaligned = (buff.size() - base + prefix) % alignment;
+        if (misaligned)
+            buff.pad(alignment - misaligned);
+    };
+
+    auto array = [&](size_t field, size_t count, size_t elementSize) -> size_t {
+        if (count == 0)
+        {
+            for (size_t i = 0; i < 3; i++)
+                buff.writeAt<uint64_t>(base + field + i * 8, RTLV_NullPointer);
+
+            return 0;
+        }
+
+        align(8, 4);
+        buff.write<uint32_t>((uint32_t)count);
+
+        size_t begin = buff.pad(count * elementSize) - base;
+        pointer(field, begin);
+        pointer(field + 8, begin + count * elementSize);
+        pointer(field + 16, begin + count * elementSize);
+
+        return begin;
+    };
+
+    auto strings = [&](size_t field, const std::vector<std::string> &values) {
+        size_t begin = array(field, values.size(), RTLV_StringSize);
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            size_t element = begin + i * RTLV_StringSize;
+            buff.writeAt<uint32_t>(base + element, (uint32_t)values[i].size() | 0x40000000);
+
+            if (values[i].empty())
+            {
+                buff.writeAt<uint64_t>(base + element + 8, RTLV_NullPointer);
+                continue;
+            }
+
+            align(4, 4);
+            buff.write<uint32_t>((uint32_t)values[i].size());
+            pointer(element + 8, buff.size() - base);
+            buff.writeString(values[i]);
+        }
+    };
+
+    buff.pad(RTLV_ArraySize * 4);
+
+    strings(0, rtlv.audioLanguages);
+
+    size_t begin = array(RTLV_ArraySize, rtlv.videos.size(), 8);
+    for (size_t i = 0; i < rtlv.videos.size(); i++)
+    {
+        buff.writeAt<uint32_t>(base + begin + i * 8, (uint32_t)(rtlv.videos[i] >> 32));
+        buff.writeAt<uint32_t>(base + begin + i * 8 + 4, (uint32_t)rtlv.videos[i]);
+    }
+
+    strings(RTLV_ArraySize * 2, rtlv.subtitleLanguages);
+    strings(RTLV_ArraySize * 3, rtlv.subtitles);
+
+    align(8, 0);
+    buff.writeAt<uint32_t>(sizeOffset, byteSwap32((uint32_t)(buff.size() - base)));
+
+    std::sort(relocations.begin(), relocations.end());
+    buff.write<uint32_t>(RTLV_RelocationSegment);
+    buff.write<uint32_t>((uint32_t)(4 + relocations.size() * 4));
+    buff.writeVector(relocations);
+}
+
+// Reads a RTLV through ResourceLib's JSON. Errors are reported here, JSON errors are left to the caller.
+bool readRTLVResourceLib(RTLV_Data &rtlv, Version version, std::span<const char> data)
+{
+    ResourceConverter *converter = getConverter(version, "RTLV");
+    if (!converter)
+    {
+        fprintf(stderr, "[LANG//RTLV] Could not get converter!\n");
+        return false;
+    }
+
+    JsonString *converted = converter->FromMemoryToJsonString(data.data(), data.size());
+    if (!converted)
+    {
+        fprintf(stderr, "[LANG//RTLV] Could not convert RTLV to ResourceLib JSON!\n");
+        return false;
+    }
+
+    json jConv;
+    try
+    {
+        jConv = json::parse(converted->JsonData);
+    }
+    catch (const json::exception &)
+    {
+        converter->FreeJsonString(converted);
+        throw;
+    }
+    converter->FreeJsonString(converted);
+
+    if (jConv.at("AudioLanguages").size() != jConv.at("VideoRidsPerAudioLanguage").size())
+    {
+        fprintf(stderr, "[LANG//RTLV] Mismatch in languages and resource IDs in RL JSON!\n");
+        return false;
+    }
+
+    rtlv = {};
+    for (const auto &[lang, id] : c9::zip(jConv.at("AudioLanguages"), jConv.at("VideoRidsPerAudioLanguage")))
+    {
+        rtlv.audioLanguages.push_back(lang.get<std::string>());
+        rtlv.videos.push_back(((uint64_t)id.at("m_IDHigh").get<uint32_t>() << 32) | id.at("m_IDLow").get<uint32_t>());
+    }
+
+    if (jConv.at("SubtitleLanguages").size() != jConv.at("SubtitleMarkupsPerLanguage").size())
+    {
+        fprintf(stderr, "[LANG//RTLV] Mismatch in subtitle languages and content in RL JSON!\n");
+        return false;
+    }
+
+    for (const auto &[lang, text] : c9::zip(jConv.at("SubtitleLanguages"), jConv.at("SubtitleMarkupsPerLanguage")))
+    {
+        rtlv.subtitleLanguages.push_back(lang.get<std::string>());
+        rtlv.subtitles.push_back(text.get<std::string>());
+    }
+
+    return true;
+}
+
+// Writes a RTLV through ResourceLib from the JSON it reads.
+bool writeRTLVResourceLib(std::vector<char> &out, Version version, const json &rlJson)
+{
+    ResourceGenerator *generator = getGenerator(version, "RTLV");
+    if (!generator)
+    {
+        fprintf(stderr, "[LANG//RTLV] Could not get generator!\n");
+        return false;
+    }
+
+    std::string rlString = rlJson.dump();
+    ResourceMem *generated = generator->FromJsonStringToResourceMem(rlString.c_str(), rlString.size(), false);
+    if (!generated)
+    {
+        fprintf(stderr, "[LANG//RTLV] Could not convert ResourceLib JSON to RTLV!\n");
+        return false;
+    }
+
+    out.assign((const char*)generated->ResourceData, (const char*)generated->ResourceData + generated->DataSize);
+    generator->FreeResourceMem(generated);
+
+    return true;
+}
+
+/*
+ * ResourceLib stays the reference for RTLVs. The first file of each shape (its array counts, and how many of its strings
+ * are empty, as those are null pointers) is read (or written) both ways for each version, and the native codec is only
+ * used for that shape from then on if it gave the same result. Otherwise ResourceLib is used for everything, so a
+ * layout the native codec gets wrong can never make it into a file.
+ */
+enum class RTLV_Codec : uint8_t
+{
+    Unchecked,
+    Native,
+    ResourceLib
+};
+
+struct RTLV_Shape
+{
+    size_t languages;
+    size_t subtitles;
+    size_t emptyStrings;
+
+    auto operator<=>(const RTLV_Shape &) const = default;
+};
+
+RTLV_Shape rtlvShape(const RTLV_Data &rtlv)
+{
+    auto empty = [](const std::vector<std::string> &values) {
+        return (size_t)std::count_if(values.begin(), values.end(), [](const std::string &value) { return value.empty(); });
+    };
+
+    return {rtlv.audioLanguages.size(), rtlv.subtitleLanguages.size(),
+            empty(rtlv.audioLanguages) + empty(rtlv.subtitleLanguages) + empty(rtlv.subtitles)};
+}
+
+// The shapes the native codec has matched ResourceLib on, for a version and direction.
+struct RTLV_Checks
+{
+    std::mutex mutex;
+    bool mismatched = false;
+    std::set<RTLV_Shape> matched;
+};
+
+RTLV_Checks &rtlvChecks(Version version, bool rebuild)
+{
+    static RTLV_Checks checks[3][2];
+    return checks[std::clamp((int)version - (int)Version::H2016, 0, 2)][rebuild];
+}
+
+RTLV_Codec rtlvCodec(Version version, bool rebuild, const RTLV_Data &rtlv)
+{
+    RTLV_Checks &checks = rtlvChecks(version, rebuild);
+    std::lock_guard lock(checks.mutex);
+
+    if (checks.mismatched)
+        return RTLV_Codec::ResourceLib;
+
+    return checks.matched.contains(rtlvShape(rtlv)) ? RTLV_Codec::Native : RTLV_Codec::Unchecked;
+}
+
+void setRTLVCodec(Version version, bool rebuild, const RTLV_Data &rtlv, bool matches)
+{
+    RTLV_Checks &checks = rtlvChecks(version, rebuild);
+    std::lock_guard lock(checks.mutex);
+
+    if (matches)
+    {
+        checks.matched.insert(rtlvShape(rtlv));
+        return;
+    }
+
+    if (!checks.mismatched)
+        fprintf(stderr, "[LANG//RTLV] The native RTLV %s does not match ResourceLib, ResourceLib will be used instead.\n",
+                rebuild ? "writer" : "reader");
+
+    checks.mismatched = true;
+}
+
+bool RTLV::ConvertInto(std::string &output, Version version, std::span<const char> data, std::string_view metaJson)
+{
+    size_t outputSize = output.size();
+
+    json j = {
+        {"$schema", "https://tonytools.win/schemas/rtlv.schema.json"},
+        {"hash", ""},
+        {"videos", json::object()},
+        {"subtitles", json::object()}
+    };
+
+    try
+    {
+        PhaseTimer timer(Stats::Phase::BuildTree);
+
+        // The shape is only known once the file has been read, so it's always read natively first.
+        RTLV_Data rtlv;
+        RTLV_Codec codec = readRTLV(rtlv, data) ? rtlvCodec(version, false, rtlv) : RTLV_Codec::ResourceLib;
+
+        if (codec == RTLV_Codec::Unchecked)
+        {
+            RTLV_Data reference;
+            if (!readRTLVResourceLib(reference, version, data))
+                return false;
+
+            setRTLVCodec(version, false, rtlv, rtlv == reference);
+            rtlv = std::move(reference);
+        }
+        else if (codec != RTLV_Codec::Native)
+        {
+            if (!readRTLVResourceLib(rtlv, version, data))
+                return false;
+        }
+
+        for (size_t i = 0; i < rtlv.audioLanguages.size(); i++)
+            j.at("videos").push_back({rtlv.audioLanguages[i], std::string(hex16(rtlv.videos[i]))});
+
+        for (size_t i = 0; i < rtlv.subtitleLanguages.size(); i++)
+            j.at("subtitles").push_back({rtlv.subtitleLanguages[i], rtlv.subtitles[i]});
+
+        countStat(&Stats::strings, rtlv.subtitles.size());
+
+        timer.next(Stats::Phase::ParseMeta);
+        json meta = json::parse(metaJson);
+        j.at("hash") = meta["hash_path"].is_null() ? meta.at("hash_value") : meta.at("hash_path");
+
+        timer.next(Stats::Phase::Dump);
+        JsonWriter(output).value(j);
+
+        return true;
+    }
+    catch (const json::exception& err)
+    {
+        output.resize(outputSize);
+        fprintf(stderr, "[LANG//RTLV] JSON error:\n"
+                        "\t%s\n", err.what());
+    }
+
+    return false;
+}
+
+std::string RTLV::Convert(Version version, std::span<const char> data, std::string_view metaJson)
+{
+    std::string output;
+    ConvertInto(output, version, data, metaJson);
+    return output;
+}
+
+bool RTLV::RebuildInto(Rebuilt &out, Version version, std::string_view jsonString, const LanguageMap &langMap)
+{
+    out.clear();
+
+    tsl::ordered_map<std::string, std::string> depends{};
+
+    std::unordered_map<std::string, uint32_t> languages;
+    const std::vector<std::string> &langs = resolveLanguages(langMap, defaultLanguages(version));
+    for (int i = 0; i < langs.size(); i++)
+        languages[langs.at(i)] = i;
+
+    try
+    {
+        PhaseTimer timer(Stats::Phase::ParseJson);
+        json jSrc = json::parse(jsonString);
+        timer.next(Stats::Phase::BuildTree);
+
+        if (jSrc.at("videos").size() < 1)
+        {
+            fprintf(stderr, "[LANG//RTLV] Videos object is empty!\n");
+            return false;
+        }
+
+        // The langmap property overrides any argument passed languages maps.
+        // This property ensures easy compat with tools like SMF.
+        if (jSrc.contains("langmap"))
+        {
+            languages.clear();
+
+            LanguageMap property;
+            const std::vector<std::string> &langs = propertyLanguages(property, jSrc.at("langmap").get<std::string>());
+            for (int i = 0; i < langs.size(); i++)
+                languages[langs.at(i)] = i;
+        }
+
+        RTLV_Data rtlv;
+        for (const auto &[lang, video] : jSrc.at("videos").items())
+        {
+            if (!languages.contains(lang))
+            {
+                fprintf(stderr, "[LANG//RTLV] Language map does not contain language \"%s\".\n", lang.c_str());
+                return false;
+            }
+
+            std::string vidHash = video.get<std::string>();
+            if (!isResourceID(vidHash))
+                vidHash = computeHash(vidHash);
+
+            rtlv.audioLanguages.push_back(lang);
+            rtlv.videos.push_back(parseResourceID(vidHash));
+
+            depends[vidHash] = std::format("{:2X}", 0x80 + languages[lang]);
+        }
+
+        // Subtitles that aren't strings are left for ResourceLib to reject, the same as it always has.
+        bool native = true;
+        for (const auto &[lang, text] : jSrc.at("subtitles").items())
+        {
+            rtlv.subtitleLanguages.push_back(lang);
+            rtlv.subtitles.push_back(text.is_string() ? text.get<std::string>() : "");
+            native &= text.is_string();
+        }
+
+        auto resourceLibJson = [&] {
+            json j = {
+                {"AudioLanguages", json::array()},
+                {"VideoRidsPerAudioLanguage", json::array()},
+                {"SubtitleLanguages", json::array()},
+                {"SubtitleMarkupsPerLanguage", json::array()}
+            };
+
+            for (size_t i = 0; i < rtlv.audioLanguages.size(); i++)
+            {
+                j.at("AudioLanguages").push_back(rtlv.audioLanguages[i]);
+                j.at("VideoRidsPerAudioLanguage").push_back(json::object({{"m_IDHigh", rtlv.videos[i] >> 32}, {"m_IDLow", rtlv.videos[i] & ULONG_MAX}}));
+            }
+
+            for (const auto &[lang, text] : jSrc.at("subtitles").items())
+            {
+                j.at("SubtitleLanguages").push_back(lang);
+                j.at("SubtitleMarkupsPerLanguage").push_back(text);
+            }
+
+            return j;
+        };
+
+        countStat(&Stats::strings, rtlv.subtitles.size());
+
+        timer.next(Stats::Phase::Encode);
+        RTLV_Codec codec = native ? rtlvCodec(version, true, rtlv) : RTLV_Codec::ResourceLib;
+        if (codec == RTLV_Codec::Native)
+            writeRTLV(out.file, rtlv);
+        else
+        {
+            if (!writeRTLVResourceLib(out.file, version, resourceLibJson()))
+                return false;
+
+            if (codec == RTLV_Codec::Unchecked)
+            {
+                std::vector<char> file;
+                writeRTLV(file, rtlv);
+                setRTLVCodec(version, true, rtlv, file == out.file);
+            }
+        }
+
+        out.meta = generateMeta(jSrc.at("hash"), out.file.size(), "RTLV", depends);
+
+        return true;
+    }
+    catch (const json::exception& err)
+    {
+        out.clear();
+        fprintf(stderr, "[LANG//RTLV] JSON error:\n"
+                        "\t%s\n", err.what());
+    }
+
+    return false;
+}
+
+Rebuilt RTLV::Rebuild(Version version, std::string_view jsonString, const LanguageMap &langMap)
+{
+    Rebuilt out{};
+    RebuildInto(out, version, jsonString, langMap);
+    return out;
+}
+#pragma endregion
+
+#pragma region LOCR
+// Where a string is in the decrypted copy of the file.
+struct LOCR_String
+{
+    uint32_t hash;
+    size_t offset;
+    uint32_t size;
+};
+
+// The string tables of a LOCR, read in place from a decrypted copy of the file.
+// Decode copies the strings out of it, Convert writes them straight to the JSON.
+struct LOCR_Tables
+{
+    LanguageMap langMap; // Keeps the languages alive.
+    const std::vector<std::string>* languages = nullptr; // The langmap, can have more languages than the file.
+    std::vector<std::vector<LOCR_String>> strings;
+    std::vector<char> plain;
+    bool symmetric = false;
+
+    std::string_view text(const LOCR_String &string) const
+    {
+        // Symmetric strings aren't padded, so unlike XTEA the whole span is the string.
+        return symmetric
+            ? std::string_view(plain.data() + string.offset, string.size)
+            : xteaPlaintext(plain.data() + string.offset, string.size);
+    }
+};
+
+template <Version V>
+bool readLOCR(LOCR_Tables &tables, std::span<const char> data, const LanguageMap &langMap, bool symmetric)
+{
+    PhaseTimer timer(Stats::Phase::BuildTree);
+
+    Reader buff(data);
+
+    constexpr bool isLOCRv2 = Game<V>::locrV2;
+    if (buff.size() < isLOCRv2 + 4)
+    {
+        fprintf(stderr, "[LANG//LOCR] File is too small!\n");
+        return false;
+    }
+
+    if (isLOCRv2)
+        buff.skip(1);
+
+    uint32_t numLanguages = (buff.read<uint32_t>() - isLOCRv2) / 4;
+    buff.index -= 4;
+    tables.langMap = langMap;
+    tables.languages = &resolveLanguages(tables.langMap, Game<V>::languageList());
+
+    if (numLanguages > tables.languages->size())
+    {
+        fprintf(stderr, "[LANG//LOCR] Language map is smaller than the number of languages in the file!\n");
+        return false;
+    }
+
+    // Strings are collected first so every string in the file can be decrypted in one go.
+    tables.strings.assign(numLanguages, {});
+    tables.symmetric = symmetric && Game<V>::symmetricLOCR;
+    XteaBatch batch;
+    std::vector<std::pair<size_t, uint32_t>> symmetricSpans;
+    size_t stringCount = 0;
+
+    // The only copy of the data, the strings are decrypted in it.
+    tables.plain.assign(data.begin(), data.end());
+
+    try
+    {
+        size_t oldIndex = buff.index;
+        for (int i = 0; i < numLanguages; i++)
+        {
+            uint32_t oldOffset = buff.index;
+            uint32_t offset;
+            buff.index = oldIndex;
+            if ((offset = buff.read<uint32_t>()) == ULONG_MAX)
+            {
+                buff.index = oldOffset;
+                oldIndex += 4;
+                continue;
+            }
+            buff.index = offset;
+            oldIndex += 4;
+
+            // Every string takes at least 9 bytes, which keeps a bad count from reserving more than the file could hold.
+            uint32_t numStrings = buff.read<uint32_t>();
+            tables.strings.at(i).reserve(std::min<size_t>(numStrings, (buff.size() - buff.index) / 9));
+            for (int k = 0; k < numStrings; k++)
+            {
+                uint32_t hashNum = buff.read<uint32_t>();
+                uint32_t size = buff.read<uint32_t>();
+
+                if (buff.index + size + 1 > buff.size())
+                {
+                    fprintf(stderr, "[LANG//LOCR] String exceeds the end of the file! Report this!\n");
+                    return false;
+                }
+
+                tables.strings.at(i).push_back({hashNum, buff.index, size});
+                if (Game<V>::symmetricLOCR && tables.symmetric)
+                    symmetricSpans.emplace_back(buff.index, size);
+                else
+                    batch.add(buff.index, size);
+
+                stringCount++;
+
+                buff.index += size + 1;
+            }
+        }
+    }
+    catch (const std::out_of_range& err)
+    {
+        fprintf(stderr, "[LANG//LOCR] Invalid file:\n"
+                        "\t%s\n", err.what());
+        return false;
+    }
+
+    {
+        PhaseTimer decryptTimer(Stats::Phase::Decrypt);
+
+        size_t decrypted = batch.blocks() * 8;
+        batch.decrypt(tables.plain.data());
+        for (const auto &[offset, size] : symmetricSpans)
+        {
+            symmetricDecryptInPlace(tables.plain.data() + offset, size);
+            decrypted += size;
+        }
+
+        countStat(&Stats::bytesDecrypted, decrypted);
+    }
+
+    countStat(&Stats::strings, stringCount);
+
+    if (buff.index != buff.size())
+    {
+        fprintf(stderr, "[LANG//LOCR] Did not read to end of file! Report this!\n");
+        return false;
+    }
+
+    return true;
+}
+
+bool LOCR::Decode(Document &document, Version version, std::span<const char> data, const LanguageMap &langMap, bool symmetric)
+{
+    PhaseTimer timer(Stats::Phase::BuildTree);
+
+    LOCR_Tables tables;
+    if (!dispatch(version, [&]<Version V>(Game<V>) { return readLOCR<V>(tables, data, langMap, symmetric); }))
+        return false;
+
+    document.symmetric = tables.symmetric;
+    document.tables.clear();
+    document.tables.reserve(tables.strings.size());
+
+    for (size_t i = 0; i < tables.strings.size(); i++)
+    {
+        Table &table = document.tables.emplace_back();
+        table.language = tables.languages->at(i);
+        table.lines.reserve(tables.strings.at(i).size());
+
+        for (const LOCR_String &string : tables.strings.at(i))
+            table.lines.push_back({string.hash, std::string(tables.text(string))});
+    }
+
+    return true;
+}
+
+bool LOCR::ConvertInto(std::string &output, Version version, std::span<const char> data, std::string_view metaJson, const LanguageMap &langMap, bool symmetric, const HashListContext &hashList)
+{
+    HashListScope scope(hashList);
+
+    LOCR_Tables tables;
+    if (!dispatch(version, [&]<Version V>(Game<V>) { return readLOCR<V>(tables, data, langMap, symmetric); }))
+        return false;
+
+    const std::vector<std::string> &languages = *tables.languages;
+    size_t numLanguages = tables.strings.size();
+    size_t outputSize = output.size();
+
+    try
+    {
+        PhaseTimer timer(Stats::Phase::ParseMeta);
+        json meta = json::parse(metaJson);
+        timer.next(Stats::Phase::Dump);
+
+        // Written straight out rather than through a DOM, the output is the same as dump() would give.
+        output.reserve(output.size() + data.size() * 2 + 256);
+
+        JsonWriter writer(output);
+        writer.beginObject();
+        writer.key("$schema");
+        writer.value("https://tonytools.win/schemas/locr.schema.json");
+        writer.key("hash");
+        writer.value(meta["hash_path"].is_null() ? meta.at("hash_value") : meta.at("hash_path"));
+
+        if (tables.symmetric)
+        {
+            writer.key("symmetric");
+            writer.value(true);
+        }
+
+        writer.key("languages");
+        writer.beginObject();
+
+        const HashIndex &lines = lineMap();
+        std::vector<bool> written(numLanguages, false);
+        KeySet keys;
+        std::vector<HexChars<8>> hexKeys; // Keys point into this, it's reserved for every string so it never reallocates
+
+        for (int i = 0; i < numLanguages; i++)
+        {
+            if (written.at(i))
+                continue;
+
+            writer.key(languages.at(i));
+            writer.beginObject();
+
+            // A language repeated in the langmap shares the object of its first occurrence,
+            // and a repeated string hash keeps its first string.
+            size_t count = 0;
+            for (int k = i; k < numLanguages; k++)
+            {
+                if (!written.at(k) && languages.at(k) == languages.at(i))
+                    count += tables.strings.at(k).size();
+            }
+
+            keys.reset(count);
+            hexKeys.clear();
+            hexKeys.reserve(count);
+            for (int k = i; k < numLanguages; k++)
+            {
+                if (written.at(k) || languages.at(k) != languages.at(i))
+                    continue;
+
+                written.at(k) = true;
+
+                for (const LOCR_String &string : tables.strings.at(k))
+                {
+                    std::string_view hash;
+                    std::optional<std::string_view> line = lines.value(string.hash);
+                    countStat(line ? &Stats::hashHits : &Stats::hashMisses);
+
+                    if (line)
+                        hash = *line;
+                    else
+                        hash = hexKeys.emplace_back(hex8(string.hash));
+
+                    if (!keys.insert(hash))
+                        continue;
+
+                    writer.key(hash);
+                    writer.value(tables.text(string));
+                }
+            }
+
+            writer.endObject();
+        }
+
+        writer.endObject();
+        writer.endObject();
+
+        return true;
     }
     catch (const json::exception& err)
     {
+        output.resize(outputSize);
         fprintf(stderr, "[LANG//LOCR] JSON error:\n"
                         "\t%s%s\n", err.what(),
                         version == Version::H2016
                         ? "\nIf this is an older H2016 LOCR file, this may be due to a symmetric cipher being used." : "");
     }
 
-    return "";
+    return false;
 }
 
-Rebuilt LOCR::Rebuild(Version version, std::string jsonString, bool symmetric)
+std::string LOCR::Convert(Version version, std::span<const char> data, std::string_view metaJson, const LanguageMap &langMap, bool symmetric, const HashListContext &hashList)
 {
-    Rebuilt out{};
+    std::string output;
+    ConvertInto(output, version, data, metaJson, langMap, symmetric, hashList);
+    return output;
+}
 
-    try
+// Writes a LOCR one language at a time. The body is written straight into the file, and the offset table
+// is put in front of it once every language has been written. Used by Encode and both JSON rebuilds.
+class LOCR_Writer
+{
+public:
+    // Can be turned on (for H2016) until the first string has been written.
+    bool symmetric;
+
+    LOCR_Writer(std::vector<char> &file, Version version, bool symmetric)
+        : symmetric(symmetric && version == Version::H2016), file(file), body(file), version(version) {}
+
+    void beginLanguage()
     {
-        json jSrc = json::parse(jsonString);
+        countOffset = body.size();
+        stringCount = 0;
+        body.write<uint32_t>(0);
+    }
 
-        buffer buff;
+    void writeString(uint32_t hash, std::string_view str)
+    {
+        body.write<uint32_t>(hash);
 
-        if (!jSrc["symmetric"].is_null() && jSrc["symmetric"].get<bool>() && version == Version::H2016)
-            symmetric = true;
+        if (symmetric)
+        {
+            body.write<uint32_t>(str.size());
+            symmetricSpans.emplace_back(body.size(), str.size());
+            body.writeRaw(str.data(), str.size());
+        }
+        else
+            writeXteaString(body, str, batch);
 
-        if (version != Version::H2016)
-            buff.write<char>('\0');
+        body.write<char>('\0');
+        stringCount++;
+    }
 
-        uint32_t curOffset = buff.index;
-        buff.insert(jSrc.at("languages").size() * 4);
+    void endLanguage()
+    {
+        countStat(&Stats::strings, stringCount);
 
-        for (const auto &[lang, strings] : jSrc.at("languages").items())
+        if (!stringCount)
+        {
+            file.resize(countOffset);
+            offsets.push_back(SIZE_MAX);
+            return;
+        }
+
+        body.writeAt<uint32_t>(countOffset, stringCount);
+        offsets.push_back(countOffset);
+    }
+
+    void finish()
+    {
         {
-            if (!strings.size())
+            PhaseTimer timer(Stats::Phase::Encrypt);
+
+            size_t encrypted = batch.blocks() * 8;
+            batch.encrypt(body.data());
+            for (const auto &[offset, size] : symmetricSpans)
             {
-                uint32_t temp = buff.index;
-                buff.index = curOffset;
-                buff.write<uint32_t>(ULONG_MAX);
-                curOffset += 4;
-                buff.index = temp;
-                continue;
+                symmetricEncryptInPlace(body.data() + offset, size);
+                encrypted += size;
             }
 
-            uint32_t temp = buff.index;
-            buff.index = curOffset;
-            buff.write<uint32_t>(temp);
-            curOffset += 4;
-            buff.index = temp;
+            countStat(&Stats::bytesEncrypted, encrypted);
+        }
+
+        // The body was written straight into the file, the header goes in front of it.
+        std::vector<char> header;
+        Writer headerWriter(header);
+        size_t headerSize = (version != Version::H2016 ? 1 : 0) + offsets.size() * 4;
+        headerWriter.reserve(headerSize);
+
+        if (version != Version::H2016)
+            headerWriter.write<char>('\0');
+
+        for (size_t offset : offsets)
+            headerWriter.write<uint32_t>(offset == SIZE_MAX ? ULONG_MAX : headerSize + offset);
+
+        file.insert(file.begin(), header.begin(), header.end());
+    }
+
+private:
+    std::vector<char> &file;
+    Writer body;
+    Version version;
+
+    // Offsets of each language in the body, SIZE_MAX for an empty language.
+    std::vector<size_t> offsets;
+    size_t countOffset = 0;
+    uint32_t stringCount = 0;
+
+    // Strings are written as plaintext and encrypted all at once after the whole body has been written.
+    XteaBatch batch;
+    std::vector<std::pair<size_t, size_t>> symmetricSpans;
+};
+
+bool LOCR::Encode(std::vector<char> &output, Version version, const Document &document)
+{
+    PhaseTimer timer(Stats::Phase::Encode);
+
+    output.clear();
+
+    LOCR_Writer writer(output, version, document.symmetric);
+    for (const Table &table : document.tables)
+    {
+        writer.beginLanguage();
+        for (const Line &line : table.lines)
+            writer.writeString(line.hash, line.text);
+        writer.endLanguage();
+    }
+
+    writer.finish();
+    return true;
+}
+
+// Writes each language's strings as they are parsed, the offset table is filled in once all languages have been seen.
+class LOCR_StreamingRebuild : public StreamingRebuild
+{
+public:
+    LOCR_StreamingRebuild(Rebuilt &out, Version version, bool symmetric)
+        : out(out), writer(out.file, version, symmetric), version(version) {}
+
+    bool finish()
+    {
+        if (!hash || !hasLanguages)
+            return false;
+
+        writer.finish();
+        out.meta = generateMeta(*hash, out.file.size(), "LOCR", {});
+
+        return true;
+    }
+
+protected:
+    bool onKey(std::string &key) override
+    {
+        switch (depth)
+        {
+        case 1:
+            field = Field::Other;
+            if (key == "hash" && !hash)
+                field = Field::Hash;
+            else if (key == "symmetric" && !hasSymmetric)
+                field = Field::Symmetric;
+            else if (key == "languages" && !hasLanguages)
+                field = Field::Languages;
+            else if (key == "hash" || key == "symmetric" || key == "languages")
+                return false;
+            else
+                skipValue();
+
+            hasSymmetric |= field == Field::Symmetric;
+            return true;
+        case 2:
+            return languages.insert(key).second;
+        case 3:
+            // Repeated keys would be merged by the DOM, leave those to it.
+            stringHash = lookupHash(lineMap(), key);
+            return stringHashes.insert(stringHash).second;
+        }
+
+        return false;
+    }
+
+    bool onValue(Scalar type) override
+    {
+        if (depth == 3 && type == Scalar::String)
+        {
+            writer.writeString(stringHash, *stringValue);
+            return true;
+        }
+
+        if (depth != 1)
+            return false;
+
+        if (field == Field::Hash && type == Scalar::String)
+        {
+            hash = std::move(*stringValue);
+            return true;
+        }
+
+        if (field == Field::Symmetric && type == Scalar::Null)
+            return true;
+
+        if (field == Field::Symmetric && type == Scalar::Boolean)
+        {
+            if (!booleanValue || version != Version::H2016 || writer.symmetric)
+                return true;
+
+            // Strings have already been written without it.
+            if (hasLanguages)
+                return false;
+
+            writer.symmetric = true;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool onStart(bool object) override
+    {
+        if (!object)
+            return false;
+
+        switch (depth)
+        {
+        case 1:
+            return true;
+        case 2:
+            hasLanguages = field == Field::Languages;
+            return hasLanguages;
+        case 3:
+            stringHashes.clear();
+            writer.beginLanguage();
+            return true;
+        }
+
+        return false;
+    }
+
+    bool onEnd() override
+    {
+        if (depth == 3)
+            writer.endLanguage();
+
+        return true;
+    }
+
+private:
+    enum class Field
+    {
+        Other,
+        Hash,
+        Symmetric,
+        Languages
+    };
+
+    Rebuilt &out;
+    LOCR_Writer writer;
+    Version version;
+
+    Field field = Field::Other;
+    std::optional<std::string> hash;
+    bool hasSymmetric = false;
+    bool hasLanguages = false;
+
+    std::unordered_set<std::string> languages;
+    std::unordered_set<uint32_t> stringHashes;
+    uint32_t stringHash = 0;
+};
+
+// Builds the LOCR from a parsed document, used for anything the streaming rebuild leaves to it.
+bool rebuildLOCRDocument(Rebuilt &out, Version version, std::string_view jsonString, bool symmetric)
+{
+    try
+    {
+        PhaseTimer timer(Stats::Phase::ParseJson);
+        json jSrc = json::parse(jsonString);
+        timer.next(Stats::Phase::BuildTree);
+
+        LOCR::Document document;
+        if (!jSrc["symmetric"].is_null() && jSrc["symmetric"].get<bool>())
+            symmetric = true;
+
+        document.symmetric = symmetric;
+
+        for (const auto &[lang, strings] : jSrc.at("languages").items())
+        {
+            LOCR::Table &table = document.tables.emplace_back();
+            table.language = lang;
 
-            buff.write<uint32_t>(strings.size());
             for (const auto &[strHash, string] : strings.items())
-            {
-                buff.write<uint32_t>(LineMap.has_value(strHash) ? LineMap.get_key(strHash) : hexStringToNum(strHash));
-                buff.write<std::vector<char>>((symmetric && version == Version::H2016)
-                                                ? symmetricEncrypt(string.get<std::string>())
-                                                : xteaEncrypt(string.get<std::string>())
-                                            );
-                buff.write<char>('\0');
-            }
+                table.lines.push_back({lookupHash(lineMap(), strHash), jsonStringRef(string)});
         }
 
-        out.file = buff.data();
+        LOCR::Encode(out.file, version, document);
         out.meta = generateMeta(jSrc.at("hash"), out.file.size(), "LOCR", {});
 
-        return out;
+        return true;
     }
     catch (const json::exception& err)
     {
@@ -662,66 +2299,237 @@ Rebuilt LOCR::Rebuild(Version version, std::string jsonString, bool symmetric)
                         "\t%s\n", err.what());
     }
 
-    return {};
+    out.clear();
+    return false;
+}
+
+bool LOCR::RebuildInto(Rebuilt &out, Version version, std::string_view jsonString, bool symmetric, const HashListContext &hashList)
+{
+    HashListScope scope(hashList);
+    PhaseTimer timer(Stats::Phase::ParseJson);
+
+    out.clear();
+
+    LOCR_StreamingRebuild rebuild(out, version, symmetric);
+    if (json::sax_parse(jsonString, &rebuild) && rebuild.finish())
+        return true;
+
+    out.clear();
+    return rebuildLOCRDocument(out, version, jsonString, symmetric);
+}
+
+Rebuilt LOCR::Rebuild(Version version, std::string_view jsonString, bool symmetric, const HashListContext &hashList)
+{
+    Rebuilt out{};
+    RebuildInto(out, version, jsonString, symmetric, hashList);
+    return out;
 }
 #pragma endregion
 
 #pragma region DITL
-std::string DITL::Convert(std::vector<char> data, std::string metaJson)
+bool DITL::ConvertInto(std::string &output, std::span<const char> data, std::string_view metaJson, const HashListContext &hashList)
 {
-    buffer buff(data);
+    HashListScope scope(hashList);
 
-    json j = {
-        {"$schema", "https://tonytools.win/schemas/ditl.schema.json"},
-        {"hash", ""},
-        {"soundtags", json::object()}
-    };
+    Reader buff(data);
+    size_t outputSize = output.size();
 
     try
     {
+        PhaseTimer timer(Stats::Phase::ParseMeta);
         json meta = json::parse(metaJson);
-        j["hash"] = meta["hash_path"].is_null() ? meta.at("hash_value") : meta.at("hash_path");
+        timer.next(Stats::Phase::Dump);
+
+        output.reserve(output.size() + data.size() * 16 + 256);
+
+        JsonWriter writer(output);
+        writer.beginObject();
+        writer.key("$schema");
+        writer.value("https://tonytools.win/schemas/ditl.schema.json");
+        writer.key("hash");
+        writer.value(meta["hash_path"].is_null() ? meta.at("hash_value") : meta.at("hash_path"));
+        writer.key("soundtags");
+        writer.beginObject();
 
+        // Only the first of any repeated soundtag is kept. Every soundtag takes 8 bytes, which bounds the count.
         uint32_t count = buff.read<uint32_t>();
+        size_t maxCount = std::min<size_t>(count, (buff.size() - buff.index) / 8);
+
+        KeySet soundtags;
+        soundtags.reset(maxCount);
+        std::vector<HexChars<8>> hexTags; // Soundtags point into this, it's reserved for every soundtag so it never reallocates
+        hexTags.reserve(maxCount);
+
         for (uint32_t i = 0; i < count; i++)
         {
-            std::string depend = meta.at("hash_reference_data").at(buff.read<uint32_t>()).at("hash");
-            uint32_t soundtagHash = buff.read<uint32_t>();
+            const std::string &depend = jsonStringRef(meta.at("hash_reference_data").at(buff.read<uint32_t>()).at("hash"));
+            ResolvedHash resolved = resolveHash(tagMap(), buff.read<uint32_t>());
+
+            std::string_view soundtag = resolved.value ? *resolved.value : hexTags.emplace_back(resolved.hex).view();
+            if (!soundtags.insert(soundtag))
+                continue;
 
-            j.at("soundtags").push_back({
-                TagMap.has_key(soundtagHash) ? TagMap.get_value(soundtagHash) : std::format("{:08X}", soundtagHash),
-                depend
-            });
+            writer.key(soundtag);
+            writer.value(depend);
         }
 
+        writer.endObject();
+        writer.endObject();
+
         // Sanity check
         if (buff.index != buff.size())
         {
+            output.resize(outputSize);
             fprintf(stderr, "[LANG//DITL] Did not read to the end of the file! Report this!\n");
-            return "";
+            return false;
         }
 
-        return j.dump();
+        return true;
     }
     catch (const json::exception& err)
     {
+        output.resize(outputSize);
         fprintf(stderr, "[LANG//DITL] JSON error:\n"
                         "\t%s\n", err.what());
     }
+    catch (const std::out_of_range& err)
+    {
+        output.resize(outputSize);
+        fprintf(stderr, "[LANG//DITL] Invalid file:\n"
+                        "\t%s\n", err.what());
+    }
 
-    return "";
+    return false;
 }
 
-Rebuilt DITL::Rebuild(std::string jsonString)
+std::string DITL::Convert(std::span<const char> data, std::string_view metaJson, const HashListContext &hashList)
+{
+    std::string output;
+    ConvertInto(output, data, metaJson, hashList);
+    return output;
+}
+
+// Writes each soundtag as it is parsed, depends are numbered in the order they are first seen.
+class DITL_StreamingRebuild : public StreamingRebuild
+{
+public:
+    explicit DITL_StreamingRebuild(Rebuilt &out) : out(out), body(out.file) { body.write<uint32_t>(0); }
+
+    bool finish()
+    {
+        if (!hash || !hasSoundtags)
+            return false;
+
+        body.writeAt<uint32_t>(0, soundtagCount);
+        out.meta = generateMeta(*hash, body.size(), "DITL", depends);
+
+        return true;
+    }
+
+protected:
+    bool onKey(std::string &key) override
+    {
+        switch (depth)
+        {
+        case 1:
+            field = Field::Other;
+            if (key == "hash" && !hash)
+                field = Field::Hash;
+            else if (key == "soundtags" && !hasSoundtags)
+                field = Field::Soundtags;
+            else if (key == "hash" || key == "soundtags")
+                return false;
+            else
+                skipValue();
+
+            return true;
+        case 2:
+            // Repeated keys would be merged by the DOM, leave those to it.
+            tagHash = lookupHash(tagMap(), key);
+            return tagHashes.insert(tagHash).second;
+        }
+
+        return false;
+    }
+
+    bool onValue(Scalar type) override
+    {
+        if (type != Scalar::String)
+            return false;
+
+        if (depth == 1 && field == Field::Hash)
+        {
+            hash = std::move(*stringValue);
+            return true;
+        }
+
+        if (depth != 2)
+            return false;
+
+        auto it = depends.find(*stringValue);
+        if (it != depends.end())
+            body.write<uint32_t>(it - depends.begin());
+        else
+        {
+            body.write<uint32_t>(depends.size());
+            depends[std::move(*stringValue)] = "1F";
+        }
+
+        body.write<uint32_t>(tagHash);
+        soundtagCount++;
+
+        return true;
+    }
+
+    bool onStart(bool object) override
+    {
+        if (!object)
+            return false;
+
+        if (depth == 1)
+            return true;
+
+        hasSoundtags = depth == 2 && field == Field::Soundtags;
+        return hasSoundtags;
+    }
+
+    bool onEnd() override { return true; }
+
+private:
+    enum class Field
+    {
+        Other,
+        Hash,
+        Soundtags
+    };
+
+    Rebuilt &out;
+    Writer body;
+
+    Field field = Field::Other;
+    std::optional<std::string> hash;
+    bool hasSoundtags = false;
+
+    std::unordered_set<uint32_t> tagHashes;
+    tsl::ordered_map<std::string, std::string> depends{};
+
+    uint32_t soundtagCount = 0;
+    uint32_t tagHash = 0;
+};
+
+// Builds the DITL from a parsed document, used for anything the streaming rebuild leaves to it.
+bool rebuildDITLDocument(Rebuilt &out, std::string_view jsonString)
 {
-    Rebuilt out{};
     tsl::ordered_map<std::string, std::string> depends{};
 
     try
     {
+        PhaseTimer timer(Stats::Phase::ParseJson);
         json jSrc = json::parse(jsonString);
+        timer.next(Stats::Phase::Encode);
 
-        buffer buff;
+        // Written straight into the output's memory.
+        Writer buff(out.file);
 
         buff.write<uint32_t>(jSrc.at("soundtags").size());
 
@@ -735,13 +2543,12 @@ Rebuilt DITL::Rebuild(std::string jsonString)
                 depends[hash] = "1F";
             }
 
-            buff.write<uint32_t>(TagMap.has_value(tagName) ? TagMap.get_key(tagName) : hexStringToNum(tagName));
+            buff.write<uint32_t>(lookupHash(tagMap(), tagName));
         }
 
-        out.file = buff.data();
         out.meta = generateMeta(jSrc.at("hash"), out.file.size(), "DITL", depends);
 
-        return out;
+        return true;
     }
     catch (const json::exception& err)
     {
@@ -749,82 +2556,137 @@ Rebuilt DITL::Rebuild(std::string jsonString)
                         "\t%s\n", err.what());
     }
 
-    return {};
+    out.clear();
+    return false;
+}
+
+bool DITL::RebuildInto(Rebuilt &out, std::string_view jsonString, const HashListContext &hashList)
+{
+    HashListScope scope(hashList);
+    PhaseTimer timer(Stats::Phase::ParseJson);
+
+    out.clear();
+
+    DITL_StreamingRebuild rebuild(out);
+    if (json::sax_parse(jsonString, &rebuild) && rebuild.finish())
+        return true;
+
+    out.clear();
+    return rebuildDITLDocument(out, jsonString);
+}
+
+Rebuilt DITL::Rebuild(std::string_view jsonString, const HashListContext &hashList)
+{
+    Rebuilt out{};
+    RebuildInto(out, jsonString, hashList);
+    return out;
 }
 #pragma endregion
 
 #pragma region CLNG
-std::string CLNG::Convert(Version version, std::vector<char> data, std::string metaJson, std::string langMap)
+bool CLNG::ConvertInto(std::string &output, Version version, std::span<const char> data, std::string_view metaJson, const LanguageMap &langMap)
 {
-    buffer buff(data);
-
-    json j = {
-        {"$schema", "https://tonytools.win/schemas/clng.schema.json"},
-        {"hash", ""},
-        {"languages", json::object()}
-    };
+    PhaseTimer timer(Stats::Phase::BuildTree);
 
-    std::vector<std::string> languages = {"xx", "en", "fr", "it", "de", "es", "ru", "mx", "br", "pl", "cn", "jp", "tc"};
+    Reader buff(data);
 
-    if (!langMap.empty())
-        languages = split(langMap);
-    else if (version == Version::H3)
-        languages = {"xx", "en", "fr", "it", "de", "es", "ru", "cn", "tc", "jp"};
+    const std::vector<std::string> &languages = resolveLanguages(langMap, defaultLanguages(version));
 
+    std::vector<std::pair<std::string_view, bool>> values;
     uint32_t i = 0;
     while (buff.index != buff.size())
     {
         if (i >= languages.size())
         {
             fprintf(stderr, "[LANG//CLNG] Language map is smaller than the number of languages in the file!\n");
-            return "";
+            return false;
         }
 
-        j.at("languages").push_back({languages.at(i++), buff.read<bool>()});
+        const std::string &language = languages.at(i++);
+        bool value = buff.read<bool>();
+
+        // Only the first of any repeated language is kept.
+        if (std::find_if(values.begin(), values.end(), [&](const auto &entry) { return entry.first == language; }) == values.end())
+            values.emplace_back(language, value);
     }
 
+    size_t outputSize = output.size();
+
     try
     {
+        timer.next(Stats::Phase::ParseMeta);
         json meta = json::parse(metaJson);
-        j["hash"] = meta["hash_path"].is_null() ? meta.at("hash_value") : meta.at("hash_path");
+        timer.next(Stats::Phase::Dump);
+
+        JsonWriter writer(output);
+        writer.beginObject();
+        writer.key("$schema");
+        writer.value("https://tonytools.win/schemas/clng.schema.json");
+        writer.key("hash");
+        writer.value(meta["hash_path"].is_null() ? meta.at("hash_value") : meta.at("hash_path"));
+        writer.key("languages");
+        writer.beginObject();
+
+        for (const auto &[language, value] : values)
+        {
+            writer.key(language);
+            writer.value(value);
+        }
+
+        writer.endObject();
+        writer.endObject();
 
-        return j.dump();
+        return true;
     }
     catch (const json::exception& err)
     {
+        output.resize(outputSize);
         fprintf(stderr, "[LANG//CLNG] JSON error:\n"
                         "\t%s\n", err.what());
     }
 
-    return "";
+    return false;
 }
 
-Rebuilt CLNG::Rebuild(std::string jsonString)
+std::string CLNG::Convert(Version version, std::span<const char> data, std::string_view metaJson, const LanguageMap &langMap)
 {
-    Rebuilt out{};
+    std::string output;
+    ConvertInto(output, version, data, metaJson, langMap);
+    return output;
+}
+
+bool CLNG::RebuildInto(Rebuilt &out, std::string_view jsonString)
+{
+    out.clear();
 
     try
     {
+        PhaseTimer timer(Stats::Phase::ParseJson);
         json jSrc = json::parse(jsonString);
-
-        buffer buff;
+        timer.next(Stats::Phase::Encode);
 
         for (const auto &[language, value] : jSrc.at("languages").items())
-            buff.write<bool>(value.get<bool>());
+            out.file.push_back(value.get<bool>());
 
-        out.file = buff.data();
         out.meta = generateMeta(jSrc.at("hash").get<std::string>(), out.file.size(), "CLNG", {});
 
-        return out;
+        return true;
     }
     catch (const json::exception& err)
     {
         fprintf(stderr, "[LANG//CLNG] JSON error:\n"
                         "\t%s\n", err.what());
     }
-    
-    return {};
-    
+
+    out.clear();
+    return false;
+}
+
+Rebuilt CLNG::Rebuild(std::string_view jsonString)
+{
+    Rebuilt out{};
+    RebuildInto(out, jsonString);
+    return out;
 }
 #pragma endregion
 
@@ -832,8 +2694,8 @@ Rebuilt CLNG::Rebuild(std::string jsonString)
 struct DLGE_Metadata
 {
     uint16_t typeIndex; // >> 12 for type -- & 0xFFF for index
-    // This is actually a u32 count, then X amount of u32s but our buffer
-    // stream reader, when reading a vector, reads a u32 of size first.
+    // This is actually a u32 count, then X amount of u32s, which is what
+    // readVector/writeVector do by default.
     std::vector<uint32_t> SwitchHashes;
 };
 
@@ -846,13 +2708,32 @@ enum class DLGE_Type : uint8_t
     eDEIT_Invalid = 0x15
 };
 
-NLOHMANN_JSON_SERIALIZE_ENUM(DLGE_Type, {
+// What NLOHMANN_JSON_SERIALIZE_ENUM would give, but its table is a function static of json values, which would be
+// allocated from the arena of whichever call used it first (and outlive it).
+constexpr std::pair<DLGE_Type, std::string_view> DLGE_TypeNames[] = {
     {DLGE_Type::eDEIT_Invalid, "Invalid"},
     {DLGE_Type::eDEIT_WavFile, "WavFile"},
     {DLGE_Type::eDEIT_RandomContainer, "Random"},
     {DLGE_Type::eDEIT_SwitchContainer, "Switch"},
     {DLGE_Type::eDEIT_SequenceContainer, "Sequence"}
-});
+};
+
+// Anything that isn't one of the names is Invalid.
+void from_json(const json &j, DLGE_Type &type)
+{
+    type = DLGE_Type::eDEIT_Invalid;
+    if (!j.is_string())
+        return;
+
+    for (const auto &[value, name] : DLGE_TypeNames)
+    {
+        if (j.get_ref<const std::string&>() == name)
+        {
+            type = value;
+            return;
+        }
+    }
+}
 
 class DLGE_Container
 {
@@ -862,7 +2743,7 @@ public:
     uint32_t DefaultSwitchHash;
     std::vector<DLGE_Metadata> metadata;
 
-    DLGE_Container(buffer &buff) 
+    DLGE_Container(Reader &buff)
     {
         type = buff.read<uint8_t>();
         SwitchGroupHash = buff.read<uint32_t>();
@@ -874,96 +2755,139 @@ public:
         {
             data = {
                 buff.read<uint16_t>(),
-                buff.read<std::vector<uint32_t>>()
+                buff.readVector<uint32_t>()
             };
 
             metadata.push_back(data);
         }
     };
+};
 
-    DLGE_Container(uint8_t pType, uint32_t sgh, uint32_t dsh)
-    {
-        type = pType;
-        SwitchGroupHash = sgh;
-        DefaultSwitchHash = dsh;
-        metadata = {};
-    };
+void encryptSubtitles(XteaBatch &batch, char* data)
+{
+    PhaseTimer timer(Stats::Phase::Encrypt);
 
-    void addMetadata(uint16_t typeIndex, std::vector<uint32_t> entries)
-    {
-        metadata.push_back({
-            typeIndex,
-            entries
-        });
+    batch.encrypt(data);
+    countStat(&Stats::bytesEncrypted, batch.blocks() * 8);
+}
+
+// Walks the DLGE sections without building anything, collecting every subtitle so they can be decrypted
+// in place with one batch before the file is actually converted.
+template <Version V>
+bool decryptSubtitles(std::vector<char> &data, size_t languageCount)
+{
+    PhaseTimer timer(Stats::Phase::Decrypt);
+
+    XteaBatch batch;
+    size_t index = 8; // Skip the DITL and CLNG depend indices.
+    size_t subtitles = 0;
+
+    auto readU32 = [&](uint32_t &value) {
+        if (index + 4 > data.size())
+            return false;
+
+        std::memcpy(&value, data.data() + index, 4);
+        index += 4;
+        return true;
     };
 
-    void write(buffer &buff)
+    while (index + 2 < data.size())
     {
-        buff.write<uint8_t>(type);
-        buff.write<uint32_t>(SwitchGroupHash);
-        buff.write<uint32_t>(DefaultSwitchHash);
-        
-        buff.write<uint32_t>(metadata.size());
-        for (const DLGE_Metadata &metadata : metadata)
+        uint8_t type = data.at(index++);
+
+        if (type == 0x01)
+        {
+            // Soundtag hash, wav name hash, and the unknown value (once for non-H2016).
+            index += Game<V>::dlgeValuePerLanguage ? 8 : 12;
+
+            for (size_t i = 0; i < languageCount; i++)
+            {
+                // The per-language H2016 value, wav and ffx depend indices.
+                index += Game<V>::dlgeValuePerLanguage ? 12 : 8;
+
+                uint32_t size;
+                if (!readU32(size) || index + size > data.size())
+                    return false;
+
+                batch.add(index, size);
+                index += size;
+                subtitles += size != 0;
+            }
+        }
+        else if (type >= 0x02 && type <= 0x04)
         {
-            buff.write<uint16_t>(metadata.typeIndex);
-            buff.write<std::vector<uint32_t>>(metadata.SwitchHashes);
+            uint32_t count;
+            index += 8; // Switch group and default switch hashes.
+            if (!readU32(count))
+                return false;
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                uint32_t hashCount;
+                index += 2; // typeIndex
+                if (!readU32(hashCount))
+                    return false;
+
+                index += hashCount * 4;
+            }
         }
-    };
-};
+        else
+            // Let the converter report the bad section.
+            break;
+    }
+
+    if (index > data.size())
+        return false;
+
+    batch.decrypt(data.data());
+
+    countStat(&Stats::bytesDecrypted, batch.blocks() * 8);
+    countStat(&Stats::strings, subtitles);
+
+    return true;
+}
 
-std::string DLGE::Convert(Version version, std::vector<char> data, std::string metaJson, std::string defaultLocale, bool hexPrecision, std::string langMap)
+template <Version V>
+bool decodeDLGE(DLGE::Document &document, std::span<const char> data, const LanguageMap &langMap)
 {
-    buffer buff(data);
+    using namespace DLGE;
 
-    json j = {
-        {"$schema", "https://tonytools.win/schemas/dlge.schema.json"},
-        {"hash", ""},
-        {"DITL", ""},
-        {"CLNG", ""}
-    };
+    const std::vector<std::string> &languages = resolveLanguages(langMap, Game<V>::dlgeLanguageList());
+
+    // The only copy of the data, the subtitles are decrypted in it.
+    std::vector<char> plain(data.begin(), data.end());
 
-    // These are H2 languages by default.
-    std::vector<std::string> languages = {"xx", "en", "fr", "it", "de", "es", "ru", "mx", "br", "pl", "cn", "jp", "tc"};
-    if (!langMap.empty())
+    if (!decryptSubtitles<V>(plain, languages.size()))
     {
-        languages = split(langMap);
-        j.push_back({"langmap", langMap});
+        fprintf(stderr, "[LANG//DLGE] Failed to read subtitles!\n");
+        fprintf(stderr, "This could be due to your language maps not matching up to the number of languages in the file (older file?).\n");
+        return false;
     }
-    else if (version == Version::H2016)
-        // Late versions of H2016 share the same langmap as H2, but without tc, so we remove it.
-        languages.pop_back();
-    else if (version == Version::H3)
-        languages = {"xx", "en", "fr", "it", "de", "es", "ru", "cn", "tc", "jp"};
 
-    j.push_back({"rootContainer", nullptr});
+    Reader buff(plain);
 
     try
     {
-        json meta = json::parse(metaJson);
-        j["hash"] = meta["hash_path"].is_null() ? meta.at("hash_value") : meta.at("hash_path");
-        j["DITL"] = meta.at("hash_reference_data").at(buff.read<uint32_t>()).at("hash");
-        j["CLNG"] = meta.at("hash_reference_data").at(buff.read<uint32_t>()).at("hash");
-
-        // We setup these maps to store the various types of containers and the latest index for final construction later.
-        std::map<uint8_t, tsl::ordered_map<uint32_t, json>> containerMap = {
-            {1, {}},
-            {2, {}},
-            {3, {}},
-            {4, {}}
-        };
-        std::map<uint8_t, uint32_t> indexMap = {
-            {1, 0},
-            {2, 0},
-            {3, 0},
-            {4, 0}
+        uint32_t ditl = buff.read<uint32_t>();
+        uint32_t clng = buff.read<uint32_t>();
+
+        // Containers come after the containers they reference, which are referenced by their index among the
+        // containers of the same type. Each one is moved into its parent when it is referenced, emptying its slot.
+        std::array<std::vector<std::optional<Container>>, 5> containers;
+
+        auto take = [&](uint8_t type, uint32_t index) {
+            if (type < 0x01 || type > 0x04 || index >= containers.at(type).size() || !containers.at(type).at(index))
+                throw std::out_of_range("Bad container reference.");
+
+            Container container = std::move(*containers.at(type).at(index));
+            containers.at(type).at(index).reset();
+            return container;
         };
 
         // Weirdly, sequences reference by some "global id" for certain types so we store this here.
-        uint32_t globalIndex = -1;
-        std::unordered_map<uint32_t, uint32_t> globalMap = {};
-        
-        // Read everything but the root typedIndex as we read that above.
+        std::vector<uint32_t> globalMap;
+
+        // Read everything but the root typedIndex, the root is whichever container isn't referenced.
         while (buff.index != (buff.size() - 2))
         {
             switch (buff.peek<uint8_t>())
@@ -971,83 +2895,48 @@ std::string DLGE::Convert(Version version, std::vector<char> data, std::string m
             case 0x01: // eDEIT_WavFile
             {
                 buff.index += 1; // We don't need to record the type.
-                uint32_t soundTagHash = buff.read<uint32_t>();
-                uint32_t wavNameHash = buff.read<uint32_t>();
-
-                // H2016 has this at the start of every language in a wav file container, we check this later.
-                if (version != Version::H2016)
-                    buff.read<uint32_t>();
-
-                json wav = json::object({
-                    {"type", DLGE_Type::eDEIT_WavFile},
-                    {"wavName", std::format("{:08X}", wavNameHash)},
-                    {"cases", nullptr},
-                    {"weight", nullptr},
-                    {"soundtag", TagMap.has_key(soundTagHash) ? TagMap.get_value(soundTagHash) : std::format("{:08X}", soundTagHash)},
-                    {"defaultWav", nullptr},
-                    {"defaultFfx", nullptr},
-                    {"languages", json::object()}
-                });
-
-                for (std::string const &language : languages)
-                {
-                    if (version == Version::H2016)
-                        buff.read<uint32_t>();
 
-                    uint32_t wavIndex = buff.read<uint32_t>(); // WWES/WWEM depend index
-                    uint32_t ffxIndex = buff.read<uint32_t>(); // FaceFX depend index
+                Container wav;
+                wav.type = ContainerType::WavFile;
+                wav.soundtag = buff.read<uint32_t>();
+                wav.wavName = buff.read<uint32_t>();
 
-                    json subtitleJson = nullptr;
+                // H2016 has this at the start of every language in a wav file container instead.
+                if constexpr (!Game<V>::dlgeValuePerLanguage)
+                    buff.skip(4);
 
-                    if (wavIndex != ULONG_MAX && ffxIndex != ULONG_MAX)
-                    {
-                        if (language == defaultLocale)
-                        {
-                            wav.at("defaultWav") = meta.at("hash_reference_data").at(wavIndex).at("hash");
-                            wav.at("defaultFfx") = meta.at("hash_reference_data").at(ffxIndex).at("hash");
-
-                            // As we are most likely to have the english (default locale unless specified) hash, we get the wav hash from here.
-                            wav.at("wavName") = getWavName(wav.at("defaultWav"), wav.at("defaultFfx"), std::format("{:08X}", wavNameHash));
-                        }
-                        else
-                        {
-                            subtitleJson = json::object({
-                                {"wav", meta.at("hash_reference_data").at(wavIndex).at("hash")},
-                                {"ffx", meta.at("hash_reference_data").at(ffxIndex).at("hash")}
-                            });
-                        }
-                    }
+                wav.localizations.resize(languages.size());
+                for (Localization &localization : wav.localizations)
+                {
+                    if constexpr (Game<V>::dlgeValuePerLanguage)
+                        buff.skip(4);
 
-                    if (buff.peek<uint32_t>() != 0)
-                        if (subtitleJson.is_null())
-                            subtitleJson = xteaDecrypt(buff.read<std::vector<char>>());
-                        else
-                            subtitleJson.push_back({"subtitle", xteaDecrypt(buff.read<std::vector<char>>())});
-                    else
-                        // We do this as we only peeked the size.
-                        buff.index += 4;
+                    localization.wav = buff.read<uint32_t>(); // WWES/WWEM depend index
+                    localization.ffx = buff.read<uint32_t>(); // FaceFX depend index
 
-                    if (!subtitleJson.is_null())
-                        wav.at("languages").push_back({language, subtitleJson});
+                    // Subtitles have already been decrypted in place.
+                    uint32_t subtitleSize = buff.read<uint32_t>();
+                    if (subtitleSize != 0)
+                    {
+                        std::span<const char> subtitle = buff.bytes(subtitleSize);
+                        localization.subtitle = std::string(xteaPlaintext(subtitle.data(), subtitle.size()));
+                    }
                 }
 
-                containerMap.at(0x01)[indexMap.at(0x01)++] = wav;
+                containers.at(0x01).push_back(std::move(wav));
                 break;
             }
             case 0x02: // eDEIT_RandomContainer
             {
                 DLGE_Container container(buff);
 
-                json cjson = json::object({
-                    {"type", DLGE_Type::eDEIT_RandomContainer},
-                    {"cases", nullptr},
-                    {"containers", json::array()}
-                });
+                Container random;
+                random.type = ContainerType::Random;
 
                 for (const DLGE_Metadata &metadata : container.metadata)
                 {
                     // Random containers will ONLY EVER CONTAIN references to wav files.
-                    // They will also only ever contain one "SwitchHashes" entry with the weight. 
+                    // They will also only ever contain one "SwitchHashes" entry with the weight.
                     // This has been verified across all games. This also makes sense when considering
                     // the purpose of the different containers. It makes no sense for a switch group or sequence to be randomised.
 
@@ -1057,46 +2946,27 @@ std::string DLGE::Convert(Version version, std::vector<char> data, std::string m
                     // Referencing anything other than WavFiles in a random container is illogical.
                     if (type != 0x01) {
                         fprintf(stderr, "[LANG//DLGE] Bad random container reference [0x%02X].\n", type);
-                        return "";
+                        return false;
                     }
 
-                    // Remove the switch property as it will be unused.
-                    containerMap.at(type).at(index).erase("cases");
-
-                    // Cannot use ternary here due to conflicting types.
-                    if (hexPrecision) 
-                        containerMap.at(type).at(index).at("weight") = std::format("{:06X}", metadata.SwitchHashes[0]);
-                    else
-                        containerMap.at(type).at(index).at("weight") = (double)metadata.SwitchHashes[0] / (double)0xFFFFFF;
-
-                    cjson.at("containers").push_back(containerMap.at(type).at(index));
-                    containerMap.at(type).erase(index);
+                    Container &child = random.containers.emplace_back(take(type, index));
+                    child.weight = metadata.SwitchHashes.at(0);
                 }
 
-                containerMap.at(0x02)[indexMap.at(0x02)++] = cjson;
-                globalMap[++globalIndex] = indexMap.at(0x02) - 1;
+                containers.at(0x02).push_back(std::move(random));
+                globalMap.push_back(containers.at(0x02).size() - 1);
                 break;
             }
             case 0x03: // eDEIT_SwitchContainer
             {
                 DLGE_Container container(buff);
 
-                json cjson = json::object({
-                    {"type", DLGE_Type::eDEIT_SwitchContainer},
-                    {
-                        "switchKey", SwitchMap.has_key(container.SwitchGroupHash)
-                            ? SwitchMap.get_value(container.SwitchGroupHash)
-                            : std::format("{:08X}", container.SwitchGroupHash)
-                    },
-                    {
-                        "default", SwitchMap.has_key(container.DefaultSwitchHash)
-                            ? SwitchMap.get_value(container.DefaultSwitchHash)
-                            : std::format("{:08X}", container.DefaultSwitchHash)
-                    },
-                    {"containers", json::array()}
-                });
-
-                for (const DLGE_Metadata &metadata : container.metadata) {
+                Container switchContainer;
+                switchContainer.type = ContainerType::Switch;
+                switchContainer.switchKey = container.SwitchGroupHash;
+                switchContainer.defaultCase = container.DefaultSwitchHash;
+
+                for (DLGE_Metadata &metadata : container.metadata) {
                     // Switch containers will ONLY EVER CONTAIN references to random containers. And there will only ever be 1 per DLGE.
                     // But, they may contain more than one entry (or no entries) in the "SwitchHashes" array.
                     // This has been verified across all games. This, again, makes sense when considering the purposes of each container.
@@ -1108,23 +2978,15 @@ std::string DLGE::Convert(Version version, std::vector<char> data, std::string m
                     // Referencing anything other than WavFiles and random containers in a switch container is illogical.
                     if (type != 0x01 && type != 0x02) {
                         fprintf(stderr, "[LANG//DLGE] Bad switch container reference [0x%02X].\n", type);
-                        return "";
+                        return false;
                     }
 
-                    // Remove the weight value as it isn't used.
-                    containerMap.at(type).at(index).erase("weight");
-
-                    json caseArray = json::array();
-                    for (auto &hash : metadata.SwitchHashes)
-                        caseArray.push_back(SwitchMap.has_key(hash) ? SwitchMap.get_value(hash) : std::format("{:08X}", hash));
-
-                    containerMap.at(type).at(index).at("cases") = caseArray;
-                    cjson.at("containers").push_back(containerMap.at(type).at(index));
-                    containerMap.at(type).erase(index);
+                    Container &child = switchContainer.containers.emplace_back(take(type, index));
+                    child.cases = std::move(metadata.SwitchHashes);
                 }
 
-                containerMap.at(0x03)[indexMap.at(0x03)++] = cjson;
-                globalMap[++globalIndex] = indexMap.at(0x03) - 1;
+                containers.at(0x03).push_back(std::move(switchContainer));
+                globalMap.push_back(containers.at(0x03).size() - 1);
                 break;
             }
             case 0x04: // eDEIT_SequenceContainer
@@ -1135,11 +2997,9 @@ std::string DLGE::Convert(Version version, std::vector<char> data, std::string m
 
                 DLGE_Container container(buff);
 
-                json cjson = json::object({
-                    {"type", DLGE_Type::eDEIT_SequenceContainer},
-                    {"containers", json::array()}
-                });
-                
+                Container sequence;
+                sequence.type = ContainerType::Sequence;
+
                 for (const DLGE_Metadata &metadata : container.metadata)
                 {
                     uint8_t type = metadata.typeIndex >> 12;
@@ -1147,472 +3007,1035 @@ std::string DLGE::Convert(Version version, std::vector<char> data, std::string m
 
                     if (type == 0x04) {
                         fprintf(stderr, "[LANG//DLGE] A sequence container cannot contain a sequence.\n");
-                        return "";
+                        return false;
                     }
 
-                    // Remove cases and weight property as it won't be used.
-                    switch(type) {
-                        case 0x01:
-                            containerMap.at(type).at(index).erase("weight");
-                        case 0x02:
-                            containerMap.at(type).at(index).erase("cases");
+                    if (type != 0x03)
+                    {
+                        sequence.containers.push_back(take(type, index));
+                        continue;
                     }
 
-                    // We can do this as there is only one switch container per DLGE.
-                    cjson.at("containers").push_back(type == 0x03 ? (--containerMap.at(type).end())->second : containerMap.at(type).at(index));
-                    if (type == 0x03)
-                        containerMap.at(type).clear();
-                    else
-                        containerMap.at(type).erase(index);
+                    // We can do this as there is only one switch container per DLGE, the last one is used and any others are dropped.
+                    std::vector<std::optional<Container>> &switches = containers.at(0x03);
+                    auto last = std::find_if(switches.rbegin(), switches.rend(), [](const std::optional<Container> &c) { return c.has_value(); });
+                    if (last == switches.rend())
+                        throw std::out_of_range("Bad container reference.");
+
+                    sequence.containers.push_back(std::move(**last));
+                    for (std::optional<Container> &switchContainer : switches)
+                        switchContainer.reset();
                 }
 
-                containerMap.at(0x04)[indexMap.at(0x04)++] = cjson;
+                containers.at(0x04).push_back(std::move(sequence));
                 break;
             }
             case 0x15: // eDEIT_Invalid
             {
                 fprintf(stderr, "[LANG//DLGE] Invalid section found. Report this!\n");
-                return "";
+                return false;
             }
             default: // Just in case
             {
                 fprintf(stderr, "[LANG//DLGE] Unknown section found [0x%02X]. Report this!\n", buff.read<uint8_t>());
-                return "";
+                return false;
             }
             }
         }
-        
-        bool set = false;
-        for (const auto [type, typedContainerMap] : containerMap) {
-            if(!typedContainerMap.size()) continue;
-            if(typedContainerMap.size() != 1 || set)
+
+        std::optional<Container> root;
+        for (std::vector<std::optional<Container>> &typedContainers : containers)
+        {
+            auto left = std::count_if(typedContainers.begin(), typedContainers.end(), [](const std::optional<Container> &c) { return c.has_value(); });
+            if (!left)
+                continue;
+
+            if (left != 1 || root)
             {
                 fprintf(stderr, "[LANG//DLGE] More than one container left over. Report this!\n");
-                return "";
+                return false;
+            }
+
+            root = std::move(*std::find_if(typedContainers.begin(), typedContainers.end(), [](const std::optional<Container> &c) { return c.has_value(); }));
+        }
+
+        if (!root)
+        {
+            fprintf(stderr, "[LANG//DLGE] No root container found. Report this!\n");
+            return false;
+        }
+
+        document.languages = languages;
+        document.depends.clear();
+        document.ditl = ditl;
+        document.clng = clng;
+        document.root = std::move(*root);
+
+        return true;
+    }
+    catch (const std::out_of_range& err)
+    {
+        fprintf(stderr, "[LANG//DLGE] Invalid file:\n"
+                        "\t%s\n", err.what());
+    }
+
+    return false;
+}
+
+bool DLGE::Decode(Document &document, Version version, std::span<const char> data, const LanguageMap &langMap)
+{
+    PhaseTimer timer(Stats::Phase::BuildTree);
+
+    return dispatch(version, [&]<Version V>(Game<V>) { return decodeDLGE<V>(document, data, langMap); });
+}
+
+// Streams the HMLanguages JSON of a decoded DLGE, the depends are resolved through the hash_reference_data of the .meta.json.
+class DLGE_JsonConverter
+{
+public:
+    DLGE_JsonConverter(JsonWriter &writer, const std::vector<std::string> &languages, const json &depends, std::string_view defaultLocale, bool hexPrecision)
+        : writer(writer), languages(languages), depends(depends), defaultLocale(defaultLocale), hexPrecision(hexPrecision)
+    {
+        // Every wav references a few of these, so they're looked up once rather than for every language of every wav.
+        if (depends.is_array())
+        {
+            dependHashes.reserve(depends.size());
+            for (const json &depend : depends)
+            {
+                auto it = depend.is_object() ? depend.find("hash") : depend.end();
+                dependHashes.push_back(it != depend.end() ? &*it : nullptr);
+            }
+        }
+    }
+
+    const json &depend(uint32_t index) const
+    {
+        if (index < dependHashes.size() && dependHashes[index])
+            return *dependHashes[index];
+
+        // Throws the same error as the lookup always has.
+        return depends.at(index).at("hash");
+    }
+
+    // The parent's type decides if the container has a weight (Random) or cases (Switch).
+    // The root has neither, the same as the children of a Sequence.
+    void convert(const DLGE::Container &container, DLGE::ContainerType parent)
+    {
+        switch (container.type)
+        {
+        case DLGE::ContainerType::WavFile:
+            wavFile(container, parent);
+            return;
+        case DLGE::ContainerType::Random:
+            writer.beginObject();
+            writer.key("type");
+            writer.value("Random");
+
+            if (parent == DLGE::ContainerType::Switch)
+                cases(container);
+
+            children(container);
+            writer.endObject();
+            return;
+        case DLGE::ContainerType::Switch:
+            writer.beginObject();
+            writer.key("type");
+            writer.value("Switch");
+            writer.key("switchKey");
+            writer.value(resolveHash(switchMap(), container.switchKey).view());
+            writer.key("default");
+            writer.value(resolveHash(switchMap(), container.defaultCase).view());
+            children(container);
+            writer.endObject();
+            return;
+        case DLGE::ContainerType::Sequence:
+            writer.beginObject();
+            writer.key("type");
+            writer.value("Sequence");
+            children(container);
+            writer.endObject();
+            return;
+        }
+
+        writer.null();
+    }
+
+private:
+    JsonWriter &writer;
+    const std::vector<std::string> &languages;
+    const json &depends;
+    std::vector<const json*> dependHashes;
+    std::string_view defaultLocale;
+    bool hexPrecision;
+
+    void children(const DLGE::Container &container)
+    {
+        writer.key("containers");
+        writer.beginArray();
+        for (const DLGE::Container &child : container.containers)
+            convert(child, container.type);
+
+        writer.endArray();
+    }
+
+    void cases(const DLGE::Container &container)
+    {
+        writer.key("cases");
+        writer.beginArray();
+        for (uint32_t hash : container.cases)
+            writer.value(resolveHash(switchMap(), hash).view());
+
+        writer.endArray();
+    }
+
+    bool hasDepends(const DLGE::Localization &localization) const
+    {
+        return localization.wav != DLGE::NoDepend && localization.ffx != DLGE::NoDepend;
+    }
+
+    void wavFile(const DLGE::Container &container, DLGE::ContainerType parent)
+    {
+        HexChars<8> wavHash = hex8(container.wavName);
+        std::string_view wavName = wavHash;
+
+        // The default locale's wav and ffx are written before the languages, the last one found is used.
+        // Every depend is resolved up front too, so a bad one fails the same way whichever language it's in.
+        const DLGE::Localization* defaultLocalization = nullptr;
+        for (size_t i = 0; i < languages.size(); i++)
+        {
+            const DLGE::Localization &localization = container.localizations.at(i);
+            if (!hasDepends(localization))
+                continue;
+
+            const json &wav = depend(localization.wav);
+            const json &ffx = depend(localization.ffx);
+
+            if (languages.at(i) == defaultLocale)
+            {
+                jsonStringRef(wav);
+                jsonStringRef(ffx);
+                defaultLocalization = &localization;
+            }
+        }
+
+        // As we are most likely to have the english (default locale unless specified) hash, we get the wav hash from here.
+        if (defaultLocalization)
+            wavName = getWavName(jsonStringRef(depend(defaultLocalization->wav)), jsonStringRef(depend(defaultLocalization->ffx)), wavName);
+
+        writer.beginObject();
+        writer.key("type");
+        writer.value("WavFile");
+        writer.key("wavName");
+        writer.value(wavName);
+
+        if (parent == DLGE::ContainerType::Switch)
+            cases(container);
+        else if (parent == DLGE::ContainerType::Random)
+        {
+            writer.key("weight");
+            // Weights are 24-bit, anything wider is written with all of its digits the same as std::format did.
+            if (hexPrecision && container.weight <= 0xFFFFFF)
+                writer.value(toHex<6>(container.weight).view());
+            else if (hexPrecision)
+                writer.value(std::format("{:06X}", container.weight));
+            else
+                writer.value(json((double)container.weight / (double)0xFFFFFF));
+        }
+
+        writer.key("soundtag");
+        writer.value(resolveHash(tagMap(), container.soundtag).view());
+
+        writer.key("defaultWav");
+        defaultLocalization ? writer.value(depend(defaultLocalization->wav)) : writer.null();
+        writer.key("defaultFfx");
+        defaultLocalization ? writer.value(depend(defaultLocalization->ffx)) : writer.null();
+
+        writer.key("languages");
+        writer.beginObject();
+
+        for (size_t i = 0; i < languages.size(); i++)
+        {
+            const std::string &language = languages.at(i);
+            const DLGE::Localization &localization = container.localizations.at(i);
+
+            bool isDefault = language == defaultLocale;
+            bool object = !isDefault && hasDepends(localization);
+            if (!object && !localization.subtitle)
+                continue;
+
+            // A language repeated in the langmap keeps its first entry.
+            bool repeated = false;
+            for (size_t k = 0; k < i && !repeated; k++)
+            {
+                const DLGE::Localization &earlier = container.localizations.at(k);
+                repeated = languages.at(k) == language && ((!isDefault && hasDepends(earlier)) || earlier.subtitle);
+            }
+
+            if (repeated)
+                continue;
+
+            writer.key(language);
+
+            if (!object)
+            {
+                writer.value(*localization.subtitle);
+                continue;
+            }
+
+            writer.beginObject();
+            writer.key("wav");
+            writer.value(depend(localization.wav));
+            writer.key("ffx");
+            writer.value(depend(localization.ffx));
+
+            if (localization.subtitle)
+            {
+                writer.key("subtitle");
+                writer.value(*localization.subtitle);
             }
 
-            j.at("rootContainer") = typedContainerMap.rbegin()->second;
+            writer.endObject();
+        }
+
+        writer.endObject();
+        writer.endObject();
+    }
+};
+
+bool DLGE::ConvertInto(std::string &output, Version version, std::span<const char> data, std::string_view metaJson, std::string_view defaultLocale, bool hexPrecision, const LanguageMap &langMap, const HashListContext &hashList)
+{
+    HashListScope scope(hashList);
+    JsonScope jsonScope;
+
+    Document document;
+    if (!Decode(document, version, data, langMap))
+        return false;
+
+    size_t outputSize = output.size();
+
+    try
+    {
+        PhaseTimer timer(Stats::Phase::ParseMeta);
+        json meta = json::parse(metaJson);
+        timer.next(Stats::Phase::Dump);
+
+        // Written straight out rather than through a DOM, the output is the same as dump() would give.
+        JsonWriter writer(output);
+        writer.beginObject();
+        writer.key("$schema");
+        writer.value("https://tonytools.win/schemas/dlge.schema.json");
+        writer.key("hash");
+        writer.value(meta["hash_path"].is_null() ? meta.at("hash_value") : meta.at("hash_path"));
+
+        DLGE_JsonConverter converter(writer, document.languages, meta.at("hash_reference_data"), defaultLocale, hexPrecision);
+        writer.key("DITL");
+        writer.value(converter.depend(document.ditl));
+        writer.key("CLNG");
+        writer.value(converter.depend(document.clng));
+
+        if (!langMap.empty())
+        {
+            writer.key("langmap");
+            writer.value(langMap.str());
+        }
+
+        writer.key("rootContainer");
+        converter.convert(document.root, ContainerType::Sequence);
+        writer.endObject();
+
+        return true;
+    }
+    catch (const json::exception& err)
+    {
+        output.resize(outputSize);
+        fprintf(stderr, "[LANG//DLGE] JSON error:\n"
+                        "\t%s\n", err.what());
+        fprintf(stderr, "This could be due to your language maps not matching up to the number of languages in the file (older file?).\n");
+    }
+
+    return false;
+}
+
+std::string DLGE::Convert(Version version, std::span<const char> data, std::string_view metaJson, std::string_view defaultLocale, bool hexPrecision, const LanguageMap &langMap, const HashListContext &hashList)
+{
+    std::string output;
+    ConvertInto(output, version, data, metaJson, defaultLocale, hexPrecision, langMap, hashList);
+    return output;
+}
+
+// A DLGE compiled down to what gets written: the containers flattened in the order they are written (children before
+// the container referencing them) with every reference already resolved to its typeIndex, so emitting is a single pass.
+class DLGE_Program
+{
+public:
+    struct Localization
+    {
+        uint32_t wav;
+        uint32_t ffx;
+        std::optional<std::string_view> subtitle; // Points into the source, which has to outlive the program.
+    };
+
+    DLGE_Program()
+    {
+        // 0 is the "global" index
+        indexMap.fill(-1);
+    }
+
+    // Starts a container, its children have to be added (and closed) before it is closed itself.
+    bool open(DLGE::ContainerType type, uint32_t hashA = 0, uint32_t hashB = 0)
+    {
+        // This allows us to ensure that there's only one switch container per DLGE.
+        if (type == DLGE::ContainerType::Switch && indexMap.at(0x03) != -1)
+        {
+            fprintf(stderr, "[LANG//DLGE] Multiple Switch containers found in DLGE!\n");
+            return false;
+        }
+
+        // Same for sequence containers.
+        if (type == DLGE::ContainerType::Sequence && indexMap.at(0x04) != -1)
+        {
+            fprintf(stderr, "[LANG//DLGE] Multiple Sequence containers found in DLGE!\n");
+            return false;
+        }
+
+        open_.push_back({{type, hashA, hashB, (uint32_t)localizations.size(), 0}, pending.size()});
+        return true;
+    }
+
+    // Adds a language to the open WavFile.
+    void localization(uint32_t wav, uint32_t ffx, std::optional<std::string_view> subtitle)
+    {
+        localizations.push_back({wav, ffx, subtitle});
+    }
 
-            switch (type) {
-                case 0x01:
-                    j.at("rootContainer").erase("weight");
-                case 0x02:
-                    j.at("rootContainer").erase("cases");
-            }
-            set = true;
-        }
+    // Closes the innermost open container, numbering it the same way the game does.
+    void close()
+    {
+        Frame frame = open_.back();
+        open_.pop_back();
 
-        if (!set)
+        Node &node = nodes.emplace_back(frame.node);
+        if (node.type == DLGE::ContainerType::WavFile)
         {
-            fprintf(stderr, "[LANG//DLGE] No root container found. Report this!\n");
-            return "";
+            node.count = localizations.size() - node.first;
+            indexMap.at(0x01)++;
+            return;
         }
 
-        return j.dump();
+        // The references of the children are at the top of the pending stack.
+        node.first = references.size();
+        node.count = pending.size() - frame.pending;
+        references.insert(references.end(), pending.begin() + frame.pending, pending.end());
+        pending.resize(frame.pending);
+
+        indexMap.at(0x00)++;
+        indexMap.at((uint8_t)node.type)++;
     }
-    catch (const json::exception& err)
+
+    // References the container that was just closed from the open container, with its weight or cases.
+    void reference(std::span<const uint32_t> entries = {})
     {
-        fprintf(stderr, "[LANG//DLGE] JSON error:\n"
-                        "\t%s\n", err.what());
-        fprintf(stdout, "This could be due to your language maps not matching up to the number of languages in the file (older file?).\n");
-    }
+        uint8_t parent = (uint8_t)open_.back().node.type;
+        uint8_t type = (uint8_t)nodes.back().type;
 
-    return "";
-}
+        pending.push_back({typeIndex(parent, type), (uint32_t)values.size(), (uint32_t)entries.size()});
+        values.insert(values.end(), entries.begin(), entries.end());
 
-// Avoids code duplication
-void addDepend(
-    buffer &buff,
-    std::string hash,
-    std::string flag,
-    tsl::ordered_map<std::string, std::string> &depends
-)
-{
-    if (depends.contains(hash))
-        buff.write<uint32_t>(depends.find(hash) - depends.begin());
-    else
-    {
-        buff.write<uint32_t>(depends.size());
-        depends[hash] = flag;
+        // Switch and sequence containers count their children as well.
+        if (parent == 0x03 || parent == 0x04)
+            indexMap.at(parent)++;
     }
-}
 
-bool processContainer(
-    Version version,
-    buffer &buff,
-    json container,
-    std::unordered_map<uint32_t, uint32_t> &indexMap,
-    std::vector<std::pair<std::string, uint32_t>> languages,
-    tsl::ordered_map<std::string, std::string> &depends,
-    std::string defLocale
-)
-{
-    DLGE_Type type = container.at("type").get<DLGE_Type>();
+    template <Version V>
+    void emit(Writer &buff, XteaBatch &batch) const
+    {
+        size_t subtitles = 0;
+        for (const Node &node : nodes)
+        {
+            buff.write<uint8_t>((uint8_t)node.type);
+            buff.write<uint32_t>(node.hashA);
+            buff.write<uint32_t>(node.hashB);
 
-    switch (type) {
-        case DLGE_Type::eDEIT_WavFile: {
-            buff.write<uint8_t>(0x01);
+            if (node.type != DLGE::ContainerType::WavFile)
+            {
+                buff.write<uint32_t>(node.count);
+                for (const Reference &reference : std::span(references).subspan(node.first, node.count))
+                {
+                    buff.write<uint16_t>(reference.typeIndex);
+                    buff.writeVector(std::span(values).subspan(reference.first, reference.count));
+                }
 
-            std::string soundTag = container.at("soundtag").get<std::string>();
-            buff.write<uint32_t>(TagMap.has_value(soundTag) ? TagMap.get_key(soundTag) : hexStringToNum(soundTag));
-            buff.write<uint32_t>(hexStringToNum(container.at("wavName").get<std::string>()));
+                continue;
+            }
 
-            if (version != Version::H2016)
+            // H2016 has this at the start of every language instead.
+            if constexpr (!Game<V>::dlgeValuePerLanguage)
                 buff.write<uint32_t>(0x00);
 
-            for (const auto &[language, index] : languages)
+            for (const Localization &localization : std::span(localizations).subspan(node.first, node.count))
             {
-                if (version == Version::H2016)
+                if constexpr (Game<V>::dlgeValuePerLanguage)
                     buff.write<uint32_t>(0x00);
 
-                if (defLocale == language)
-                {
-                    if (!container.at("defaultWav").is_null() && !container.at("defaultFfx").is_null())
-                    {
-                        addDepend(
-                            buff,
-                            container.at("defaultWav").get<std::string>(),
-                            std::format("{:02X}", 0x80 + index),
-                            depends
-                        );
-
-                        addDepend(
-                            buff,
-                            container.at("defaultFfx").get<std::string>(),
-                            std::format("{:02X}", 0x80 + index),
-                            depends
-                        );
-                    }
-                    else
-                        buff.write<uint64_t>(ULLONG_MAX);
+                buff.write<uint32_t>(localization.wav);
+                buff.write<uint32_t>(localization.ffx);
 
-                    if (container.at("languages").contains(language))
-                        if (container.at("languages").at(language).size() == 0)
-                            buff.write<uint32_t>(0x00);
-                        else
-                            buff.write<std::vector<char>>(xteaEncrypt(container.at("languages").at(language).get<std::string>()));
-                    else
-                        buff.write<uint32_t>(0x00);
+                if (localization.subtitle)
+                {
+                    writeXteaString(buff, *localization.subtitle, batch);
+                    subtitles++;
                 }
                 else
-                {
-                    if (!container.at("languages").contains(language))
-                    {
-                        buff.write<uint64_t>(ULLONG_MAX);
-                        buff.write<uint32_t>(0x00);
+                    buff.write<uint32_t>(0x00);
+            }
+        }
 
-                        continue;
-                    }
+        countStat(&Stats::strings, subtitles);
 
-                    if (container.at("languages").at(language).is_object())
-                    {
-                        // This language has wav and ffx (and possibly subtitles).
-                        addDepend(
-                            buff,
-                            container.at("languages").at(language).at("wav").get<std::string>(),
-                            std::format("{:02X}", 0x80 + index),
-                            depends
-                        );
-
-                        addDepend(
-                            buff,
-                            container.at("languages").at(language).at("ffx").get<std::string>(),
-                            std::format("{:02X}", 0x80 + index),
-                            depends
-                        );
-
-                        if (container.at("languages").at(language).contains("subtitle"))
-                            buff.write<std::vector<char>>(xteaEncrypt(container.at("languages").at(language).at("subtitle").get<std::string>()));
-                        else
-                            buff.write<uint32_t>(0x00);
+        // The root is referenced at the end of the file, the same way a sequence would.
+        buff.write<uint16_t>(typeIndex(0x04, (uint8_t)nodes.back().type));
+    }
 
-                        continue;
-                    }
+private:
+    struct Node
+    {
+        DLGE::ContainerType type;
+        uint32_t hashA; // Soundtag or switch group hash.
+        uint32_t hashB; // Wav name or default switch hash.
+        uint32_t first; // First localization (WavFile) or reference.
+        uint32_t count;
+    };
 
-                    buff.write<uint64_t>(ULLONG_MAX);
+    struct Reference
+    {
+        uint16_t typeIndex; // >> 12 for type -- & 0xFFF for index
+        uint32_t first;     // The weight or cases in values.
+        uint32_t count;
+    };
 
-                    if (container.at("languages").at(language).size() == 0)
-                        buff.write<uint32_t>(0x00);
-                    else
-                        buff.write<std::vector<char>>(xteaEncrypt(container.at("languages").at(language).get<std::string>()));
-                }
+    struct Frame
+    {
+        Node node;
+        size_t pending;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<Localization> localizations;
+    std::vector<Reference> references;
+    std::vector<uint32_t> values;
+
+    std::vector<Frame> open_;
+    std::vector<Reference> pending;
+
+    // The index of the last container written of each type.
+    std::array<uint32_t, 5> indexMap;
+
+    // Weirdly, sequences reference random and switch containers by their "global" index.
+    uint16_t typeIndex(uint8_t parent, uint8_t type) const
+    {
+        uint8_t map = (parent == 0x04 && type != 0x01) ? 0x00 : type;
+        return (type << 12) | (indexMap.at(map) & 0xFFF);
+    }
+};
+
+// Compiles a Document's containers, checking the same rules the game follows.
+bool compileContainer(DLGE_Program &program, const DLGE::Container &container, size_t languageCount)
+{
+    switch (container.type) {
+        case DLGE::ContainerType::WavFile: {
+            if (container.localizations.size() != languageCount)
+            {
+                fprintf(stderr, "[LANG//DLGE] WavFile has %zu languages, expected %zu.\n", container.localizations.size(), languageCount);
+                return false;
             }
 
-            indexMap.at(0x01)++;
-            break;
+            program.open(container.type, container.soundtag, container.wavName);
+            for (const DLGE::Localization &localization : container.localizations)
+                program.localization(localization.wav, localization.ffx, localization.subtitle);
+
+            program.close();
+            return true;
         }
-        case DLGE_Type::eDEIT_RandomContainer: {
-            DLGE_Container rawContainer(0x02, 0, 0);
+        case DLGE::ContainerType::Random:
+        case DLGE::ContainerType::Switch:
+        case DLGE::ContainerType::Sequence: {
+            const char* name = container.type == DLGE::ContainerType::Random ? "Random"
+                : container.type == DLGE::ContainerType::Switch ? "Switch" : "Sequence";
+
+            if (container.type == DLGE::ContainerType::Switch)
+            {
+                if (!program.open(container.type, container.switchKey, container.defaultCase))
+                    return false;
+            }
+            else if (!program.open(container.type))
+                return false;
 
-            // We need to write the wav files first.
-            for (const json &childContainer : container.at("containers"))
+            for (const DLGE::Container &child : container.containers)
             {
-                if (childContainer.at("type").get<DLGE_Type>() != DLGE_Type::eDEIT_WavFile)
+                // Random containers only hold WavFiles, switch containers WavFiles and random containers.
+                if (container.type == DLGE::ContainerType::Random && child.type != DLGE::ContainerType::WavFile)
                 {
                     fprintf(stderr, "[LANG//DLGE] Invalid type found in Random container!\n");
                     return false;
                 }
 
-                if (!childContainer.contains("weight"))
+                if (container.type == DLGE::ContainerType::Switch && child.type != DLGE::ContainerType::WavFile && child.type != DLGE::ContainerType::Random)
                 {
-                    fprintf(stderr, "[LANG//DLGE] Missing weight in Random container child.\n");
+                    fprintf(stderr, "[LANG//DLGE] Invalid type found in Switch container.\n");
                     return false;
                 }
 
-                if (!processContainer(
-                    version,
-                    buff,
-                    childContainer,
-                    indexMap,
-                    languages,
-                    depends,
-                    defLocale
-                ))
+                if (!compileContainer(program, child, languageCount))
                 {
-                    fprintf(stderr, "[LANG//DLGE] Failed to process a Random container child.\n");
+                    fprintf(stderr, "[LANG//DLGE] Failed to process a %s container child.\n", name);
                     return false;
                 }
-            
-                uint32_t weight;
 
-                if (childContainer.at("weight").is_string())
-                {
-                    std::string weightStr = childContainer.at("weight").get<std::string>();
-                    // Hex precision was enabled on convert.
-                    weight = std::strtoul(childContainer.at("weight").get<std::string>().c_str(), NULL, 16);
-                    if (!std::all_of(weightStr.begin(), weightStr.end(), ::isxdigit))
-                    {
-                        fprintf(stderr, "[LANG//DLGE] Invalid weight found in Random container child.\n");
-                        return false;
-                    }
-                }
+                if (container.type == DLGE::ContainerType::Random)
+                    program.reference(std::span(&child.weight, 1));
+                else if (container.type == DLGE::ContainerType::Switch)
+                    program.reference(child.cases);
                 else
-                    // It must be a double.
-                    weight = round(childContainer.at("weight").get<double>() * 0xFFFFFF);
-
-                // We only ever have WavFiles in a random container.
-                rawContainer.addMetadata(
-                    (0x01 << 12) | (indexMap.at(0x01) & 0xFFF),
-                    std::vector<uint32_t>({
-                        weight
-                    })
-                );
+                    program.reference();
             }
 
-            rawContainer.write(buff);
-            indexMap.at(0x00)++;
-            indexMap.at(0x02)++;
-            break;
+            program.close();
+            return true;
         }
-        case DLGE_Type::eDEIT_SwitchContainer: {
-            // This allows us to ensure that there's only one switch container per DLGE.
-            if (indexMap.at(0x03) != -1)
-            {
-                fprintf(stderr, "[LANG//DLGE] Multiple Switch containers found in DLGE!\n");
-                return false;
-            }
+        default: {
+            fprintf(stderr, "[LANG//DLGE] Invalid container type [0x%02X].\n", (uint8_t)container.type);
+            return false;
+        }
+    }
+}
 
-            if (!container.contains("switchKey") || !container.contains("default"))
-            {
-                fprintf(stderr, "[LANG//DLGE] Switch container is missing \"switchKey\" or \"default\" property.\n");
-                return false;
-            }
+bool DLGE::Encode(std::vector<char> &output, Version version, const Document &document)
+{
+    PhaseTimer timer(Stats::Phase::Encode);
 
-            std::string switchKey = container.at("switchKey").get<std::string>();
-            std::string defGroup = container.at("default").get<std::string>();
-            DLGE_Container rawContainer(
-                0x03,
-                SwitchMap.has_value(switchKey) ? SwitchMap.get_key(switchKey) : hexStringToNum(switchKey),
-                SwitchMap.has_value(defGroup) ? SwitchMap.get_key(defGroup) : hexStringToNum(defGroup)
-            );
+    output.clear();
 
-            for (const json &childContainer : container.at("containers"))
-            {
-                DLGE_Type cType = childContainer.at("type").get<DLGE_Type>();
+    DLGE_Program program;
+    if (!compileContainer(program, document.root, document.languages.size()))
+        return false;
+
+    // Written straight into the output's memory.
+    Writer buff(output);
+    buff.write<uint32_t>(document.ditl);
+    buff.write<uint32_t>(document.clng);
+
+    // Subtitles are written as plaintext and encrypted all at once after the file has been built.
+    XteaBatch batch;
+    dispatch(version, [&]<Version V>(Game<V>) { program.emit<V>(buff, batch); });
+    encryptSubtitles(batch, output.data());
+
+    return true;
+}
+
+// Compiles the HMLanguages JSON of the containers straight into a program, the subtitles are left in the JSON and the
+// depends are added to the map as they are found.
+class DLGE_JsonCompiler
+{
+public:
+    DLGE_JsonCompiler(DLGE_Program &program, const std::vector<std::string> &languages, tsl::ordered_map<std::string, std::string> &depends, std::string_view defaultLocale)
+        : program(program), languages(languages), depends(depends), defLocale(defaultLocale)
+    {
+        for (uint32_t index = 0; index < languages.size(); index++)
+            flags.push_back(std::format("{:02X}", 0x80 + index));
+    }
+
+    uint32_t addDepend(const std::string &hash, const std::string &flag)
+    {
+        // The first flag a depend is added with is kept.
+        auto it = depends.try_emplace(hash, flag).first;
+        return it - depends.begin();
+    }
+
+    bool compile(const json &container)
+    {
+        DLGE_Type type = container.at("type").get<DLGE_Type>();
+
+        switch (type) {
+            case DLGE_Type::eDEIT_WavFile: {
+                const std::string &soundTag = jsonStringRef(container.at("soundtag"));
+                uint32_t wavName = hexStringToNum(jsonStringRef(container.at("wavName")));
 
-                if (cType != DLGE_Type::eDEIT_WavFile && cType != DLGE_Type::eDEIT_RandomContainer)
+                program.open(DLGE::ContainerType::WavFile, lookupHash(tagMap(), soundTag), wavName);
+
+                const json &languagesJson = container.at("languages");
+                for (uint32_t index = 0; index < languages.size(); index++)
                 {
-                    fprintf(stderr, "[LANG//DLGE] Invalid type found in Switch container.\n");
-                    return false;
+                    const std::string &language = languages.at(index);
+                    uint32_t wav = DLGE::NoDepend;
+                    uint32_t ffx = DLGE::NoDepend;
+                    std::optional<std::string_view> subtitle;
+
+                    auto it = languagesJson.find(language);
+                    if (defLocale == language)
+                    {
+                        if (!container.at("defaultWav").is_null() && !container.at("defaultFfx").is_null())
+                        {
+                            wav = addDepend(container.at("defaultWav").get<std::string>(), flags.at(index));
+                            ffx = addDepend(container.at("defaultFfx").get<std::string>(), flags.at(index));
+                        }
+
+                        if (it != languagesJson.end() && it->size() != 0)
+                            subtitle = jsonStringRef(*it);
+                    }
+                    else if (it != languagesJson.end() && it->is_object())
+                    {
+                        // This language has wav and ffx (and possibly subtitles).
+                        wav = addDepend(it->at("wav").get<std::string>(), flags.at(index));
+                        ffx = addDepend(it->at("ffx").get<std::string>(), flags.at(index));
+
+                        if (it->contains("subtitle"))
+                            subtitle = jsonStringRef(it->at("subtitle"));
+                    }
+                    else if (it != languagesJson.end() && it->size() != 0)
+                        subtitle = jsonStringRef(*it);
+
+                    program.localization(wav, ffx, subtitle);
                 }
 
-                if (!childContainer.contains("cases"))
-                {
-                    fprintf(stderr, "[LANG//DLGE] Cases array missing from Switch container child.\n");
+                program.close();
+                return true;
+            }
+            case DLGE_Type::eDEIT_RandomContainer: {
+                if (!program.open(DLGE::ContainerType::Random))
                     return false;
+
+                for (const json &childContainer : container.at("containers"))
+                {
+                    if (childContainer.at("type").get<DLGE_Type>() != DLGE_Type::eDEIT_WavFile)
+                    {
+                        fprintf(stderr, "[LANG//DLGE] Invalid type found in Random container!\n");
+                        return false;
+                    }
+
+                    if (!childContainer.contains("weight"))
+                    {
+                        fprintf(stderr, "[LANG//DLGE] Missing weight in Random container child.\n");
+                        return false;
+                    }
+
+                    if (!compile(childContainer))
+                    {
+                        fprintf(stderr, "[LANG//DLGE] Failed to process a Random container child.\n");
+                        return false;
+                    }
+
+                    uint32_t weight = 0;
+                    if (childContainer.at("weight").is_string())
+                    {
+                        const std::string &weightStr = jsonStringRef(childContainer.at("weight"));
+                        // Hex precision was enabled on convert.
+                        if (!isHex(weightStr))
+                        {
+                            fprintf(stderr, "[LANG//DLGE] Invalid weight found in Random container child.\n");
+                            return false;
+                        }
+                        weight = parseHex32(weightStr);
+                    }
+                    else
+                        // It must be a double.
+                        weight = round(childContainer.at("weight").get<double>() * 0xFFFFFF);
+
+                    program.reference(std::span(&weight, 1));
                 }
 
-                if (!processContainer(
-                    version,
-                    buff,
-                    childContainer,
-                    indexMap,
-                    languages,
-                    depends,
-                    defLocale
-                ))
+                program.close();
+                return true;
+            }
+            case DLGE_Type::eDEIT_SwitchContainer: {
+                if (!container.contains("switchKey") || !container.contains("default"))
                 {
-                    fprintf(stderr, "[LANG//DLGE] Failed to process a Switch container child.\n");
+                    fprintf(stderr, "[LANG//DLGE] Switch container is missing \"switchKey\" or \"default\" property.\n");
                     return false;
                 }
 
-                std::vector<uint32_t> switchCases{};
+                std::string switchKey = container.at("switchKey").get<std::string>();
+                std::string defGroup = container.at("default").get<std::string>();
+
+                if (!program.open(DLGE::ContainerType::Switch, lookupHash(switchMap(), switchKey), lookupHash(switchMap(), defGroup)))
+                    return false;
 
-                for (const json &sCase : childContainer.at("cases"))
+                for (const json &childContainer : container.at("containers"))
                 {
-                    std::string caseStr = sCase.get<std::string>();
-                    switchCases.push_back(
-                        SwitchMap.has_value(caseStr) ? SwitchMap.get_key(caseStr) : hexStringToNum(caseStr)
-                    );
-                }
+                    DLGE_Type cType = childContainer.at("type").get<DLGE_Type>();
 
-                rawContainer.addMetadata(
-                    ((uint8_t)cType << 12) | (indexMap.at((uint8_t)cType) & 0xFFF),
-                    switchCases
-                );
+                    if (cType != DLGE_Type::eDEIT_WavFile && cType != DLGE_Type::eDEIT_RandomContainer)
+                    {
+                        fprintf(stderr, "[LANG//DLGE] Invalid type found in Switch container.\n");
+                        return false;
+                    }
 
-                indexMap.at(0x03)++;
-            }
+                    if (!childContainer.contains("cases"))
+                    {
+                        fprintf(stderr, "[LANG//DLGE] Cases array missing from Switch container child.\n");
+                        return false;
+                    }
 
-            rawContainer.write(buff);
-            indexMap.at(0x00)++;
-            indexMap.at(0x03)++;
-            break;
-        }
-        case DLGE_Type::eDEIT_SequenceContainer: {
-            // This allows us to ensure that there's only one sequence container per DLGE.
-            if (indexMap.at(0x04) != -1)
-            {
-                fprintf(stderr, "[LANG//DLGE] Multiple Sequence containers found in DLGE!\n");
-                return false;
-            }
+                    if (!compile(childContainer))
+                    {
+                        fprintf(stderr, "[LANG//DLGE] Failed to process a Switch container child.\n");
+                        return false;
+                    }
 
-            DLGE_Container rawContainer(0x04, 0, 0);
+                    cases.clear();
+                    for (const json &sCase : childContainer.at("cases"))
+                        cases.push_back(lookupHash(switchMap(), jsonStringRef(sCase)));
 
-            for (const json &childContainer : container.at("containers"))
-            {
-                DLGE_Type cType = childContainer.at("type").get<DLGE_Type>();
-
-                if (!processContainer(
-                    version,
-                    buff,
-                    childContainer,
-                    indexMap,
-                    languages,
-                    depends,
-                    defLocale
-                ))
-                {
-                    fprintf(stderr, "[LANG//DLGE] Failed to process a Sequence container child.\n");
-                    return false;
+                    program.reference(cases);
                 }
 
-                rawContainer.addMetadata(
-                    ((uint8_t)cType << 12) | (indexMap.at((uint8_t)cType == 0x01 ? 0x01 : 0x00) & 0xFFF),
-                    {}
-                );
-
-                indexMap.at(0x04)++;
+                program.close();
+                return true;
             }
+            case DLGE_Type::eDEIT_SequenceContainer: {
+                if (!program.open(DLGE::ContainerType::Sequence))
+                    return false;
 
-            rawContainer.write(buff);
-            indexMap.at(0x00)++;
-            indexMap.at(0x04)++;
-            break;
-        }
-        case DLGE_Type::eDEIT_Invalid: {
-            fprintf(stderr, "[LANG//DLGE] Invalid type found in JSON.\n");
-            return false;
+                for (const json &childContainer : container.at("containers"))
+                {
+                    if (!compile(childContainer))
+                    {
+                        fprintf(stderr, "[LANG//DLGE] Failed to process a Sequence container child.\n");
+                        return false;
+                    }
+
+                    program.reference();
+                }
+
+                program.close();
+                return true;
+            }
+            default: {
+                fprintf(stderr, "[LANG//DLGE] Invalid type found in JSON.\n");
+                return false;
+            }
         }
     }
 
-    if (container.contains("isRoot"))
-        buff.write<uint16_t>(((uint8_t)type << 12) | (indexMap.at((uint8_t)type == 0x01 ? 0x01 : 0x00) & 0xFFF));
+private:
+    DLGE_Program &program;
+    const std::vector<std::string> &languages;
+    tsl::ordered_map<std::string, std::string> &depends;
+    std::string defLocale;
 
-    return true;
-}
+    // The depend flag of each language, and a scratch buffer for switch cases.
+    std::vector<std::string> flags;
+    std::vector<uint32_t> cases;
+};
 
-Rebuilt DLGE::Rebuild(Version version, std::string jsonString, std::string defaultLocale, std::string langMap)
+bool DLGE::RebuildInto(Rebuilt &out, Version version, std::string_view jsonString, std::string_view defaultLocale, const LanguageMap &langMap, const HashListContext &hashList)
 {
-    Rebuilt out{};
-    tsl::ordered_map<std::string, std::string> depends{};
+    HashListScope scope(hashList);
+    JsonScope jsonScope;
 
-    // We require it to be ordered. These are, like usual, the H2 languages.
-    std::vector<std::pair<std::string, uint32_t>> languages = {
-        {"xx", 0}, {"en", 1}, {"fr", 2}, {"it", 3}, {"de", 4}, {"es", 5}, {"ru", 6}, {"mx", 7}, {"br", 8}, {"pl", 9}, {"cn", 10}, {"jp", 11}, {"tc", 12}
-    };
-    if (!langMap.empty())
-    {
-        languages.clear();
-        std::vector<std::string> langs = split(langMap);
-        for (int i = 0; i < langs.size(); i++)
-            languages.push_back({ langs.at(i), i });
-    }
-    else if (version == Version::H2016)
-        // Late versions of H2016 share the same langmap as H2, but without tc, so we remove it.
-        languages.pop_back();
-    else if (version == Version::H3)
-        languages = {{"xx", 0}, {"en", 1}, {"fr", 2}, {"it", 3}, {"de", 4}, {"es", 5}, {"ru", 6}, {"cn", 7}, {"tc", 8}, {"jp", 9}};
+    out.clear();
 
     try
     {
+        PhaseTimer timer(Stats::Phase::ParseJson);
         json jSrc = json::parse(jsonString);
+        timer.next(Stats::Phase::BuildTree);
 
-        buffer buff;
+        const std::vector<std::string>* languages = &resolveLanguages(langMap, dispatch(version, []<Version V>(Game<V>) -> const std::vector<std::string> & {
+            return Game<V>::dlgeLanguageList();
+        }));
 
         // The langmap property overrides any argument passed languages maps.
         // This property ensures easy compat with tools like SMF.
+        LanguageMap property;
         if (jSrc.contains("langmap"))
+            languages = &propertyLanguages(property, jSrc.at("langmap").get<std::string>());
+
+        DLGE_Program program;
+        tsl::ordered_map<std::string, std::string> depends;
+        DLGE_JsonCompiler compiler(program, *languages, depends, defaultLocale);
+
+        // The DITL and CLNG are always the first two depends.
+        compiler.addDepend(jSrc.at("DITL").get<std::string>(), "1F");
+        compiler.addDepend(jSrc.at("CLNG").get<std::string>(), "1F");
+
+        if (!compiler.compile(jSrc.at("rootContainer")))
         {
-            languages.clear();
-            std::vector<std::string> langs = split(jSrc.at("langmap").get<std::string>());
-            for (int i = 0; i < langs.size(); i++)
-                languages.push_back({ langs.at(i), i });
+            fprintf(stderr, "[LANG//DLGE] Failed to process containers!\n");
+            out.clear();
+            return false;
         }
-        
+
+        // Everything has been checked and resolved, all that's left is writing it out.
+        timer.next(Stats::Phase::Encode);
+        Writer buff(out.file);
         buff.write<uint32_t>(0x00);
-        depends[jSrc.at("DITL").get<std::string>()] = "1F";
         buff.write<uint32_t>(0x01);
-        depends[jSrc.at("CLNG").get<std::string>()] = "1F";
 
-        // So the processContainer function knows what the root container is.
-        jSrc.at("rootContainer").push_back({ "isRoot", true });
+        XteaBatch batch;
+        dispatch(version, [&]<Version V>(Game<V>) { program.emit<V>(buff, batch); });
+        encryptSubtitles(batch, out.file.data());
 
-        // 0 is the "global" index
-        std::unordered_map<uint32_t, uint32_t> indexMap = {
-            {0, -1},
-            {1, -1},
-            {2, -1},
-            {3, -1},
-            {4, -1}
-        };
+        out.meta = generateMeta(jSrc.at("hash"), out.file.size(), "DLGE", depends);
+
+        return true;
+    }
+    catch (const json::exception& err)
+    {
+        fprintf(stderr, "[LANG//DLGE] JSON error:\n"
+                        "\t%s\n", err.what());
+    }
+
+    out.clear();
+    return false;
+}
+
+Rebuilt DLGE::Rebuild(Version version, std::string_view jsonString, std::string_view defaultLocale, const LanguageMap &langMap, const HashListContext &hashList)
+{
+    Rebuilt out{};
+    RebuildInto(out, version, jsonString, defaultLocale, langMap, hashList);
+    return out;
+}
+#pragma endregion
+
+#pragma region Verify
+std::string toUpperHex(std::string_view str)
+{
+    std::string upper(str);
+    std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char c) { return (char)std::toupper(c); });
+    return upper;
+}
+
+// The ResourceID of a hash in a .meta.json, which is a path if the hash list resolved it.
+std::string metaResourceID(const json &value)
+{
+    const std::string &hash = jsonStringRef(value);
+    return isResourceID(hash) ? toUpperHex(hash) : std::string(computeHash(hash));
+}
+
+bool Verify::Result::Matches() const
+{
+    return rebuilt && firstDifference == SIZE_MAX && hashMatches && firstReferenceDifference == SIZE_MAX;
+}
+
+std::string Verify::Result::Summary() const
+{
+    if (!converted)
+        return "failed to convert";
+
+    if (!rebuilt)
+        return "failed to rebuild";
+
+    if (Matches())
+        return std::format("matches ({} bytes, {} depends)", originalSize, originalReferences);
 
-        // This function will process all containers recursively.
-        if (!processContainer(
-            version,
-            buff,
-            jSrc.at("rootContainer"),
-            indexMap,
-            languages,
-            depends,
-            defaultLocale
-        ))
+    std::vector<std::string> differences;
+    if (firstDifference != SIZE_MAX)
+    {
+        std::string difference = std::format("file differs at 0x{:X} ({} bytes", firstDifference, differentBytes);
+        if (rebuiltSize != originalSize)
+            difference += std::format(", {} -> {} bytes", originalSize, rebuiltSize);
+        differences.push_back(difference + ")");
+    }
+
+    if (!hashMatches)
+        differences.push_back("hash differs");
+
+    if (firstReferenceDifference != SIZE_MAX)
+        differences.push_back(std::format("depends differ at #{} ({} -> {})", firstReferenceDifference, originalReferences, rebuiltReferences));
+
+    std::string summary = differences.front();
+    for (size_t i = 1; i < differences.size(); i++)
+        summary += ", " + differences[i];
+
+    return summary;
+}
+
+bool Verify::RoundTrip(Result &result, ResourceType type, Version version, std::span<const char> data, std::string_view metaJson, const Options &options, const HashListContext &hashList)
+{
+    result = {};
+    result.originalSize = data.size();
+
+    // Kept per thread, verifying a directory of files doesn't reallocate them for each one.
+    thread_local std::string jsonString;
+    thread_local Rebuilt rebuilt;
+    jsonString.clear();
+    rebuilt.clear();
+
+    switch (type)
+    {
+    case ResourceType::CLNG:
+        result.converted = CLNG::ConvertInto(jsonString, version, data, metaJson, options.langMap);
+        result.rebuilt = result.converted && CLNG::RebuildInto(rebuilt, jsonString);
+        break;
+    case ResourceType::DITL:
+        result.converted = DITL::ConvertInto(jsonString, data, metaJson, hashList);
+        result.rebuilt = result.converted && DITL::RebuildInto(rebuilt, jsonString, hashList);
+        break;
+    case ResourceType::DLGE:
+        result.converted = DLGE::ConvertInto(jsonString, version, data, metaJson, options.defaultLocale, true, options.langMap, hashList);
+        result.rebuilt = result.converted && DLGE::RebuildInto(rebuilt, version, jsonString, options.defaultLocale, options.langMap, hashList);
+        break;
+    case ResourceType::LOCR:
+        result.converted = LOCR::ConvertInto(jsonString, version, data, metaJson, options.langMap, options.symmetric, hashList);
+        result.rebuilt = result.converted && LOCR::RebuildInto(rebuilt, version, jsonString, options.symmetric, hashList);
+        break;
+    case ResourceType::RTLV:
+        result.converted = RTLV::ConvertInto(jsonString, version, data, metaJson);
+        result.rebuilt = result.converted && RTLV::RebuildInto(rebuilt, version, jsonString, options.langMap);
+        break;
+    }
+
+    // Some of the RebuildInto functions can fail without saying so, they leave the output empty.
+    result.rebuilt = result.rebuilt && !rebuilt.file.empty() && !rebuilt.meta.empty();
+    if (!result.rebuilt)
+        return false;
+
+    result.rebuiltSize = rebuilt.file.size();
+    size_t common = std::min(data.size(), rebuilt.file.size());
+    for (size_t i = 0; i < common; i++)
+    {
+        if (data[i] != rebuilt.file[i])
         {
-            fprintf(stderr, "[LANG//DLGE] Failed to process containers!\n");
-            return {};
+            if (result.firstDifference == SIZE_MAX)
+                result.firstDifference = i;
+            result.differentBytes++;
         }
+    }
 
-        out.file = buff.data();
-        out.meta = generateMeta(jSrc.at("hash"), out.file.size(), "DLGE", depends);
+    if (result.firstDifference == SIZE_MAX && data.size() != rebuilt.file.size())
+        result.firstDifference = common;
+
+    try
+    {
+        json original = json::parse(metaJson);
+        json rebuiltMeta = json::parse(rebuilt.meta);
 
-        return out;
+        result.hashMatches = metaResourceID(original.at("hash_value")) == metaResourceID(rebuiltMeta.at("hash_value"));
+
+        const json &originalDepends = original.at("hash_reference_data");
+        const json &rebuiltDepends = rebuiltMeta.at("hash_reference_data");
+        result.originalReferences = originalDepends.size();
+        result.rebuiltReferences = rebuiltDepends.size();
+
+        for (size_t i = 0; i < std::max(originalDepends.size(), rebuiltDepends.size()); i++)
+        {
+            if (i >= originalDepends.size() || i >= rebuiltDepends.size()
+                || metaResourceID(originalDepends[i].at("hash")) != metaResourceID(rebuiltDepends[i].at("hash"))
+                || toUpperHex(jsonStringRef(originalDepends[i].at("flag"))) != toUpperHex(jsonStringRef(rebuiltDepends[i].at("flag"))))
+            {
+                result.firstReferenceDifference = i;
+                break;
+            }
+        }
     }
     catch (const json::exception& err)
     {
-        fprintf(stderr, "[LANG//DLGE] JSON error:\n"
+        fprintf(stderr, "[LANG//VERIFY] JSON error:\n"
                         "\t%s\n", err.what());
+        result.hashMatches = false;
+        result.firstReferenceDifference = 0;
     }
 
-    return {};
+    return result.Matches();
 }
 #pragma endregion
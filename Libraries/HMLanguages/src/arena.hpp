@@ -0,0 +1,224 @@
+/**
+ * @file arena.hpp
+ * @brief The JSON type used inside the library, with its DOM nodes allocated from a per-call arena.
+ *
+ * DLGE's Convert and Rebuild open a JsonScope before building any JSON. While one is open, every object, array and
+ * node cell allocated on that thread comes from one monotonic arena, which is released in one go when the outermost
+ * scope closes instead of each node being freed on its own. Only buffers too big for it (the arrays of very long
+ * lists) are allocated as usual. Outside of a scope the global allocator is used: LOCR and DITL stream their JSON,
+ * and CLNG and RTLV DOMs are a handful of strings, so a scope would only cost them.
+ *
+ * Strings (and so object keys) still use the global allocator, they are std::string everywhere else in the library.
+ * Every JSON value allocated in a scope has to be destroyed before the scope is, so scopes come before the JSON locals
+ * and there are no static ones.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+class JsonArena
+{
+public:
+    JsonArena() = default;
+    ~JsonArena() { release(false); }
+
+    JsonArena(const JsonArena &) = delete;
+    JsonArena &operator=(const JsonArena &) = delete;
+
+    // Every allocation is rounded up to (and aligned to) this, which is enough for anything a JSON node needs.
+    static constexpr size_t granule = 8;
+
+    // Null if the size is too big for the arena, the caller allocates it itself then.
+    void* allocate(size_t size)
+    {
+        size = roundUp(size);
+        if (size > maxSize)
+            return nullptr;
+
+        size_t sizeClass = size / granule;
+        if (freeBuffers[sizeClass])
+        {
+            FreeBuffer* buffer = freeBuffers[sizeClass];
+            freeBuffers[sizeClass] = buffer->next;
+            return buffer;
+        }
+
+        // Blocks come from operator new, and every size is a multiple of the granule, so used stays aligned.
+        if (blocks.empty() || used + size > blockSize)
+        {
+            grow();
+            used = 0;
+        }
+
+        void* ptr = blocks.back() + used;
+        used += size;
+        return ptr;
+    }
+
+    // Keeps a buffer given back to the arena (i.e. by a vector that grew) for the next allocation of its size,
+    // otherwise every buffer a vector grows out of would add to the peak.
+    void recycle(void* ptr, size_t size)
+    {
+        size_t sizeClass = roundUp(size) / granule;
+        freeBuffers[sizeClass] = new (ptr) FreeBuffer{freeBuffers[sizeClass]};
+    }
+
+    bool owns(const void* ptr) const
+    {
+        if (blocks.empty())
+            return false;
+
+        // The newest block is where most frees are from (a vector growing), the rest are found by address.
+        if (inBlock(blocks.back(), ptr))
+            return true;
+
+        auto next = std::upper_bound(sortedBlocks.begin(), sortedBlocks.end(), ptr, std::less<const void*>());
+        return next != sortedBlocks.begin() && inBlock(*(next - 1), ptr);
+    }
+
+    // Frees everything, one block is kept for the next call on this thread if keepBlock is set.
+    void release(bool keepBlock)
+    {
+        size_t keep = keepBlock && !blocks.empty() ? 1 : 0;
+        for (size_t i = keep; i < blocks.size(); i++)
+            ::operator delete(blocks[i]);
+
+        blocks.resize(keep);
+        sortedBlocks = blocks;
+        freeBuffers.fill(nullptr);
+        used = 0;
+    }
+
+    // The arena of the scope open on this thread, null if there isn't one.
+    static JsonArena* current() { return active; }
+
+private:
+    friend class JsonScope;
+
+    struct FreeBuffer
+    {
+        FreeBuffer* next;
+    };
+
+    // Blocks are kept under glibc's default mmap threshold (128 KB), so they come from (and go back to) the heap like
+    // the nodes they replace. Freeing mmapped blocks would raise the threshold for everything allocated after.
+    static constexpr size_t blockSize = 64 * 1024;
+
+    // Buffers up to 4 KB come from the arena, bigger ones are only the arrays of very long lists.
+    static constexpr size_t maxSize = 4096;
+    static constexpr size_t sizeClasses = maxSize / granule + 1;
+
+    static inline constinit thread_local JsonArena* active = nullptr;
+
+    // In the order they were allocated, the last one is being allocated from.
+    std::vector<char*> blocks;
+    // The same blocks, sorted by address for owns().
+    std::vector<char*> sortedBlocks;
+    size_t used = 0;
+    std::array<FreeBuffer*, sizeClasses> freeBuffers{};
+
+    static size_t roundUp(size_t size) { return std::max(granule, (size + granule - 1) & ~(granule - 1)); }
+
+    static bool inBlock(const char* block, const void* ptr)
+    {
+        return std::less_equal<const void*>()(block, ptr) && std::less<const void*>()(ptr, block + blockSize);
+    }
+
+    void grow()
+    {
+        char* block = static_cast<char*>(::operator new(blockSize));
+        blocks.push_back(block);
+        sortedBlocks.insert(std::upper_bound(sortedBlocks.begin(), sortedBlocks.end(), block, std::less<const void*>()), block);
+    }
+};
+
+/**
+ * @brief Allocates the JSON of the calls on this thread from its arena until destroyed.
+ *
+ * A scope inside another one uses the outer scope's arena, so everything is released together.
+ */
+class JsonScope
+{
+public:
+    JsonScope() : outer(JsonArena::active != nullptr)
+    {
+        if (!outer)
+            JsonArena::active = &arena();
+    }
+
+    ~JsonScope()
+    {
+        if (outer)
+            return;
+
+        JsonArena::active = nullptr;
+        arena().release(true);
+    }
+
+    JsonScope(const JsonScope &) = delete;
+    JsonScope &operator=(const JsonScope &) = delete;
+
+private:
+    bool outer;
+
+    static JsonArena &arena()
+    {
+        thread_local JsonArena threadArena;
+        return threadArena;
+    }
+};
+
+template <typename T>
+struct ArenaAllocator
+{
+    using value_type = T;
+
+    ArenaAllocator() = default;
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &) {}
+
+    T* allocate(size_t count)
+    {
+        static_assert(alignof(T) <= JsonArena::granule);
+
+        if (JsonArena* arena = JsonArena::current())
+        {
+            if (void* ptr = arena->allocate(count * sizeof(T)))
+                return static_cast<T*>(ptr);
+        }
+
+        return std::allocator<T>().allocate(count);
+    }
+
+    // Memory from the arena goes back to it (and is freed along with it), anything allocated before the scope opened
+    // or too big for the arena is freed as usual.
+    void deallocate(T* ptr, size_t count)
+    {
+        JsonArena* arena = JsonArena::current();
+        if (arena && arena->owns(ptr))
+        {
+            arena->recycle(ptr, count * sizeof(T));
+            return;
+        }
+
+        std::allocator<T>().deallocate(ptr, count);
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &) const { return true; }
+};
+
+// nlohmann::ordered_json, on the arena.
+using json = nlohmann::basic_json<nlohmann::ordered_map, std::vector, std::string, bool, std::int64_t, std::uint64_t, double, ArenaAllocator>;
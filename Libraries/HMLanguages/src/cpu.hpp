@@ -0,0 +1,93 @@
+/**
+ * @file cpu.hpp
+ * @brief Runtime detection of the x86 instruction set extensions used by the SIMD kernels.
+ *
+ * Kernels that use anything above SSE2 are compiled with HMLANG_TARGET so the rest of the
+ * library can still be built for the baseline ISA, and are only called if cpu() says so.
+ */
+
+#pragma once
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define HMLANG_X86 1
+#else
+#define HMLANG_X86 0
+#endif
+
+#if HMLANG_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define HMLANG_TARGET(x) __attribute__((target(x)))
+#else
+// MSVC allows any intrinsic regardless of /arch.
+#define HMLANG_TARGET(x)
+#endif
+
+struct CpuFeatures
+{
+    bool sse2 = false;
+    bool ssse3 = false;
+    bool avx2 = false;
+    bool avx512 = false;
+};
+
+inline CpuFeatures detectCpuFeatures()
+{
+    CpuFeatures features{};
+
+#if HMLANG_X86
+    unsigned int regs[4] = {};
+
+    auto cpuid = [&regs](unsigned int leaf, unsigned int subleaf) {
+#if defined(_MSC_VER)
+        __cpuidex((int*)regs, leaf, subleaf);
+#else
+        __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    };
+
+    cpuid(0, 0);
+    unsigned int maxLeaf = regs[0];
+    if (maxLeaf < 1)
+        return features;
+
+    cpuid(1, 0);
+    features.sse2 = regs[3] & (1 << 26);
+    features.ssse3 = regs[2] & (1 << 9);
+
+    // AVX state has to be enabled by the OS as well (OSXSAVE + XCR0), not just supported by the CPU.
+    bool osxsave = regs[2] & (1 << 27);
+    if (!osxsave || maxLeaf < 7)
+        return features;
+
+#if defined(_MSC_VER)
+    unsigned long long xcr0 = _xgetbv(0);
+#else
+    unsigned int xcr0Lo, xcr0Hi;
+    __asm__("xgetbv" : "=a"(xcr0Lo), "=d"(xcr0Hi) : "c"(0));
+    unsigned long long xcr0 = ((unsigned long long)xcr0Hi << 32) | xcr0Lo;
+#endif
+
+    bool avxState = (xcr0 & 0x06) == 0x06;
+    bool avx512State = (xcr0 & 0xE6) == 0xE6;
+
+    cpuid(7, 0);
+    features.avx2 = avxState && (regs[1] & (1 << 5));
+    features.avx512 = avx512State && (regs[1] & (1 << 16));
+#endif
+
+    return features;
+}
+
+inline const CpuFeatures &cpu()
+{
+    static const CpuFeatures features = detectCpuFeatures();
+    return features;
+}
@@ -0,0 +1,532 @@
+#include "crypto.hpp"
+#include "cpu.hpp"
+
+#include <cstring>
+
+namespace
+{
+    constexpr uint32_t xteaKeys[4] = {0x53527737, 0x7506499E, 0xBD39AEE3, 0xA59E7268};
+    constexpr uint32_t xteaDelta = 0x9E3779B9;
+    constexpr uint32_t xteaRounds = 32;
+
+    // The key schedule is the same for every block, so "sum + key[...]" is precomputed for every round.
+    // even[n] is used with the (sum & 3) key index and odd[n] with (sum >> 11 & 3), where sum = delta * n.
+    struct XteaSchedule
+    {
+        uint32_t even[xteaRounds + 1];
+        uint32_t odd[xteaRounds + 1];
+    };
+
+    constexpr XteaSchedule makeSchedule()
+    {
+        XteaSchedule schedule{};
+
+        for (uint32_t n = 0; n <= xteaRounds; n++)
+        {
+            uint32_t sum = xteaDelta * n;
+            schedule.even[n] = sum + xteaKeys[sum & 3];
+            schedule.odd[n] = sum + xteaKeys[sum >> 11 & 3];
+        }
+
+        return schedule;
+    }
+
+    constexpr XteaSchedule schedule = makeSchedule();
+
+    inline uint32_t mix(uint32_t v)
+    {
+        return ((v << 4) ^ (v >> 5)) + v;
+    }
+
+    void decryptLanesScalar(uint32_t* v0, uint32_t* v1, size_t n)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            uint32_t a = v0[i];
+            uint32_t b = v1[i];
+
+            for (uint32_t j = 0; j < xteaRounds; j++)
+            {
+                b -= mix(a) ^ schedule.odd[xteaRounds - j];
+                a -= mix(b) ^ schedule.even[xteaRounds - 1 - j];
+            }
+
+            v0[i] = a;
+            v1[i] = b;
+        }
+    }
+
+    void encryptLanesScalar(uint32_t* v0, uint32_t* v1, size_t n)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            uint32_t a = v0[i];
+            uint32_t b = v1[i];
+
+            for (uint32_t j = 0; j < xteaRounds; j++)
+            {
+                a += mix(b) ^ schedule.even[j];
+                b += mix(a) ^ schedule.odd[j + 1];
+            }
+
+            v0[i] = a;
+            v1[i] = b;
+        }
+    }
+
+#if HMLANG_X86
+    // Each kernel works on two registers at a time, XTEA rounds are one long dependency chain
+    // so interleaving two independent chains keeps the pipeline busy.
+
+#define XTEA_MIX_128(v) _mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(v, 4), _mm_srli_epi32(v, 5)), v)
+
+    HMLANG_TARGET("sse2")
+    void decryptLanesSSE2(uint32_t* v0, uint32_t* v1, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            __m128i a0 = _mm_loadu_si128((const __m128i*)(v0 + i));
+            __m128i a1 = _mm_loadu_si128((const __m128i*)(v0 + i + 4));
+            __m128i b0 = _mm_loadu_si128((const __m128i*)(v1 + i));
+            __m128i b1 = _mm_loadu_si128((const __m128i*)(v1 + i + 4));
+
+            for (uint32_t j = 0; j < xteaRounds; j++)
+            {
+                __m128i k = _mm_set1_epi32(schedule.odd[xteaRounds - j]);
+                b0 = _mm_sub_epi32(b0, _mm_xor_si128(XTEA_MIX_128(a0), k));
+                b1 = _mm_sub_epi32(b1, _mm_xor_si128(XTEA_MIX_128(a1), k));
+
+                k = _mm_set1_epi32(schedule.even[xteaRounds - 1 - j]);
+                a0 = _mm_sub_epi32(a0, _mm_xor_si128(XTEA_MIX_128(b0), k));
+                a1 = _mm_sub_epi32(a1, _mm_xor_si128(XTEA_MIX_128(b1), k));
+            }
+
+            _mm_storeu_si128((__m128i*)(v0 + i), a0);
+            _mm_storeu_si128((__m128i*)(v0 + i + 4), a1);
+            _mm_storeu_si128((__m128i*)(v1 + i), b0);
+            _mm_storeu_si128((__m128i*)(v1 + i + 4), b1);
+        }
+
+        decryptLanesScalar(v0 + i, v1 + i, n - i);
+    }
+
+    HMLANG_TARGET("sse2")
+    void encryptLanesSSE2(uint32_t* v0, uint32_t* v1, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            __m128i a0 = _mm_loadu_si128((const __m128i*)(v0 + i));
+            __m128i a1 = _mm_loadu_si128((const __m128i*)(v0 + i + 4));
+            __m128i b0 = _mm_loadu_si128((const __m128i*)(v1 + i));
+            __m128i b1 = _mm_loadu_si128((const __m128i*)(v1 + i + 4));
+
+            for (uint32_t j = 0; j < xteaRounds; j++)
+            {
+                __m128i k = _mm_set1_epi32(schedule.even[j]);
+                a0 = _mm_add_epi32(a0, _mm_xor_si128(XTEA_MIX_128(b0), k));
+                a1 = _mm_add_epi32(a1, _mm_xor_si128(XTEA_MIX_128(b1), k));
+
+                k = _mm_set1_epi32(schedule.odd[j + 1]);
+                b0 = _mm_add_epi32(b0, _mm_xor_si128(XTEA_MIX_128(a0), k));
+                b1 = _mm_add_epi32(b1, _mm_xor_si128(XTEA_MIX_128(a1), k));
+            }
+
+            _mm_storeu_si128((__m128i*)(v0 + i), a0);
+            _mm_storeu_si128((__m128i*)(v0 + i + 4), a1);
+            _mm_storeu_si128((__m128i*)(v1 + i), b0);
+            _mm_storeu_si128((__m128i*)(v1 + i + 4), b1);
+        }
+
+        encryptLanesScalar(v0 + i, v1 + i, n - i);
+    }
+
+#define XTEA_MIX_256(v) _mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(v, 4), _mm256_srli_epi32(v, 5)), v)
+
+    HMLANG_TARGET("avx2")
+    void decryptLanesAVX2(uint32_t* v0, uint32_t* v1, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            __m256i a0 = _mm256_loadu_si256((const __m256i*)(v0 + i));
+            __m256i a1 = _mm256_loadu_si256((const __m256i*)(v0 + i + 8));
+            __m256i b0 = _mm256_loadu_si256((const __m256i*)(v1 + i));
+            __m256i b1 = _mm256_loadu_si256((const __m256i*)(v1 + i + 8));
+
+            for (uint32_t j = 0; j < xteaRounds; j++)
+            {
+                __m256i k = _mm256_set1_epi32(schedule.odd[xteaRounds - j]);
+                b0 = _mm256_sub_epi32(b0, _mm256_xor_si256(XTEA_MIX_256(a0), k));
+                b1 = _mm256_sub_epi32(b1, _mm256_xor_si256(XTEA_MIX_256(a1), k));
+
+                k = _mm256_set1_epi32(schedule.even[xteaRounds - 1 - j]);
+                a0 = _mm256_sub_epi32(a0, _mm256_xor_si256(XTEA_MIX_256(b0), k));
+                a1 = _mm256_sub_epi32(a1, _mm256_xor_si256(XTEA_MIX_256(b1), k));
+            }
+
+            _mm256_storeu_si256((__m256i*)(v0 + i), a0);
+            _mm256_storeu_si256((__m256i*)(v0 + i + 8), a1);
+            _mm256_storeu_si256((__m256i*)(v1 + i), b0);
+            _mm256_storeu_si256((__m256i*)(v1 + i + 8), b1);
+        }
+
+        decryptLanesSSE2(v0 + i, v1 + i, n - i);
+    }
+
+    HMLANG_TARGET("avx2")
+    void encryptLanesAVX2(uint32_t* v0, uint32_t* v1, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            __m256i a0 = _mm256_loadu_si256((const __m256i*)(v0 + i));
+            __m256i a1 = _mm256_loadu_si256((const __m256i*)(v0 + i + 8));
+            __m256i b0 = _mm256_loadu_si256((const __m256i*)(v1 + i));
+            __m256i b1 = _mm256_loadu_si256((const __m256i*)(v1 + i + 8));
+
+            for (uint32_t j = 0; j < xteaRounds; j++)
+            {
+                __m256i k = _mm256_set1_epi32(schedule.even[j]);
+                a0 = _mm256_add_epi32(a0, _mm256_xor_si256(XTEA_MIX_256(b0), k));
+                a1 = _mm256_add_epi32(a1, _mm256_xor_si256(XTEA_MIX_256(b1), k));
+
+                k = _mm256_set1_epi32(schedule.odd[j + 1]);
+                b0 = _mm256_add_epi32(b0, _mm256_xor_si256(XTEA_MIX_256(a0), k));
+                b1 = _mm256_add_epi32(b1, _mm256_xor_si256(XTEA_MIX_256(a1), k));
+            }
+
+            _mm256_storeu_si256((__m256i*)(v0 + i), a0);
+            _mm256_storeu_si256((__m256i*)(v0 + i + 8), a1);
+            _mm256_storeu_si256((__m256i*)(v1 + i), b0);
+            _mm256_storeu_si256((__m256i*)(v1 + i + 8), b1);
+        }
+
+        encryptLanesSSE2(v0 + i, v1 + i, n - i);
+    }
+
+#define XTEA_MIX_512(v) _mm512_add_epi32(_mm512_xor_si512(_mm512_slli_epi32(v, 4), _mm512_srli_epi32(v, 5)), v)
+
+    HMLANG_TARGET("avx512f")
+    void decryptLanesAVX512(uint32_t* v0, uint32_t* v1, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 32 <= n; i += 32)
+        {
+            __m512i a0 = _mm512_loadu_si512(v0 + i);
+            __m512i a1 = _mm512_loadu_si512(v0 + i + 16);
+            __m512i b0 = _mm512_loadu_si512(v1 + i);
+            __m512i b1 = _mm512_loadu_si512(v1 + i + 16);
+
+            for (uint32_t j = 0; j < xteaRounds; j++)
+            {
+                __m512i k = _mm512_set1_epi32(schedule.odd[xteaRounds - j]);
+                b0 = _mm512_sub_epi32(b0, _mm512_xor_si512(XTEA_MIX_512(a0), k));
+                b1 = _mm512_sub_epi32(b1, _mm512_xor_si512(XTEA_MIX_512(a1), k));
+
+                k = _mm512_set1_epi32(schedule.even[xteaRounds - 1 - j]);
+                a0 = _mm512_sub_epi32(a0, _mm512_xor_si512(XTEA_MIX_512(b0), k));
+                a1 = _mm512_sub_epi32(a1, _mm512_xor_si512(XTEA_MIX_512(b1), k));
+            }
+
+            _mm512_storeu_si512(v0 + i, a0);
+            _mm512_storeu_si512(v0 + i + 16, a1);
+            _mm512_storeu_si512(v1 + i, b0);
+            _mm512_storeu_si512(v1 + i + 16, b1);
+        }
+
+        decryptLanesAVX2(v0 + i, v1 + i, n - i);
+    }
+
+    HMLANG_TARGET("avx512f")
+    void encryptLanesAVX512(uint32_t* v0, uint32_t* v1, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 32 <= n; i += 32)
+        {
+            __m512i a0 = _mm512_loadu_si512(v0 + i);
+            __m512i a1 = _mm512_loadu_si512(v0 + i + 16);
+            __m512i b0 = _mm512_loadu_si512(v1 + i);
+            __m512i b1 = _mm512_loadu_si512(v1 + i + 16);
+
+            for (uint32_t j = 0; j < xteaRounds; j++)
+            {
+                __m512i k = _mm512_set1_epi32(schedule.even[j]);
+                a0 = _mm512_add_epi32(a0, _mm512_xor_si512(XTEA_MIX_512(b0), k));
+                a1 = _mm512_add_epi32(a1, _mm512_xor_si512(XTEA_MIX_512(b1), k));
+
+                k = _mm512_set1_epi32(schedule.odd[j + 1]);
+                b0 = _mm512_add_epi32(b0, _mm512_xor_si512(XTEA_MIX_512(a0), k));
+                b1 = _mm512_add_epi32(b1, _mm512_xor_si512(XTEA_MIX_512(a1), k));
+            }
+
+            _mm512_storeu_si512(v0 + i, a0);
+            _mm512_storeu_si512(v0 + i + 16, a1);
+            _mm512_storeu_si512(v1 + i, b0);
+            _mm512_storeu_si512(v1 + i + 16, b1);
+        }
+
+        encryptLanesAVX2(v0 + i, v1 + i, n - i);
+    }
+#endif
+
+    using LaneKernel = void (*)(uint32_t* v0, uint32_t* v1, size_t n);
+
+    struct XteaKernels
+    {
+        LaneKernel decrypt;
+        LaneKernel encrypt;
+        const char* name;
+    };
+
+    XteaKernels selectKernels()
+    {
+#if HMLANG_X86
+        if (cpu().avx512)
+            return {decryptLanesAVX512, encryptLanesAVX512, "AVX-512"};
+        if (cpu().avx2)
+            return {decryptLanesAVX2, encryptLanesAVX2, "AVX2"};
+        if (cpu().sse2)
+            return {decryptLanesSSE2, encryptLanesSSE2, "SSE2"};
+#endif
+        return {decryptLanesScalar, encryptLanesScalar, "Scalar"};
+    }
+
+    const XteaKernels &kernels()
+    {
+        static const XteaKernels selected = selectKernels();
+        return selected;
+    }
+
+    // The symmetric cipher is a fixed bit permutation plus an XOR, so it is just a byte substitution.
+    constexpr uint8_t symmetricDecryptByte(uint8_t value)
+    {
+        value = (value & 1) | (value & 2) << 3 | (value & 4) >> 1 | (value & 8) << 2 | (value & 16) >> 2 | (value & 32) << 1 |
+            (value & 64) >> 3 | (value & 128);
+
+        return value ^ 226;
+    }
+
+    constexpr uint8_t symmetricEncryptByte(uint8_t value)
+    {
+        value ^= 226;
+
+        return (value & 0x81) | (value & 2) << 1 | (value & 4) << 2 | (value & 8) << 3 | (value & 0x10) >> 3 |
+            (value & 0x20) >> 2 | (value & 0x40) >> 1;
+    }
+
+    struct SymmetricTables
+    {
+        uint8_t full[256];
+
+        // As the map is affine, f(x) = lo[x & 0xF] ^ hi[x >> 4], which is what the pshufb kernels use.
+        uint8_t lo[16];
+        uint8_t hi[16];
+    };
+
+    template <uint8_t (*Fn)(uint8_t)>
+    constexpr SymmetricTables makeSymmetricTables()
+    {
+        SymmetricTables tables{};
+
+        for (uint32_t i = 0; i < 256; i++)
+            tables.full[i] = Fn((uint8_t)i);
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            tables.lo[i] = tables.full[i];
+            tables.hi[i] = tables.full[i << 4] ^ tables.full[0];
+        }
+
+        return tables;
+    }
+
+    constexpr SymmetricTables symmetricDecryptTables = makeSymmetricTables<symmetricDecryptByte>();
+    constexpr SymmetricTables symmetricEncryptTables = makeSymmetricTables<symmetricEncryptByte>();
+
+    void symmetricTable(const SymmetricTables &tables, char* data, size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+            data[i] = (char)tables.full[(uint8_t)data[i]];
+    }
+
+#if HMLANG_X86
+    HMLANG_TARGET("ssse3")
+    void symmetricSSSE3(const SymmetricTables &tables, char* data, size_t size)
+    {
+        const __m128i lo = _mm_loadu_si128((const __m128i*)tables.lo);
+        const __m128i hi = _mm_loadu_si128((const __m128i*)tables.hi);
+        const __m128i mask = _mm_set1_epi8(0x0F);
+
+        size_t i = 0;
+        for (; i + 16 <= size; i += 16)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(data + i));
+            __m128i vlo = _mm_and_si128(v, mask);
+            __m128i vhi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+
+            v = _mm_xor_si128(_mm_shuffle_epi8(lo, vlo), _mm_shuffle_epi8(hi, vhi));
+            _mm_storeu_si128((__m128i*)(data + i), v);
+        }
+
+        // Most LOCR strings are short, so the tail goes through a stack block rather than byte by byte.
+        if (i < size)
+        {
+            char tail[16] = {};
+            std::memcpy(tail, data + i, size - i);
+
+            __m128i v = _mm_loadu_si128((const __m128i*)tail);
+            __m128i vlo = _mm_and_si128(v, mask);
+            __m128i vhi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+
+            v = _mm_xor_si128(_mm_shuffle_epi8(lo, vlo), _mm_shuffle_epi8(hi, vhi));
+            _mm_storeu_si128((__m128i*)tail, v);
+            std::memcpy(data + i, tail, size - i);
+        }
+    }
+
+    HMLANG_TARGET("avx2")
+    void symmetricAVX2(const SymmetricTables &tables, char* data, size_t size)
+    {
+        const __m256i lo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)tables.lo));
+        const __m256i hi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)tables.hi));
+        const __m256i mask = _mm256_set1_epi8(0x0F);
+
+        size_t i = 0;
+        for (; i + 32 <= size; i += 32)
+        {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(data + i));
+            __m256i vlo = _mm256_and_si256(v, mask);
+            __m256i vhi = _mm256_and_si256(_mm256_srli_epi16(v, 4), mask);
+
+            v = _mm256_xor_si256(_mm256_shuffle_epi8(lo, vlo), _mm256_shuffle_epi8(hi, vhi));
+            _mm256_storeu_si256((__m256i*)(data + i), v);
+        }
+
+        symmetricSSSE3(tables, data + i, size - i);
+    }
+#endif
+
+    using SymmetricKernel = void (*)(const SymmetricTables &tables, char* data, size_t size);
+
+    struct SymmetricKernelInfo
+    {
+        SymmetricKernel kernel;
+        const char* name;
+    };
+
+    SymmetricKernelInfo selectSymmetricKernel()
+    {
+#if HMLANG_X86
+        if (cpu().avx2)
+            return {symmetricAVX2, "AVX2"};
+        if (cpu().ssse3)
+            return {symmetricSSSE3, "SSSE3"};
+#endif
+        return {symmetricTable, "Table"};
+    }
+
+    const SymmetricKernelInfo &symmetricKernel()
+    {
+        static const SymmetricKernelInfo selected = selectSymmetricKernel();
+        return selected;
+    }
+
+    template <typename Kernel>
+    void processInPlace(char* data, size_t size, Kernel kernel)
+    {
+        for (size_t i = 0; i < size / 8; i++)
+        {
+            uint32_t v0, v1;
+            std::memcpy(&v0, data + (i * 8), 4);
+            std::memcpy(&v1, data + (i * 8) + 4, 4);
+
+            kernel(&v0, &v1, 1);
+
+            std::memcpy(data + (i * 8), &v0, 4);
+            std::memcpy(data + (i * 8) + 4, &v1, 4);
+        }
+    }
+} // namespace
+
+void xteaDecryptInPlace(char* data, size_t size)
+{
+    processInPlace(data, size, decryptLanesScalar);
+}
+
+void xteaEncryptInPlace(char* data, size_t size)
+{
+    processInPlace(data, size, encryptLanesScalar);
+}
+
+const char* xteaKernelName()
+{
+    return kernels().name;
+}
+
+void XteaBatch::gather(const char* base)
+{
+    v0.resize(blockCount);
+    v1.resize(blockCount);
+
+    size_t lane = 0;
+    for (const auto &[offset, size] : spans)
+    {
+        const char* block = base + offset;
+        for (size_t i = 0; i < size / 8; i++, lane++, block += 8)
+        {
+            std::memcpy(&v0[lane], block, 4);
+            std::memcpy(&v1[lane], block + 4, 4);
+        }
+    }
+}
+
+void XteaBatch::scatter(char* base) const
+{
+    size_t lane = 0;
+    for (const auto &[offset, size] : spans)
+    {
+        char* block = base + offset;
+        for (size_t i = 0; i < size / 8; i++, lane++, block += 8)
+        {
+            std::memcpy(block, &v0[lane], 4);
+            std::memcpy(block + 4, &v1[lane], 4);
+        }
+    }
+}
+
+void XteaBatch::decrypt(char* base)
+{
+    if (!blockCount)
+        return;
+
+    gather(base);
+    kernels().decrypt(v0.data(), v1.data(), blockCount);
+    scatter(base);
+}
+
+void XteaBatch::encrypt(char* base)
+{
+    if (!blockCount)
+        return;
+
+    gather(base);
+    kernels().encrypt(v0.data(), v1.data(), blockCount);
+    scatter(base);
+}
+
+void symmetricDecryptInPlace(char* data, size_t size)
+{
+    symmetricKernel().kernel(symmetricDecryptTables, data, size);
+}
+
+void symmetricEncryptInPlace(char* data, size_t size)
+{
+    symmetricKernel().kernel(symmetricEncryptTables, data, size);
+}
+
+const char* symmetricKernelName()
+{
+    return symmetricKernel().name;
+}
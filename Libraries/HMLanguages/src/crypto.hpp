@@ -0,0 +1,106 @@
+/**
+ * @file crypto.hpp
+ * @brief String ciphers used by the language formats (XTEA for LOCR/DLGE, symmetric for early H2016 LOCR).
+ *
+ * Based on https://github.com/glacier-modding/RPKG-Tool/blob/145d8d7d9711d57f1434489706c3d81b2feeed73/src/crypto.cpp#L3-L41
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Decrypts whole 8-byte XTEA blocks in place, any trailing partial block is left untouched.
+ */
+void xteaDecryptInPlace(char* data, size_t size);
+
+/**
+ * @brief Encrypts whole 8-byte XTEA blocks in place, any trailing partial block is left untouched.
+ */
+void xteaEncryptInPlace(char* data, size_t size);
+
+/**
+ * @brief Size of a string once padded to the XTEA block size.
+ */
+inline size_t xteaPaddedSize(size_t size)
+{
+    return size + (size % 8 == 0 ? 0 : 8 - (size % 8));
+}
+
+/**
+ * @brief Collects XTEA ciphertext/plaintext spans of a file and processes them all at once.
+ *
+ * Every block uses the same key and schedule, so the blocks of all spans are staged into
+ * lanes and run through the widest SIMD kernel the CPU supports. Spans are stored as offsets
+ * so the underlying buffer is free to grow between add() and decrypt()/encrypt().
+ */
+class XteaBatch
+{
+public:
+    void add(size_t offset, size_t size)
+    {
+        if (size < 8)
+            return;
+
+        spans.emplace_back(offset, size);
+        blockCount += size / 8;
+    }
+
+    void decrypt(char* base);
+    void encrypt(char* base);
+
+    void clear()
+    {
+        spans.clear();
+        blockCount = 0;
+    }
+
+    size_t blocks() const { return blockCount; }
+
+private:
+    std::vector<std::pair<size_t, size_t>> spans;
+    size_t blockCount = 0;
+
+    // Staging lanes, kept around so repeated batches don't reallocate.
+    std::vector<uint32_t> v0;
+    std::vector<uint32_t> v1;
+
+    void gather(const char* base);
+    void scatter(char* base) const;
+};
+
+/**
+ * @brief Turns a decrypted span back into a string, stopping at the first null (padding).
+ */
+inline std::string_view xteaPlaintext(const char* data, size_t size)
+{
+    std::string_view str(data, size);
+    size_t end = str.find('\0');
+
+    return end == std::string_view::npos ? str : str.substr(0, end);
+}
+
+/**
+ * @brief Name of the XTEA kernel the batch engine dispatches to on this CPU.
+ */
+const char* xteaKernelName();
+
+/**
+ * @brief Decrypts early H2016 LOCR strings in place (bit permutation followed by an XOR with 226).
+ */
+void symmetricDecryptInPlace(char* data, size_t size);
+
+/**
+ * @brief Encrypts early H2016 LOCR strings in place (XOR with 226 followed by a bit permutation).
+ */
+void symmetricEncryptInPlace(char* data, size_t size);
+
+/**
+ * @brief Name of the symmetric cipher kernel dispatched to on this CPU.
+ */
+const char* symmetricKernelName();
@@ -0,0 +1,96 @@
+/**
+ * @file games.hpp
+ * @brief Compile-time description of how each game lays out the language formats.
+ *
+ * The codecs are templated on a Game so every per-string and per-language difference between the
+ * games is resolved at compile time, the runtime Version is only looked at once by dispatch().
+ */
+
+#pragma once
+
+#include <array>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "TonyTools/Languages.h"
+
+using TonyTools::Language::Version;
+
+// The default language maps, used when no langmap is given.
+inline constexpr std::array<std::string_view, 13> H2Languages = {"xx", "en", "fr", "it", "de", "es", "ru", "mx", "br", "pl", "cn", "jp", "tc"};
+inline constexpr std::array<std::string_view, 10> H3Languages = {"xx", "en", "fr", "it", "de", "es", "ru", "cn", "tc", "jp"};
+
+template <Version V>
+struct Game
+{
+    static constexpr Version version = V;
+
+    // LOCR v2 (H2 onwards) has an extra byte before the language offsets.
+    static constexpr bool locrV2 = V != Version::H2016;
+
+    // Only some H2016 LOCRs use the symmetric cipher, every other LOCR is XTEA.
+    static constexpr bool symmetricLOCR = V == Version::H2016;
+
+    // H2016 WavFiles have their unknown uint32 at the start of every language rather than once after the wav name.
+    static constexpr bool dlgeValuePerLanguage = V == Version::H2016;
+
+    // H2016 and H2 share a langmap, H3 has its own.
+    static constexpr std::span<const std::string_view> languages = V == Version::H3
+        ? std::span<const std::string_view>(H3Languages)
+        : std::span<const std::string_view>(H2Languages);
+
+    // Late versions of H2016 share the same DLGE langmap as H2, but without tc.
+    static constexpr std::span<const std::string_view> dlgeLanguages = V == Version::H2016
+        ? languages.first(languages.size() - 1)
+        : languages;
+
+    // The built-in maps as the vectors the codecs work with, only built once.
+    static const std::vector<std::string> &languageList()
+    {
+        static const std::vector<std::string> list(languages.begin(), languages.end());
+        return list;
+    }
+
+    static const std::vector<std::string> &dlgeLanguageList()
+    {
+        static const std::vector<std::string> list(dlgeLanguages.begin(), dlgeLanguages.end());
+        return list;
+    }
+};
+
+/**
+ * @brief Calls fn with the Game of the given version, the only place the runtime Version is looked at.
+ *
+ * Anything other than H2016 and H3 is treated as H2, the same as the formats always have.
+ */
+template <typename Fn>
+decltype(auto) dispatch(Version version, Fn &&fn)
+{
+    switch (version)
+    {
+    case Version::H2016:
+        return fn(Game<Version::H2016>{});
+    case Version::H3:
+        return fn(Game<Version::H3>{});
+    default:
+        return fn(Game<Version::H2>{});
+    }
+}
+
+/**
+ * @brief The default language map of the given version, for the formats that don't need a Game of their own.
+ */
+inline const std::vector<std::string> &defaultLanguages(Version version)
+{
+    return dispatch(version, []<Version V>(Game<V>) -> const std::vector<std::string> & { return Game<V>::languageList(); });
+}
+
+/**
+ * @brief The languages of a langmap, or the given built-in languages if it's empty.
+ */
+inline const std::vector<std::string> &resolveLanguages(const TonyTools::Language::LanguageMap &langMap, const std::vector<std::string> &builtIn)
+{
+    return langMap.empty() ? builtIn : langMap.languages();
+}
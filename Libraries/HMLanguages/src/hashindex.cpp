@@ -0,0 +1,325 @@
+#include "hashindex.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+// Everything in here decides where keys land in the tables, and precompiled (v2) hash lists
+// store those tables. Changing any of it needs a new hash list format version.
+namespace
+{
+    // Top bit of a bucket seed, the rest of the seed is then the slot of the bucket's only key.
+    constexpr uint32_t directSlot = 0x80000000;
+
+    // Average keys per bucket, lower means more seeds but a faster build.
+    constexpr uint32_t bucketSize = 2;
+
+    inline uint64_t mix64(uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ull;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBull;
+        x ^= x >> 31;
+
+        return x;
+    }
+
+    inline uint64_t hashOf(uint32_t hash)
+    {
+        return mix64(hash);
+    }
+
+    // Eight bytes per step, keeping the dependency chain short matters more than mixing quality here
+    // since mix64 finishes it off anyway. Reads are little endian like the rest of the file.
+    inline uint64_t hashOf(std::string_view str)
+    {
+        const char* data = str.data();
+        size_t size = str.size();
+        uint64_t hash = 0xCBF29CE484222325ull ^ (size * 0x9E3779B97F4A7C15ull);
+
+        while (size >= 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, data, 8);
+            hash = ((hash ^ (word * 0x87C37B91114253D5ull)) << 31 | (hash ^ (word * 0x87C37B91114253D5ull)) >> 33) * 0x4CF5AD432745937Full;
+            data += 8;
+            size -= 8;
+        }
+
+        uint64_t tail = 0;
+        std::memcpy(&tail, data, size);
+        hash ^= tail * 0x87C37B91114253D5ull;
+
+        return mix64(hash);
+    }
+
+    // Maps a 32-bit value onto [0, n) without a division.
+    inline uint32_t reduce(uint32_t value, uint32_t n)
+    {
+        return (uint32_t)(((uint64_t)value * n) >> 32);
+    }
+
+    inline uint32_t bucketOf(uint64_t key, uint32_t buckets)
+    {
+        return reduce((uint32_t)(key >> 32), buckets);
+    }
+
+    inline uint32_t slotOf(uint64_t key, uint32_t seed, uint32_t slots)
+    {
+        return reduce((uint32_t)mix64(key ^ (seed * 0x9E3779B97F4A7C15ull)), slots);
+    }
+
+    // Sorts by key and drops repeated keys, keeping the lowest entry index (the first occurrence).
+    void dedupe(std::vector<std::pair<uint64_t, uint32_t>> &keys)
+    {
+        std::sort(keys.begin(), keys.end());
+        keys.erase(
+            std::unique(keys.begin(), keys.end(), [](const auto &a, const auto &b) { return a.first == b.first; }),
+            keys.end()
+        );
+    }
+} // namespace
+
+bool HashIndex::PerfectHash::build(const std::vector<std::pair<uint64_t, uint32_t>> &keys)
+{
+    uint32_t keyCount = (uint32_t)keys.size();
+    uint32_t bucketCount = std::max<uint32_t>(1, keyCount / bucketSize);
+
+    seedStorage.assign(bucketCount, 0);
+    slotStorage.assign(keyCount, 0);
+
+    seeds = seedStorage.data();
+    seedCount = bucketCount;
+    slots = slotStorage.data();
+    slotCount = keyCount;
+
+    if (!keyCount)
+        return true;
+
+    // Group the keys by bucket.
+    std::vector<uint32_t> bucketStart(bucketCount + 1, 0);
+    for (const auto &[key, index] : keys)
+        bucketStart[bucketOf(key, bucketCount) + 1]++;
+
+    std::partial_sum(bucketStart.begin(), bucketStart.end(), bucketStart.begin());
+
+    std::vector<uint32_t> grouped(keyCount);
+    std::vector<uint32_t> fill(bucketStart.begin(), bucketStart.end() - 1);
+    for (uint32_t i = 0; i < keyCount; i++)
+        grouped[fill[bucketOf(keys[i].first, bucketCount)]++] = i;
+
+    // Biggest buckets are placed first while the table is still mostly empty.
+    std::vector<uint32_t> order(bucketCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return bucketStart[a + 1] - bucketStart[a] > bucketStart[b + 1] - bucketStart[b];
+    });
+
+    std::vector<uint8_t> taken(keyCount, 0);
+    std::vector<uint32_t> bucketSlots;
+    uint32_t nextFree = 0;
+
+    for (uint32_t bucket : order)
+    {
+        uint32_t start = bucketStart[bucket];
+        uint32_t size = bucketStart[bucket + 1] - start;
+
+        if (size == 0)
+            break;
+
+        // Single keys don't need searching, they just take the next free slot.
+        if (size == 1)
+        {
+            while (taken[nextFree])
+                nextFree++;
+
+            taken[nextFree] = 1;
+            seedStorage[bucket] = directSlot | nextFree;
+            slotStorage[nextFree] = keys[grouped[start]].second;
+            continue;
+        }
+
+        for (uint32_t seed = 0;; seed++)
+        {
+            if (seed == directSlot)
+                return false;
+
+            bucketSlots.clear();
+
+            bool fits = true;
+            for (uint32_t i = start; i < start + size && fits; i++)
+            {
+                uint32_t slot = slotOf(keys[grouped[i]].first, seed, keyCount);
+                fits = !taken[slot] && std::find(bucketSlots.begin(), bucketSlots.end(), slot) == bucketSlots.end();
+                bucketSlots.push_back(slot);
+            }
+
+            if (!fits)
+                continue;
+
+            for (uint32_t i = 0; i < size; i++)
+            {
+                taken[bucketSlots[i]] = 1;
+                slotStorage[bucketSlots[i]] = keys[grouped[start + i]].second;
+            }
+
+            seedStorage[bucket] = seed;
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool HashIndex::PerfectHash::view(const uint32_t* seeds, uint32_t seedCount, const uint32_t* slots, uint32_t slotCount, uint32_t entryCount)
+{
+    clear();
+
+    if (slotCount && !seedCount)
+        return false;
+
+    for (uint32_t i = 0; i < seedCount; i++)
+    {
+        if ((seeds[i] & directSlot) && (seeds[i] & ~directSlot) >= slotCount)
+            return false;
+    }
+
+    for (uint32_t i = 0; i < slotCount; i++)
+    {
+        if (slots[i] >= entryCount)
+            return false;
+    }
+
+    this->seeds = seeds;
+    this->seedCount = seedCount;
+    this->slots = slots;
+    this->slotCount = slotCount;
+
+    return true;
+}
+
+std::optional<uint32_t> HashIndex::PerfectHash::find(uint64_t key) const
+{
+    if (!slotCount)
+        return std::nullopt;
+
+    uint32_t seed = seeds[bucketOf(key, seedCount)];
+    uint32_t slot = (seed & directSlot) ? (seed & ~directSlot) : slotOf(key, seed, slotCount);
+
+    return slots[slot];
+}
+
+void HashIndex::PerfectHash::clear()
+{
+    seedStorage.clear();
+    seedStorage.shrink_to_fit();
+    slotStorage.clear();
+    slotStorage.shrink_to_fit();
+
+    seeds = nullptr;
+    seedCount = 0;
+    slots = nullptr;
+    slotCount = 0;
+}
+
+bool HashIndex::build(const char* pool, std::vector<HashIndexEntry> entries)
+{
+    clear();
+
+    this->pool = pool;
+    entryStorage = std::move(entries);
+    this->entries = entryStorage.data();
+    entryCount = (uint32_t)entryStorage.size();
+
+    std::vector<std::pair<uint64_t, uint32_t>> keys;
+    keys.reserve(entryCount);
+
+    for (uint32_t i = 0; i < entryCount; i++)
+        keys.emplace_back(hashOf(this->entries[i].hash), i);
+
+    dedupe(keys);
+    if (!byHash.build(keys))
+    {
+        clear();
+        return false;
+    }
+
+    // Two different strings sharing a 64-bit hash would make the second unreachable,
+    // which is the same as it being a duplicate so it is treated as one.
+    keys.clear();
+    for (uint32_t i = 0; i < entryCount; i++)
+        keys.emplace_back(hashOf(string(this->entries[i])), i);
+
+    dedupe(keys);
+    if (!byString.build(keys))
+    {
+        clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool HashIndex::view(const char* pool, size_t poolSize, const Tables &tables)
+{
+    clear();
+
+    for (uint32_t i = 0; i < tables.entryCount; i++)
+    {
+        const HashIndexEntry &entry = tables.entries[i];
+        if (entry.offset > poolSize || entry.length > poolSize - entry.offset)
+            return false;
+    }
+
+    if (!byHash.view(tables.hashSeeds, tables.hashSeedCount, tables.hashSlots, tables.hashSlotCount, tables.entryCount) ||
+        !byString.view(tables.stringSeeds, tables.stringSeedCount, tables.stringSlots, tables.stringSlotCount, tables.entryCount))
+    {
+        clear();
+        return false;
+    }
+
+    this->pool = pool;
+    entries = tables.entries;
+    entryCount = tables.entryCount;
+
+    return true;
+}
+
+HashIndex::Tables HashIndex::tables() const
+{
+    return {
+        entries, entryCount,
+        byHash.seeds, byHash.seedCount, byHash.slots, byHash.slotCount,
+        byString.seeds, byString.seedCount, byString.slots, byString.slotCount
+    };
+}
+
+void HashIndex::clear()
+{
+    pool = nullptr;
+    entryStorage.clear();
+    entryStorage.shrink_to_fit();
+    entries = nullptr;
+    entryCount = 0;
+    byHash.clear();
+    byString.clear();
+}
+
+std::optional<std::string_view> HashIndex::value(uint32_t hash) const
+{
+    std::optional<uint32_t> index = byHash.find(hashOf(hash));
+    if (!index || entries[*index].hash != hash)
+        return std::nullopt;
+
+    return string(entries[*index]);
+}
+
+std::optional<uint32_t> HashIndex::key(std::string_view value) const
+{
+    std::optional<uint32_t> index = byString.find(hashOf(value));
+    if (!index || string(entries[*index]) != value)
+        return std::nullopt;
+
+    return entries[*index].hash;
+}
@@ -0,0 +1,129 @@
+/**
+ * @file hashindex.hpp
+ * @brief Read-only, two-way index between hash list hashes and their strings.
+ *
+ * Built once when the hash list is loaded. Both directions use a minimal perfect hash
+ * (hash and displace) over a single table of entries whose strings live in one contiguous pool,
+ * so a lookup is two array reads and one comparison, and never allocates.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+struct HashIndexEntry
+{
+    uint32_t hash;
+    uint32_t offset; // Offset of the string in the pool
+    uint32_t length;
+};
+
+class HashIndex
+{
+public:
+    /**
+     * @brief The raw tables behind an index, these are what a precompiled (v2) hash list stores.
+     */
+    struct Tables
+    {
+        const HashIndexEntry* entries = nullptr;
+        uint32_t entryCount = 0;
+
+        const uint32_t* hashSeeds = nullptr;
+        uint32_t hashSeedCount = 0;
+        const uint32_t* hashSlots = nullptr;
+        uint32_t hashSlotCount = 0;
+
+        const uint32_t* stringSeeds = nullptr;
+        uint32_t stringSeedCount = 0;
+        const uint32_t* stringSlots = nullptr;
+        uint32_t stringSlotCount = 0;
+    };
+
+    HashIndex() = default;
+    HashIndex(HashIndex &&) = default;
+    HashIndex &operator=(HashIndex &&) = default;
+
+    // The tables may point into the index's own storage.
+    HashIndex(const HashIndex &) = delete;
+    HashIndex &operator=(const HashIndex &) = delete;
+
+    /**
+     * @brief Builds the index over the given entries, the pool has to outlive the index.
+     *
+     * If a hash (or string) appears more than once, the first entry wins for that direction.
+     *
+     * @return bool representing if building was successful.
+     */
+    bool build(const char* pool, std::vector<HashIndexEntry> entries);
+
+    /**
+     * @brief Uses already built tables (i.e. from a mapped file) without copying them.
+     *
+     * Every table is bounds checked first, so malformed tables can give wrong results but never read out of bounds.
+     * Both the pool and the tables have to outlive the index.
+     *
+     * @return bool representing if the tables are valid.
+     */
+    bool view(const char* pool, size_t poolSize, const Tables &tables);
+
+    /**
+     * @brief The tables currently in use, the hashing behind them is part of the v2 hash list format.
+     */
+    Tables tables() const;
+
+    void clear();
+
+    /**
+     * @brief Gets the string of a hash.
+     */
+    std::optional<std::string_view> value(uint32_t hash) const;
+
+    /**
+     * @brief Gets the hash of a string.
+     */
+    std::optional<uint32_t> key(std::string_view value) const;
+
+    bool has_key(uint32_t hash) const { return value(hash).has_value(); }
+    bool has_value(std::string_view value) const { return key(value).has_value(); }
+
+    size_t size() const { return entryCount; }
+
+private:
+    struct PerfectHash
+    {
+        // Only used when the index was built rather than viewed.
+        std::vector<uint32_t> seedStorage;
+        std::vector<uint32_t> slotStorage;
+
+        // One seed per bucket. Seeds with the top bit set map their (single) key straight to a slot.
+        const uint32_t* seeds = nullptr;
+        uint32_t seedCount = 0;
+        // Index into entries for every slot.
+        const uint32_t* slots = nullptr;
+        uint32_t slotCount = 0;
+
+        bool build(const std::vector<std::pair<uint64_t, uint32_t>> &keys);
+        bool view(const uint32_t* seeds, uint32_t seedCount, const uint32_t* slots, uint32_t slotCount, uint32_t entryCount);
+        std::optional<uint32_t> find(uint64_t key) const;
+        void clear();
+    };
+
+    const char* pool = nullptr;
+    std::vector<HashIndexEntry> entryStorage;
+    const HashIndexEntry* entries = nullptr;
+    uint32_t entryCount = 0;
+
+    PerfectHash byHash;
+    PerfectHash byString;
+
+    std::string_view string(const HashIndexEntry &entry) const
+    {
+        return std::string_view(pool + entry.offset, entry.length);
+    }
+};
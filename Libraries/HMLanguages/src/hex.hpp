@@ -0,0 +1,139 @@
+/**
+ * @file hex.hpp
+ * @brief Formatting and parsing of hex hashes in fixed-size buffers, without going through the heap.
+ *
+ * Hashes are always uppercase and zero-padded, i.e. the same as std::format("{:08X}") and "{:016X}".
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+// SSE2 is part of x64, so the validation can use it without going through cpu().
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HMLANG_SSE2 1
+#include <emmintrin.h>
+#else
+#define HMLANG_SSE2 0
+#endif
+
+/**
+ * @brief The hex of a value, held in place. Views of it are only valid for as long as it is.
+ */
+template <size_t N>
+struct HexChars
+{
+    std::array<char, N> chars;
+
+    std::string_view view() const { return std::string_view(chars.data(), N); }
+    operator std::string_view() const { return view(); }
+
+    bool operator==(std::string_view str) const { return view() == str; }
+};
+
+/**
+ * @brief Formats the low N digits of a value, the same as std::format("{:0NX}") for values that fit.
+ */
+template <size_t N>
+HexChars<N> toHex(uint64_t value)
+{
+    static constexpr char digits[] = "0123456789ABCDEF";
+
+    HexChars<N> hex;
+    for (size_t i = N; i-- > 0; value >>= 4)
+        hex.chars[i] = digits[value & 0xF];
+
+    return hex;
+}
+
+inline HexChars<8> hex8(uint32_t value) { return toHex<8>(value); }
+inline HexChars<16> hex16(uint64_t value) { return toHex<16>(value); }
+
+// The value of every hex digit, -1 for anything else. Unlike isxdigit, this doesn't depend on the locale.
+inline constexpr std::array<int8_t, 256> hexValues = [] {
+    std::array<int8_t, 256> values{};
+    values.fill(-1);
+
+    for (int i = 0; i < 10; i++)
+        values['0' + i] = (int8_t)i;
+
+    for (int i = 0; i < 6; i++)
+    {
+        values['A' + i] = (int8_t)(10 + i);
+        values['a' + i] = (int8_t)(10 + i);
+    }
+
+    return values;
+}();
+
+/**
+ * @brief If every character is a hex digit, the same as all_of(isxdigit) (so an empty string is too).
+ */
+inline bool isHex(std::string_view str)
+{
+    for (char c : str)
+    {
+        if (hexValues[(uint8_t)c] < 0)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief If a string is a ResourceID hash, 16 hex digits. All 16 are checked at once where SSE2 is available.
+ */
+inline bool isResourceID(std::string_view str)
+{
+    if (str.size() != 16)
+        return false;
+
+#if HMLANG_SSE2
+    __m128i chars = _mm_loadu_si128((const __m128i*)str.data());
+
+    // Comparisons are signed, so anything above 0x7F is below '0' and fails both ranges.
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+
+    // Setting 0x20 lowercases A-F, and only A-F and a-f end up in a-f.
+    __m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+    __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+
+    return _mm_movemask_epi8(_mm_or_si128(digit, letter)) == 0xFFFF;
+#else
+    return isHex(str);
+#endif
+}
+
+/**
+ * @brief Parses a string of hex digits (checked with isHex first) into 32 bits, the same as strtoul.
+ *
+ * Up to 8 digits are parsed in place, longer strings still go through strtoul so they overflow the way they always have.
+ */
+inline uint32_t parseHex32(std::string_view str)
+{
+    if (str.size() > 8)
+        return (uint32_t)std::strtoul(std::string(str).c_str(), nullptr, 16);
+
+    uint32_t value = 0;
+    for (char c : str)
+        value = (value << 4) | (uint32_t)hexValues[(uint8_t)c];
+
+    return value;
+}
+
+/**
+ * @brief Parses a ResourceID (checked with isResourceID first).
+ */
+inline uint64_t parseResourceID(std::string_view str)
+{
+    uint64_t value = 0;
+    for (char c : str)
+        value = (value << 4) | (uint64_t)hexValues[(uint8_t)c];
+
+    return value;
+}
@@ -0,0 +1,112 @@
+#include "jsonwriter.hpp"
+
+#include <array>
+#include <cstdio>
+
+namespace
+{
+    constexpr uint8_t utf8Accept = 0;
+    constexpr uint8_t utf8Reject = 1;
+
+    // Bjoern Hoehrmann's UTF-8 decoder, the same one (and so the same error positions) dump() uses.
+    constexpr std::array<uint8_t, 400> utf8d = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 00..1F
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 20..3F
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 40..5F
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 60..7F
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, // 80..9F
+        7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, // A0..BF
+        8, 8, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, // C0..DF
+        0xA, 0x3, 0x3, 0x3, 0x3, 0x3, 0x3, 0x3, 0x3, 0x3, 0x3, 0x3, 0x3, 0x4, 0x3, 0x3, // E0..EF
+        0xB, 0x6, 0x6, 0x6, 0x5, 0x8, 0x8, 0x8, 0x8, 0x8, 0x8, 0x8, 0x8, 0x8, 0x8, 0x8, // F0..FF
+        0x0, 0x1, 0x2, 0x3, 0x5, 0x8, 0x7, 0x1, 0x1, 0x1, 0x4, 0x6, 0x1, 0x1, 0x1, 0x1, // s0..s0
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 0, 1, 0, 1, 1, 1, 1, 1, 1, // s1..s2
+        1, 2, 1, 1, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, // s3..s4
+        1, 2, 1, 1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 1, 3, 1, 1, 1, 1, 1, 1, // s5..s6
+        1, 3, 1, 1, 1, 1, 1, 3, 1, 3, 1, 1, 1, 1, 1, 1, 1, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1  // s7..s8
+    };
+
+    // Bytes that can be copied as is while no multi-byte sequence is in progress.
+    constexpr std::array<bool, 256> plainTable = [] {
+        std::array<bool, 256> table{};
+        for (int c = 0x20; c < 0x80; c++)
+            table[c] = c != '"' && c != '\\';
+
+        return table;
+    }();
+
+    std::string hexByte(uint8_t byte)
+    {
+        constexpr const char* digits = "0123456789ABCDEF";
+        return { digits[byte >> 4], digits[byte & 0xF] };
+    }
+} // namespace
+
+void JsonWriter::value(const json &value)
+{
+    separate();
+
+    // Same as dump(), but appending to our string rather than returning a new one.
+    nlohmann::detail::serializer<json> serializer(nlohmann::detail::output_adapter<char>(out), ' ', nlohmann::json::error_handler_t::strict);
+    serializer.dump(value, false, false, 0);
+}
+
+void JsonWriter::escapeTo(std::string &out, std::string_view str)
+{
+    out.push_back('"');
+
+    uint8_t state = utf8Accept;
+    size_t runStart = 0;
+
+    for (size_t i = 0; i < str.size(); i++)
+    {
+        uint8_t byte = (uint8_t)str[i];
+
+        if (state == utf8Accept && plainTable[byte])
+            continue;
+
+        // Anything other than plain ASCII ends the current run.
+        out.append(str.data() + runStart, i - runStart);
+        runStart = i + 1;
+
+        state = utf8d[256 + state * 16 + utf8d[byte]];
+
+        if (state == utf8Reject)
+            throw json::type_error::create(316, "invalid UTF-8 byte at index " + std::to_string(i) + ": 0x" + hexByte(byte), nullptr);
+
+        if (state != utf8Accept)
+        {
+            // Part of a multi-byte code point, these are never escaped.
+            out.push_back((char)byte);
+            continue;
+        }
+
+        switch (byte)
+        {
+        case '\b': out.append("\\b"); break;
+        case '\t': out.append("\\t"); break;
+        case '\n': out.append("\\n"); break;
+        case '\f': out.append("\\f"); break;
+        case '\r': out.append("\\r"); break;
+        case '"': out.append("\\\""); break;
+        case '\\': out.append("\\\\"); break;
+        default:
+            if (byte <= 0x1F)
+            {
+                char escaped[7];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", byte);
+                out.append(escaped, 6);
+            }
+            else
+                // The last byte of a multi-byte code point.
+                out.push_back((char)byte);
+            break;
+        }
+    }
+
+    if (state != utf8Accept)
+        throw json::type_error::create(316, "incomplete UTF-8 string; last byte: 0x" + hexByte((uint8_t)str.back()), nullptr);
+
+    out.append(str.data() + runStart, str.size() - runStart);
+    out.push_back('"');
+}
@@ -0,0 +1,110 @@
+/**
+ * @file jsonwriter.hpp
+ * @brief Streams compact JSON straight into a string, byte-identical to nlohmann's dump().
+ *
+ * Used by the Convert functions so they don't have to build a DOM just to serialise it.
+ * Object keys are written as given, callers are responsible for repeated keys (dump() would
+ * have kept the first one, as ordered_json ignores a repeated push_back).
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "arena.hpp"
+
+class JsonWriter
+{
+public:
+    explicit JsonWriter(std::string &out) : out(out) {}
+
+    void beginObject() { open('{'); }
+    void endObject() { close('}'); }
+    void beginArray() { open('['); }
+    void endArray() { close(']'); }
+
+    /**
+     * @brief Writes an object key, the next value written belongs to it.
+     */
+    void key(std::string_view key)
+    {
+        separate();
+        escape(key);
+        out.push_back(':');
+        afterKey = true;
+    }
+
+    void value(std::string_view str)
+    {
+        separate();
+        escape(str);
+    }
+
+    void value(const char* str) { value(std::string_view(str)); }
+    void value(const std::string &str) { value(std::string_view(str)); }
+
+    void value(bool boolean)
+    {
+        separate();
+        out.append(boolean ? "true" : "false");
+    }
+
+    void null()
+    {
+        separate();
+        out.append("null");
+    }
+
+    /**
+     * @brief Writes an existing JSON value (i.e. from the meta) exactly as dump() would.
+     */
+    void value(const json &value);
+
+    /**
+     * @brief Writes a string exactly as dump() would, escaping control characters, quotes, and backslashes.
+     *
+     * @throws nlohmann::json::type_error (316) on invalid UTF-8, same as dump().
+     */
+    static void escapeTo(std::string &out, std::string_view str);
+
+private:
+    std::string &out;
+
+    // One entry per open object/array, true once it has a member.
+    std::vector<bool> hasMembers;
+    bool afterKey = false;
+
+    void separate()
+    {
+        if (afterKey)
+        {
+            afterKey = false;
+            return;
+        }
+
+        if (!hasMembers.empty())
+        {
+            if (hasMembers.back())
+                out.push_back(',');
+            hasMembers.back() = true;
+        }
+    }
+
+    void open(char c)
+    {
+        separate();
+        out.push_back(c);
+        hasMembers.push_back(false);
+    }
+
+    void close(char c)
+    {
+        out.push_back(c);
+        hasMembers.pop_back();
+    }
+
+    void escape(std::string_view str) { escapeTo(out, str); }
+};
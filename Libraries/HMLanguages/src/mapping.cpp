@@ -0,0 +1,111 @@
+#include "mapping.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <filesystem>
+
+#ifdef _WIN32
+bool MappedFile::open(const std::string &path)
+{
+    close();
+
+    // Go through filesystem::path so non-ASCII paths work.
+    std::wstring widePath = std::filesystem::path(path).wstring();
+
+    // Others can rename a new file over this one while it's mapped (delete sharing), but not write to it.
+    HANDLE handle = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(handle);
+        return false;
+    }
+
+    HANDLE view = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!view)
+    {
+        CloseHandle(handle);
+        return false;
+    }
+
+    const void* address = MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0);
+    if (!address)
+    {
+        CloseHandle(view);
+        CloseHandle(handle);
+        return false;
+    }
+
+    file = handle;
+    mapping = view;
+    ptr = (const char*)address;
+    length = (size_t)fileSize.QuadPart;
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (ptr)
+        UnmapViewOfFile(ptr);
+    if (mapping)
+        CloseHandle(mapping);
+    if (file)
+        CloseHandle(file);
+
+    ptr = nullptr;
+    length = 0;
+    file = nullptr;
+    mapping = nullptr;
+}
+#else
+bool MappedFile::open(const std::string &path)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void* address = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping keeps its own reference to the file.
+    ::close(fd);
+
+    if (address == MAP_FAILED)
+        return false;
+
+    ptr = (const char*)address;
+    length = (size_t)info.st_size;
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (ptr)
+        munmap((void*)ptr, length);
+
+    ptr = nullptr;
+    length = 0;
+}
+#endif
@@ -0,0 +1,44 @@
+/**
+ * @file mapping.hpp
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * The file must never be rewritten in place while it's mapped, on Linux reading a page past its new end is a SIGBUS.
+ * Write a new file and rename it over the old one instead, the mapping keeps the old one alive.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /**
+     * @brief Maps the given file, any previously mapped file is unmapped first.
+     *
+     * @return bool representing if the file could be opened and mapped (empty files can't be).
+     */
+    bool open(const std::string &path);
+
+    void close();
+
+    const char* data() const { return ptr; }
+    size_t size() const { return length; }
+    bool isOpen() const { return ptr != nullptr; }
+
+private:
+    const char* ptr = nullptr;
+    size_t length = 0;
+
+#ifdef _WIN32
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+};
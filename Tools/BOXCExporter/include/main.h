@@ -15,7 +15,7 @@
 
 #include <DirectXTex.h>
 #include <DDS.h>
-#include "buffer.hpp"
+#include <TonyTools/BinaryIO.h>
 #include "Texture.hpp"
 #include <argparse/argparse.hpp>
 #include <nlohmann/json.hpp>
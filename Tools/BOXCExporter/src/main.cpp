@@ -40,8 +40,8 @@ int main(int argc, char *argv[])
 
     if (mode == "convert")
     {
-        file_buffer buff;
-        buff.load(inputPath.string());
+        std::vector<char> file = TonyTools::BinaryIO::ReadFile(inputPath);
+        TonyTools::BinaryIO::Reader buff(file);
 
         // Parse the BOXC file
         BOXC boxc{};
@@ -53,7 +53,7 @@ int main(int argc, char *argv[])
             Cubemap cubemap{};
 
             cubemap.pos = buff.read<Vector3>();
-            cubemap.textureData = buff.read<std::vector<char>>();
+            cubemap.textureData = buff.readVector<char>();
 
             boxc.cubemaps.push_back(cubemap);
         }
@@ -135,7 +135,8 @@ int main(int argc, char *argv[])
         if (FAILED(hr))
             handleHRESULT("Failed to initalise COM!", hr);
 
-        file_buffer buff;
+        std::vector<char> boxcData;
+        TonyTools::BinaryIO::Writer buff(boxcData);
         buff.write<uint32_t>(j.size());
 
         std::filesystem::path tgaInput = inputPath.parent_path();
@@ -145,10 +146,10 @@ int main(int argc, char *argv[])
             buff.write<float>(entry["pos"][1].get<float>());
             buff.write<float>(entry["pos"][2].get<float>());
 
-            buff.write<std::vector<char>>(loadTGA(tgaInput / entry["filepath"].get<std::string>()));
+            buff.writeVector(loadTGA(tgaInput / entry["filepath"].get<std::string>()));
         }
 
-        buff.save(outputPath.generic_string());
+        TonyTools::BinaryIO::WriteFile(outputPath, boxcData);
     }
     else
     {
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// The hash list sections a hash is unknown in, a hash can be unknown in more than one.
+enum HashSection : uint8_t
+{
+    Soundtag = 1 << 0,
+    Switch = 1 << 1,
+    Line = 1 << 2
+};
+
+// Candidates are every prefix + 1 to depth words (joined by the separator) + suffix.
+struct CrackOptions
+{
+    std::vector<std::string> words;
+    std::vector<std::string> prefixes = {""};
+    std::vector<std::string> suffixes = {""};
+    std::string separator;
+    size_t depth = 1;
+    unsigned threads = 0; // 0 uses every core
+};
+
+struct CrackHit
+{
+    uint32_t hash;
+    std::string value;
+};
+
+struct CrackResult
+{
+    // Sorted by hash, hits for the same hash are in the order their candidates are generated in.
+    std::vector<CrackHit> hits;
+    uint64_t candidates = 0;
+    double seconds = 0;
+};
+
+// Finds the hashes left unresolved in a directory of HMLanguages JSON files (DITL, DLGE, and LOCR convert output).
+std::unordered_map<uint32_t, uint8_t> collectUnknownHashes(const std::filesystem::path &corpus);
+
+// Tries every candidate against the targets on all threads.
+CrackResult crackHashes(const std::vector<uint32_t> &targets, const CrackOptions &options);
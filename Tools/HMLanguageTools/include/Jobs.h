@@ -0,0 +1,56 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <TonyTools/Languages.h>
+
+class RebuildCache;
+
+inline constexpr const char* toolVersion = "v1.8.2";
+
+// A single convert or rebuild, the same as one run of the CLI.
+struct Job
+{
+    bool rebuild = false;
+    TonyTools::Language::Version version = TonyTools::Language::Version::H3;
+    std::string type; // CLNG, DITL, DLGE, LOCR, or RTLV
+    std::filesystem::path inputPath;
+    std::filesystem::path outputPath;
+    std::filesystem::path metaPath; // the input meta on convert, the output meta on rebuild
+    TonyTools::Language::LanguageMap langMap;
+    std::string defaultLocale = "en";
+    bool hexPrecision = false;
+    bool symmetric = false;
+};
+
+struct JobResult
+{
+    bool ok;
+    std::string message;
+};
+
+// Parses the CLI syntax (mode game type input_path output_path [options]) without exiting on errors.
+// The meta path defaults to the input (convert) or output (rebuild) path + .meta.json.
+bool parseJob(std::span<const std::string> args, Job &job, std::string &error);
+
+// The arguments parseJob would parse back into the same job.
+std::vector<std::string> jobArguments(const Job &job);
+
+// Runs a job, the buffers are kept per thread so a thread running many jobs doesn't keep reallocating them.
+// Rebuilds are looked up in (and added to) the cache if one is given, and the conversion adds to stats if given.
+JobResult runJob(const Job &job, RebuildCache *cache = nullptr, TonyTools::Language::Stats *stats = nullptr);
+
+// Reads a whole file in one go (the size is known up front).
+bool readFileData(const std::filesystem::path &path, std::vector<char> &data);
+
+bool writeFileData(const std::filesystem::path &path, std::span<const char> data);
+
+// Converts or rebuilds a whole directory tree (or a list of files in it) on every core.
+int runBatch(int argc, char *argv[]);
+
+// Converts and rebuilds every file in a directory tree in memory on every core, and reports the ones that don't
+// come back byte for byte with the same meta hash and depends.
+int runVerify(int argc, char *argv[]);
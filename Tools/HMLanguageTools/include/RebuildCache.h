@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include <TonyTools/Languages.h>
+
+struct Job;
+
+// A directory of rebuilt files (file + meta), named by a SHA-256 of the JSON and everything else the rebuild
+// depends on, so JSONs that haven't changed since the last run are copied out of the cache instead of rebuilt.
+// Processes and threads can share a cache directory, entries are written to a temporary file and renamed.
+//
+// Entries are touched when they are used, and once the cache grows past its size the least recently used ones
+// are removed until it is back under 90% of it.
+class RebuildCache
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t stored = 0;
+        uint64_t evicted = 0;
+    };
+
+    RebuildCache(const std::filesystem::path &directory, uint64_t maxBytes);
+
+    // The key of a rebuild of json with the job's settings and hash list, the input and output paths aren't part of
+    // it. The hash list has to be the one the rebuild uses, not the default context that can be reloaded meanwhile.
+    std::string key(const Job &job, std::string_view json, const TonyTools::Language::HashListContext &hashList) const;
+
+    // Fills output with the cached entry, if there is a valid one.
+    bool get(const std::string &key, TonyTools::Language::Rebuilt &output);
+
+    void put(const std::string &key, const TonyTools::Language::Rebuilt &rebuilt);
+
+    Stats stats() const;
+
+    // i.e. "12 hits, 3 misses, 3 stored, 0 evicted".
+    std::string summary() const;
+
+private:
+    std::filesystem::path entryPath(const std::string &key) const;
+    void evict();
+
+    std::filesystem::path directory;
+    uint64_t maxBytes;
+
+    mutable std::mutex mutex;
+    Stats counts;
+    uint64_t totalBytes = 0;
+    bool scanned = false; // the size of the existing entries is only needed once something is stored
+};
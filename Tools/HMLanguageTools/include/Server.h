@@ -0,0 +1,20 @@
+#pragma once
+
+#include <filesystem>
+
+// The serve mode keeps the hash list loaded and runs jobs sent to it on a worker pool, for callers that would
+// otherwise start the tool once per file. Jobs are read from a Unix domain socket (--socket) or from stdin, with
+// the responses written back to the socket or stdout (anything else that would be printed to stdout goes to stderr).
+//
+// Every message is framed as a little-endian uint32 size followed by that many bytes:
+//   request:  uint32 id, then the arguments, each one null terminated
+//   response: uint32 id, uint8 success, then the message (the same one the CLI would print)
+//
+// The arguments are the same as the CLI's (mode game type input_path output_path [options]), "reload" with an
+// optional path to load a new hash list, or "stats" for the rebuild cache's hits and misses. Requests on a
+// connection run concurrently, so responses can come back in any order, the id tells which request one is for.
+// Relative paths are resolved by the server.
+int runServer(int argc, char *argv[], const std::filesystem::path &hashListPath);
+
+// Sends one job (with the CLI's syntax) to a server and prints its response.
+int runClient(int argc, char *argv[]);
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+
+#include <TonyTools/Languages.h>
+
+// Turned on by --stats before any jobs start. The tool's operator new only passes allocations on to the stats
+// while it's set, so without --stats an allocation costs one more branch.
+inline bool countAllocations = false;
+
+// The stats of a run as a table, files is the number of files they are for.
+std::string formatStats(const TonyTools::Language::Stats &stats, size_t files);
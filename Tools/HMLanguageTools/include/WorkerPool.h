@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of threads, each with its own queue. Tasks are spread over the queues, a thread works through
+// its own queue and steals from the others once it is empty, so uneven tasks (a huge DLGE next to tiny LOCRs)
+// don't leave threads idle while another one still has a backlog.
+class WorkerPool
+{
+public:
+    // 0 uses every core.
+    explicit WorkerPool(unsigned threads = 0);
+
+    // Finishes every submitted task before joining.
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    void submit(std::function<void()> task);
+
+    // Blocks until every task submitted so far has finished.
+    void wait();
+
+    unsigned size() const { return (unsigned)threads.size(); }
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool take(size_t index, std::function<void()> &task);
+    void work(size_t index);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+
+    std::atomic<size_t> nextQueue = 0;
+    std::atomic<size_t> queued = 0;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    size_t pending = 0; // submitted but not finished, guarded by mutex
+    bool stopping = false;
+};
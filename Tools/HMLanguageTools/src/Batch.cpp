@@ -0,0 +1,490 @@
+#include "Jobs.h"
+#include "RebuildCache.h"
+#include "Stats.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <optional>
+
+#include <argparse/argparse.hpp>
+
+using namespace TonyTools::Language;
+
+#define LOG(x) std::cout << x << std::endl
+#define LOG_AND_EXIT(x) std::cout << x << std::endl; std::exit(0)
+
+namespace
+{
+    constexpr const char* types[] = {"CLNG", "DITL", "DLGE", "LOCR", "RTLV"};
+
+    std::string toUpper(std::string str)
+    {
+        std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return std::toupper(c); });
+        return str;
+    }
+
+    // The type an extension (".LOCR", ".locr") stands for, empty if it isn't one.
+    std::string typeOf(const std::filesystem::path &extension)
+    {
+        std::string ext = toUpper(extension.string());
+        for (const char* type : types)
+        {
+            if (ext.size() == 5 && ext[0] == '.' && ext.compare(1, 4, type) == 0)
+                return type;
+        }
+        return {};
+    }
+
+    // The types are in the same order as ResourceType.
+    ResourceType resourceType(const std::string &type)
+    {
+        return (ResourceType)(std::find(std::begin(types), std::end(types), type) - std::begin(types));
+    }
+
+    bool isJson(const std::filesystem::path &path)
+    {
+        return toUpper(path.extension().string()) == ".JSON";
+    }
+
+    bool isMeta(const std::filesystem::path &path)
+    {
+        return toUpper(path.filename().string()).ends_with(".META.JSON");
+    }
+
+    // RPKG Tool writes the meta next to the file, the extension has been seen in both cases.
+    std::filesystem::path findMeta(const std::filesystem::path &path)
+    {
+        std::filesystem::path meta = path.string() + ".meta.json";
+        if (!std::filesystem::exists(meta) && std::filesystem::exists(path.string() + ".meta.JSON"))
+            meta = path.string() + ".meta.JSON";
+        return meta;
+    }
+
+    struct BatchFile
+    {
+        std::filesystem::path path;
+        std::filesystem::path relative;
+    };
+
+    // Every file in the input directory tree, or the ones in the --list file.
+    bool collectFiles(argparse::ArgumentParser &parser, const std::filesystem::path &inputPath, std::vector<BatchFile> &files)
+    {
+        if (parser.is_used("--list"))
+        {
+            std::ifstream list(parser.get<std::string>("--list"));
+            if (!list.good())
+            {
+                LOG("Could not open the list file!");
+                return false;
+            }
+
+            std::string line;
+            while (std::getline(list, line))
+            {
+                if (!line.empty() && line.back() == '\r')
+                    line.pop_back();
+                if (line.empty())
+                    continue;
+
+                std::filesystem::path path = line;
+                if (path.is_relative())
+                    path = inputPath / path;
+
+                std::filesystem::path relative = path.lexically_relative(inputPath);
+                if (relative.empty() || *relative.begin() == "..")
+                    relative = path.filename();
+
+                files.push_back({path, relative});
+            }
+        }
+        else
+        {
+            for (const auto &entry : std::filesystem::recursive_directory_iterator(inputPath))
+            {
+                if (entry.is_regular_file())
+                    files.push_back({entry.path(), entry.path().lexically_relative(inputPath)});
+            }
+        }
+
+        return true;
+    }
+} // namespace
+
+int runBatch(int argc, char *argv[])
+{
+    argparse::ArgumentParser batch("HMLanguageTools batch");
+
+    batch.add_argument("mode")
+        .help("the mode to use: convert or rebuild")
+        .required();
+
+    batch.add_argument("game")
+        .help("the game the files are from: H2016, H2, or H3")
+        .required();
+
+    batch.add_argument("input_path")
+        .help("directory of files to convert (with their meta) or JSONs to rebuild, subdirectories are included")
+        .required();
+
+    batch.add_argument("output_path")
+        .help("directory to write the outputs to, the input directory tree is mirrored")
+        .required();
+
+    batch.add_argument("--list")
+        .help("file of paths (relative to input_path) to use instead of every file in input_path, one per line")
+        .nargs(1);
+
+    batch.add_argument("--langmap")
+        .help("custom language map, overrides the one provided by version e.g. xx,en,tc,am,on,gu,ss")
+        .nargs(1);
+
+    batch.add_argument("--defaultlocale")
+        .help("the default audio locale, used for DLGE conversion")
+        .default_value(std::string("en"))
+        .nargs(1);
+
+    batch.add_argument("--hexprecision")
+        .help("should random weights be output as their hex variants, used for DLGE convert only")
+        .default_value(false)
+        .implicit_value(true);
+
+    batch.add_argument("--symmetric")
+        .help("if a symmetric cipher should be used, early H2016 LOCR only.")
+        .default_value(false)
+        .implicit_value(true);
+
+    batch.add_argument("--cache")
+        .help("directory to cache rebuilt files in, JSONs that haven't changed are copied from it instead of rebuilt")
+        .nargs(1);
+
+    batch.add_argument("--cachesize")
+        .help("the size (in MB) the cache is kept under, the least recently used files are removed past it")
+        .default_value(1024)
+        .scan<'i', int>()
+        .nargs(1);
+
+    batch.add_argument("--stats")
+        .help("print where the time went (per phase), and the strings, hash lookups and allocations of the files")
+        .default_value(false)
+        .implicit_value(true);
+
+    batch.add_argument("--threads")
+        .help("the number of threads to use, defaults to every core")
+        .default_value(0)
+        .scan<'i', int>()
+        .nargs(1);
+
+    try
+    {
+        batch.parse_args(argc - 1, argv + 1);
+    }
+    catch (const std::runtime_error &err)
+    {
+        LOG(err.what());
+        LOG_AND_EXIT(batch);
+    }
+
+    // The options are checked once, through the same parser as a single job.
+    std::vector<std::string> args = {batch.get<std::string>("mode"), batch.get<std::string>("game"), "LOCR", "", ""};
+    if (batch.is_used("--langmap"))
+        args.insert(args.end(), {"--langmap", batch.get<std::string>("--langmap")});
+    args.insert(args.end(), {"--defaultlocale", batch.get<std::string>("--defaultlocale")});
+    if (batch.get<bool>("--hexprecision"))
+        args.push_back("--hexprecision");
+    if (batch.get<bool>("--symmetric"))
+        args.push_back("--symmetric");
+
+    Job options;
+    std::string error;
+    if (!parseJob(args, options, error))
+    {
+        LOG(error);
+        return 1;
+    }
+
+    std::filesystem::path inputPath = batch.get<std::string>("input_path");
+    std::filesystem::path outputPath = batch.get<std::string>("output_path");
+    if (!std::filesystem::is_directory(inputPath))
+    {
+        LOG("The input path is not a directory!");
+        return 1;
+    }
+
+    std::vector<BatchFile> files;
+    if (!collectFiles(batch, inputPath, files))
+        return 1;
+
+    // Files that aren't a language resource (or its JSON on rebuild) are skipped, unless they were listed.
+    std::vector<Job> jobs;
+    std::vector<uintmax_t> sizes;
+    std::vector<std::string> failures;
+    for (BatchFile &file : files)
+    {
+        Job job = options;
+        job.inputPath = file.path;
+
+        if (!options.rebuild)
+        {
+            job.type = isMeta(file.path) ? "" : typeOf(file.path.extension());
+            job.outputPath = outputPath / (file.relative.string() + ".json");
+            job.metaPath = findMeta(file.path);
+        }
+        else
+        {
+            job.type = isJson(file.path) && !isMeta(file.path) ? typeOf(file.path.stem().extension()) : "";
+            job.outputPath = outputPath / file.relative.parent_path() / file.relative.stem();
+            job.metaPath = job.outputPath.string() + ".meta.json";
+        }
+
+        if (job.type.empty())
+        {
+            if (batch.is_used("--list"))
+                failures.push_back(file.path.string() + ": Could not tell the type from the extension.");
+            continue;
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directories(job.outputPath.parent_path(), ec);
+
+        sizes.push_back(std::filesystem::file_size(file.path, ec));
+        jobs.push_back(std::move(job));
+    }
+
+    // The biggest files go first, so one doesn't end up running on its own at the end.
+    std::vector<size_t> order(jobs.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+
+    std::optional<RebuildCache> cache;
+    if (options.rebuild && batch.is_used("--cache"))
+        cache.emplace(batch.get<std::string>("--cache"), (uint64_t)std::max(1, batch.get<int>("--cachesize")) << 20);
+
+    bool showStats = batch.get<bool>("--stats");
+    countAllocations = showStats;
+
+    std::vector<JobResult> results(jobs.size());
+    std::vector<Stats> stats(showStats ? jobs.size() : 0);
+    auto start = std::chrono::steady_clock::now();
+    unsigned threadCount = 0;
+    {
+        WorkerPool pool((unsigned)std::max(0, batch.get<int>("--threads")));
+        threadCount = pool.size();
+
+        for (size_t i : order)
+            pool.submit([&, i] { results[i] = runJob(jobs[i], cache ? &*cache : nullptr, showStats ? &stats[i] : nullptr); });
+        pool.wait();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t succeeded = 0;
+    uintmax_t bytes = 0;
+    for (size_t i = 0; i < jobs.size(); i++)
+    {
+        if (results[i].ok)
+        {
+            succeeded++;
+            bytes += sizes[i];
+        }
+        else
+            failures.push_back(jobs[i].inputPath.string() + ": " + results[i].message);
+    }
+
+    for (const std::string &failure : failures)
+        LOG("[FAIL] " << failure);
+
+    double mb = bytes / (1024.0 * 1024.0);
+    LOG((options.rebuild ? "Rebuilt " : "Converted ") << succeeded << " of " << jobs.size() << " files (" << mb << " MB) in "
+        << seconds << "s on " << threadCount << " threads (" << (uint64_t)(succeeded / std::max(seconds, 1e-9)) << " files/s, "
+        << mb / std::max(seconds, 1e-9) << " MB/s).");
+
+    if (cache)
+        LOG("Cache: " << cache->summary() << ".");
+
+    if (showStats)
+    {
+        Stats total;
+        for (const Stats &jobStats : stats)
+            total += jobStats;
+
+        LOG(formatStats(total, jobs.size()));
+    }
+
+    return failures.empty() ? 0 : 1;
+}
+
+int runVerify(int argc, char *argv[])
+{
+    argparse::ArgumentParser verify("HMLanguageTools verify");
+
+    verify.add_argument("game")
+        .help("the game the files are from: H2016, H2, or H3")
+        .required();
+
+    verify.add_argument("input_path")
+        .help("directory of files (with their meta) to convert and rebuild, subdirectories are included")
+        .required();
+
+    verify.add_argument("--list")
+        .help("file of paths (relative to input_path) to use instead of every file in input_path, one per line")
+        .nargs(1);
+
+    verify.add_argument("--langmap")
+        .help("custom language map, overrides the one provided by version e.g. xx,en,tc,am,on,gu,ss")
+        .nargs(1);
+
+    verify.add_argument("--defaultlocale")
+        .help("the default audio locale, used for DLGE conversion")
+        .default_value(std::string("en"))
+        .nargs(1);
+
+    verify.add_argument("--symmetric")
+        .help("if a symmetric cipher should be used, early H2016 LOCR only.")
+        .default_value(false)
+        .implicit_value(true);
+
+    verify.add_argument("--stats")
+        .help("print where the time went (per phase), and the strings, hash lookups and allocations of the files")
+        .default_value(false)
+        .implicit_value(true);
+
+    verify.add_argument("--threads")
+        .help("the number of threads to use, defaults to every core")
+        .default_value(0)
+        .scan<'i', int>()
+        .nargs(1);
+
+    try
+    {
+        verify.parse_args(argc - 1, argv + 1);
+    }
+    catch (const std::runtime_error &err)
+    {
+        LOG(err.what());
+        LOG_AND_EXIT(verify);
+    }
+
+    std::vector<std::string> args = {"convert", verify.get<std::string>("game"), "LOCR", "", ""};
+    if (verify.is_used("--langmap"))
+        args.insert(args.end(), {"--langmap", verify.get<std::string>("--langmap")});
+
+    Job options;
+    std::string error;
+    if (!parseJob(args, options, error))
+    {
+        LOG(error);
+        return 1;
+    }
+
+    Verify::Options verifyOptions{options.langMap, verify.get<std::string>("--defaultlocale"), verify.get<bool>("--symmetric")};
+
+    std::filesystem::path inputPath = verify.get<std::string>("input_path");
+    if (!std::filesystem::is_directory(inputPath))
+    {
+        LOG("The input path is not a directory!");
+        return 1;
+    }
+
+    std::vector<BatchFile> files;
+    if (!collectFiles(verify, inputPath, files))
+        return 1;
+
+    // Metas and anything else that isn't a language resource are skipped, unless they were listed.
+    std::vector<BatchFile> verified;
+    std::vector<ResourceType> fileTypes;
+    std::vector<uintmax_t> sizes;
+    std::vector<std::string> skipped;
+    for (BatchFile &file : files)
+    {
+        std::string type = isMeta(file.path) ? "" : typeOf(file.path.extension());
+        if (type.empty())
+        {
+            if (verify.is_used("--list"))
+                skipped.push_back(file.relative.string() + ": Could not tell the type from the extension.");
+            continue;
+        }
+
+        std::error_code ec;
+        fileTypes.push_back(resourceType(type));
+        sizes.push_back(std::filesystem::file_size(file.path, ec));
+        verified.push_back(std::move(file));
+    }
+
+    std::vector<size_t> order(verified.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+
+    bool showStats = verify.get<bool>("--stats");
+    countAllocations = showStats;
+
+    std::vector<Verify::Result> results(verified.size());
+    std::vector<std::string> errors(verified.size());
+    std::vector<Stats> stats(showStats ? verified.size() : 0);
+    auto start = std::chrono::steady_clock::now();
+    unsigned threadCount = 0;
+    {
+        WorkerPool pool((unsigned)std::max(0, verify.get<int>("--threads")));
+        threadCount = pool.size();
+
+        for (size_t i : order)
+        {
+            pool.submit([&, i] {
+                thread_local std::vector<char> data, meta;
+
+                std::filesystem::path metaPath = findMeta(verified[i].path);
+                if (!readFileData(verified[i].path, data) || !readFileData(metaPath, meta))
+                {
+                    errors[i] = "Could not read the file or its meta " + metaPath.string() + "!";
+                    return;
+                }
+
+                std::optional<StatsScope> statsScope;
+                if (showStats)
+                    statsScope.emplace(stats[i]);
+
+                Verify::RoundTrip(results[i], fileTypes[i], options.version, data, std::string_view(meta.data(), meta.size()), verifyOptions);
+            });
+        }
+        pool.wait();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Printed in path order, the files finish in whatever order the threads get to them.
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return verified[a].relative < verified[b].relative; });
+
+    size_t matched = 0;
+    uintmax_t bytes = 0;
+    for (size_t i : order)
+    {
+        bool matches = errors[i].empty() && results[i].Matches();
+        if (matches)
+            matched++;
+        if (errors[i].empty())
+            bytes += sizes[i];
+
+        LOG((matches ? "[OK]   " : "[DIFF] ") << verified[i].relative.string() << ": " << (errors[i].empty() ? results[i].Summary() : errors[i]));
+    }
+
+    for (const std::string &skip : skipped)
+        LOG("[FAIL] " << skip);
+
+    double mb = bytes / (1024.0 * 1024.0);
+    LOG(matched << " of " << verified.size() << " files round trip. Verified " << mb << " MB in " << seconds << "s on " << threadCount
+        << " threads (" << (uint64_t)(verified.size() / std::max(seconds, 1e-9)) << " files/s, " << mb / std::max(seconds, 1e-9) << " MB/s).");
+
+    if (showStats)
+    {
+        Stats total;
+        for (const Stats &fileStats : stats)
+            total += fileStats;
+
+        LOG(formatStats(total, verified.size()));
+    }
+
+    return matched == verified.size() && skipped.empty() ? 0 : 1;
+}
@@ -0,0 +1,404 @@
+#include "HashCracker.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <thread>
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+#pragma region Corpus
+namespace
+{
+    using HashSections = std::unordered_map<uint32_t, uint8_t>;
+
+    // Hashes that aren't in the hash list are written as their zero-padded, 4-byte, hex.
+    void addHash(HashSections &hashes, const std::string &str, HashSection section)
+    {
+        if (str.size() != 8 || !std::all_of(str.begin(), str.end(), [](unsigned char c) { return std::isxdigit(c); }))
+            return;
+
+        hashes[(uint32_t)std::strtoul(str.c_str(), nullptr, 16)] |= section;
+    }
+
+    void addHash(HashSections &hashes, const json &object, const char* key, HashSection section)
+    {
+        auto it = object.find(key);
+        if (it != object.end() && it->is_string())
+            addHash(hashes, it->get_ref<const std::string &>(), section);
+    }
+
+    void collectDLGE(HashSections &hashes, const json &container)
+    {
+        if (!container.is_object())
+            return;
+
+        addHash(hashes, container, "soundtag", Soundtag);
+        addHash(hashes, container, "switchKey", Switch);
+        addHash(hashes, container, "default", Switch);
+
+        if (auto cases = container.find("cases"); cases != container.end() && cases->is_array())
+        {
+            for (const json &sCase : *cases)
+            {
+                if (sCase.is_string())
+                    addHash(hashes, sCase.get_ref<const std::string &>(), Switch);
+            }
+        }
+
+        if (auto containers = container.find("containers"); containers != container.end() && containers->is_array())
+        {
+            for (const json &child : *containers)
+                collectDLGE(hashes, child);
+        }
+    }
+
+    // The keys of an object, or of every object in an object (the languages of a LOCR).
+    void collectKeys(HashSections &hashes, const json &object, HashSection section, bool nested)
+    {
+        if (!object.is_object())
+            return;
+
+        for (const auto &[key, value] : object.items())
+        {
+            if (nested)
+                collectKeys(hashes, value, section, false);
+            else
+                addHash(hashes, key, section);
+        }
+    }
+} // namespace
+
+std::unordered_map<uint32_t, uint8_t> collectUnknownHashes(const std::filesystem::path &corpus)
+{
+    HashSections hashes;
+
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(corpus))
+    {
+        std::string name = entry.path().filename().string();
+        if (!entry.is_regular_file() || !name.ends_with(".json") || name.ends_with(".meta.json"))
+            continue;
+
+        std::ifstream stream(entry.path(), std::ios::binary);
+        json file = json::parse(stream, nullptr, false);
+        if (!file.is_object())
+            continue;
+
+        auto schema = file.find("$schema");
+        if (schema == file.end() || !schema->is_string())
+            continue;
+
+        const std::string &type = schema->get_ref<const std::string &>();
+        if (type.ends_with("/locr.schema.json") && file.contains("languages"))
+            collectKeys(hashes, file["languages"], Line, true);
+        else if (type.ends_with("/ditl.schema.json") && file.contains("soundtags"))
+            collectKeys(hashes, file["soundtags"], Soundtag, false);
+        else if (type.ends_with("/dlge.schema.json") && file.contains("rootContainer"))
+            collectDLGE(hashes, file["rootContainer"]);
+    }
+
+    return hashes;
+}
+#pragma endregion
+
+#pragma region Cracking
+namespace
+{
+    // The same CRC32 as the hash list (and zlib), one byte at a time, as candidates are only a few bytes past the prefix.
+    constexpr std::array<uint32_t, 256> crcTable = [] {
+        std::array<uint32_t, 256> table{};
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t crc = i;
+            for (int k = 0; k < 8; k++)
+                crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+
+            table[i] = crc;
+        }
+
+        return table;
+    }();
+
+    // Every table entry has a different top byte, so the entry a byte was shifted in with can be found from the state
+    // it gave. That's what lets a CRC be run backwards.
+    constexpr std::array<uint8_t, 256> crcIndexByTop = [] {
+        std::array<uint8_t, 256> index{};
+        for (uint32_t i = 0; i < 256; i++)
+            index[crcTable[i] >> 24] = (uint8_t)i;
+
+        return index;
+    }();
+
+    inline uint32_t crcExtend(uint32_t state, std::string_view str)
+    {
+        for (unsigned char c : str)
+            state = (state >> 8) ^ crcTable[(state ^ c) & 0xFF];
+
+        return state;
+    }
+
+    // The state that crcExtend would take to the given one with str.
+    inline uint32_t crcRetract(uint32_t state, std::string_view str)
+    {
+        for (size_t i = str.size(); i-- > 0;)
+        {
+            uint8_t index = crcIndexByTop[state >> 24];
+            state = ((state ^ crcTable[index]) << 8) | (uint8_t)(index ^ (unsigned char)str[i]);
+        }
+
+        return state;
+    }
+
+    // The state a candidate has to be in before a suffix to hash to a target.
+    struct Requirement
+    {
+        uint32_t state;
+        uint32_t target;
+        uint32_t suffix;
+    };
+
+    // Every target run backwards through a range of suffixes. A candidate is then hashed once (without its suffix)
+    // and checked against every suffix at once, instead of being hashed again for each one.
+    class RequirementTable
+    {
+    public:
+        RequirementTable(const std::vector<uint32_t> &targets, const std::vector<std::string> &suffixes, size_t begin, size_t end)
+        {
+            requirements.reserve(targets.size() * (end - begin));
+            for (size_t s = begin; s < end; s++)
+            {
+                for (size_t t = 0; t < targets.size(); t++)
+                    requirements.push_back({crcRetract(~targets[t], suffixes[s]), (uint32_t)t, (uint32_t)s});
+            }
+
+            std::sort(requirements.begin(), requirements.end(), [](const Requirement &a, const Requirement &b) {
+                return a.state < b.state;
+            });
+
+            // Almost every candidate misses, the filter turns those away with a single read.
+            size_t bits = 1 << 16;
+            while (bits < requirements.size() * 32 && bits < ((size_t)1 << 31))
+                bits *= 2;
+
+            filter.assign(bits / 64, 0);
+            mask = (uint32_t)(bits - 1);
+
+            for (const Requirement &requirement : requirements)
+                filter[(requirement.state & mask) >> 6] |= (uint64_t)1 << (requirement.state & 63);
+        }
+
+        bool mayContain(uint32_t state) const
+        {
+            uint32_t bit = state & mask;
+            return (filter[bit >> 6] >> (bit & 63)) & 1;
+        }
+
+        std::span<const Requirement> find(uint32_t state) const
+        {
+            auto [first, last] = std::equal_range(requirements.begin(), requirements.end(), Requirement{state, 0, 0},
+                [](const Requirement &a, const Requirement &b) { return a.state < b.state; });
+
+            return {first, last};
+        }
+
+    private:
+        std::vector<Requirement> requirements;
+        std::vector<uint64_t> filter;
+        uint32_t mask = 0;
+    };
+
+    // A hit and where it is in the order candidates are generated in: depth, prefix, words, suffix.
+    struct Found
+    {
+        uint32_t hash;
+        std::vector<uint32_t> order;
+        std::string value;
+    };
+
+    // A range of first words after a prefix, with every combination of the words after them up to a depth.
+    struct WorkItem
+    {
+        uint32_t depth;
+        uint32_t prefix;
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    uint64_t saturatingMultiply(uint64_t a, uint64_t b)
+    {
+        return b && a > UINT64_MAX / b ? UINT64_MAX : a * b;
+    }
+
+    class Search
+    {
+    public:
+        Search(const CrackOptions &options, const RequirementTable &table, const std::vector<uint32_t> &targets)
+            : options(options), table(table), targets(targets)
+        {
+        }
+
+        void run(const WorkItem &item, uint32_t prefixState)
+        {
+            current = item;
+            path.clear();
+
+            for (uint32_t w = item.begin; w < item.end; w++)
+            {
+                uint32_t state = crcExtend(prefixState, options.words[w]);
+                if (item.depth == 1)
+                    check(state, w);
+                else
+                {
+                    path.push_back(w);
+                    words(state);
+                    path.pop_back();
+                }
+            }
+        }
+
+        std::vector<Found> found;
+
+    private:
+        const CrackOptions &options;
+        const RequirementTable &table;
+        const std::vector<uint32_t> &targets;
+
+        WorkItem current{};
+        std::vector<uint32_t> path;
+
+        // The state is after the prefix and the words in the path, the last level is checked as it is hashed.
+        void words(uint32_t state)
+        {
+            state = crcExtend(state, options.separator);
+
+            bool last = path.size() + 1 == current.depth;
+            for (uint32_t w = 0; w < (uint32_t)options.words.size(); w++)
+            {
+                uint32_t next = crcExtend(state, options.words[w]);
+                if (last)
+                    check(next, w);
+                else
+                {
+                    path.push_back(w);
+                    words(next);
+                    path.pop_back();
+                }
+            }
+        }
+
+        void check(uint32_t state, uint32_t word)
+        {
+            if (!table.mayContain(state))
+                return;
+
+            for (const Requirement &requirement : table.find(state))
+            {
+                Found hit{targets[requirement.target], {current.depth, current.prefix}, options.prefixes[current.prefix]};
+                for (uint32_t w : path)
+                {
+                    hit.value += hit.order.size() > 2 ? options.separator : "";
+                    hit.value += options.words[w];
+                    hit.order.push_back(w);
+                }
+
+                hit.value += path.empty() ? "" : options.separator;
+                hit.value += options.words[word];
+                hit.value += options.suffixes[requirement.suffix];
+                hit.order.push_back(word);
+                hit.order.push_back(requirement.suffix);
+
+                found.push_back(std::move(hit));
+            }
+        }
+    };
+} // namespace
+
+CrackResult crackHashes(const std::vector<uint32_t> &targets, const CrackOptions &options)
+{
+    CrackResult result;
+    if (targets.empty() || options.words.empty() || options.prefixes.empty() || options.suffixes.empty())
+        return result;
+
+    const uint64_t wordCount = options.words.size();
+
+    for (size_t depth = 1; depth <= options.depth; depth++)
+    {
+        uint64_t count = saturatingMultiply(options.prefixes.size(), options.suffixes.size());
+        for (size_t i = 0; i < depth; i++)
+            count = saturatingMultiply(count, wordCount);
+
+        result.candidates = count > UINT64_MAX - result.candidates ? UINT64_MAX : result.candidates + count;
+    }
+
+    // Items are sized to a few thousand candidates (before suffixes), so threads share the work evenly.
+    std::vector<WorkItem> items;
+    for (uint32_t depth = 1; depth <= (uint32_t)options.depth; depth++)
+    {
+        uint64_t perWord = 1;
+        for (uint32_t i = 1; i < depth; i++)
+            perWord = saturatingMultiply(perWord, wordCount);
+
+        uint32_t block = (uint32_t)std::clamp<uint64_t>(4096 / perWord, 1, wordCount);
+        for (uint32_t prefix = 0; prefix < (uint32_t)options.prefixes.size(); prefix++)
+        {
+            for (uint32_t begin = 0; begin < wordCount; begin += block)
+                items.push_back({depth, prefix, begin, (uint32_t)std::min<uint64_t>(begin + block, wordCount)});
+        }
+    }
+
+    std::vector<uint32_t> prefixStates;
+    for (const std::string &prefix : options.prefixes)
+        prefixStates.push_back(crcExtend(0xFFFFFFFF, prefix));
+
+    unsigned threadCount = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<Found> found;
+    std::mutex foundMutex;
+
+    auto start = std::chrono::steady_clock::now();
+
+    // The suffixes are split up so the table of every target behind every suffix stays a reasonable size.
+    size_t suffixesPerTable = std::max<size_t>(1, ((size_t)1 << 22) / targets.size());
+    for (size_t begin = 0; begin < options.suffixes.size(); begin += suffixesPerTable)
+    {
+        RequirementTable table(targets, options.suffixes, begin, std::min(begin + suffixesPerTable, options.suffixes.size()));
+        std::atomic<size_t> next = 0;
+
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < threadCount; t++)
+        {
+            threads.emplace_back([&] {
+                Search search(options, table, targets);
+                for (size_t i = next++; i < items.size(); i = next++)
+                    search.run(items[i], prefixStates[items[i].prefix]);
+
+                std::lock_guard lock(foundMutex);
+                std::move(search.found.begin(), search.found.end(), std::back_inserter(found));
+            });
+        }
+
+        for (std::thread &thread : threads)
+            thread.join();
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::sort(found.begin(), found.end(), [](const Found &a, const Found &b) {
+        return a.hash != b.hash ? a.hash < b.hash : a.order < b.order;
+    });
+
+    for (Found &hit : found)
+        result.hits.push_back({hit.hash, std::move(hit.value)});
+
+    return result;
+}
+#pragma endregion
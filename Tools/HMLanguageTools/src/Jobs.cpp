@@ -0,0 +1,272 @@
+#include "Jobs.h"
+#include "RebuildCache.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <optional>
+
+using namespace TonyTools::Language;
+
+namespace
+{
+    std::string toUpper(std::string str)
+    {
+        std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return std::toupper(c); });
+        return str;
+    }
+
+    const char* versionName(Version version)
+    {
+        switch (version)
+        {
+        case Version::H2016:
+            return "H2016";
+        case Version::H2:
+            return "H2";
+        default:
+            return "H3";
+        }
+    }
+
+    // Kept per thread and reused for every job the thread runs.
+    struct Buffers
+    {
+        std::vector<char> input;
+        std::vector<char> meta;
+        std::string json;
+        Rebuilt rebuilt;
+    };
+
+    thread_local Buffers buffers;
+} // namespace
+
+bool parseJob(std::span<const std::string> args, Job &job, std::string &error)
+{
+    std::vector<std::string_view> positional;
+    bool metaPathSet = false;
+
+    for (size_t i = 0; i < args.size(); i++)
+    {
+        const std::string &arg = args[i];
+        if (!arg.starts_with("--"))
+        {
+            positional.push_back(arg);
+            continue;
+        }
+
+        if (arg == "--hexprecision")
+            job.hexPrecision = true;
+        else if (arg == "--symmetric")
+            job.symmetric = true;
+        else if (arg == "--metapath" || arg == "--langmap" || arg == "--defaultlocale")
+        {
+            if (++i == args.size())
+            {
+                error = arg + ": expected 1 argument.";
+                return false;
+            }
+
+            if (arg == "--metapath")
+            {
+                job.metaPath = args[i];
+                metaPathSet = true;
+            }
+            else if (arg == "--langmap")
+                job.langMap = LanguageMap(args[i]);
+            else
+                job.defaultLocale = args[i];
+        }
+        else
+        {
+            error = "Unknown argument " + arg + ".";
+            return false;
+        }
+    }
+
+    if (positional.size() != 5)
+    {
+        error = "Expected mode, game, type, input_path and output_path.";
+        return false;
+    }
+
+    std::string mode = toUpper(std::string(positional[0]));
+    if (mode != "CONVERT" && mode != "REBUILD")
+    {
+        error = "Invalid mode. Must be \"convert\" or \"rebuild\"";
+        return false;
+    }
+    job.rebuild = mode == "REBUILD";
+
+    std::string game = toUpper(std::string(positional[1]));
+    if (game == "H2016")
+        job.version = Version::H2016;
+    else if (game == "H2")
+        job.version = Version::H2;
+    else if (game == "H3")
+        job.version = Version::H3;
+    else
+    {
+        error = "Invalid game specified.";
+        return false;
+    }
+
+    job.type = toUpper(std::string(positional[2]));
+    if (job.type != "CLNG" && job.type != "DITL" && job.type != "DLGE" && job.type != "LOCR" && job.type != "RTLV")
+    {
+        error = "Invalid type specified.";
+        return false;
+    }
+
+    job.inputPath = positional[3];
+    job.outputPath = positional[4];
+    if (!metaPathSet)
+        job.metaPath = (job.rebuild ? job.outputPath : job.inputPath).string() + ".meta.json";
+
+    return true;
+}
+
+std::vector<std::string> jobArguments(const Job &job)
+{
+    std::vector<std::string> args = {
+        job.rebuild ? "rebuild" : "convert",
+        versionName(job.version),
+        job.type,
+        job.inputPath.string(),
+        job.outputPath.string(),
+        "--metapath",
+        job.metaPath.string(),
+        "--defaultlocale",
+        job.defaultLocale
+    };
+
+    if (!job.langMap.empty())
+    {
+        args.push_back("--langmap");
+        args.push_back(std::string(job.langMap.str()));
+    }
+
+    if (job.hexPrecision)
+        args.push_back("--hexprecision");
+
+    if (job.symmetric)
+        args.push_back("--symmetric");
+
+    return args;
+}
+
+JobResult runJob(const Job &job, RebuildCache *cache, Stats *stats)
+{
+    Buffers &b = buffers;
+    std::optional<StatsScope> statsScope;
+
+    if (!readFileData(job.inputPath, b.input))
+        return {false, "Could not read the input file " + job.inputPath.string() + "!"};
+
+    if (!job.rebuild)
+    {
+        if (!readFileData(job.metaPath, b.meta))
+            return {false, "Could not read the meta " + job.metaPath.string() + "! Please specify it with --metapath!"};
+
+        std::string_view meta(b.meta.data(), b.meta.size());
+        bool ok = false;
+        b.json.clear();
+
+        if (stats)
+            statsScope.emplace(*stats);
+
+        if (job.type == "CLNG")
+            ok = CLNG::ConvertInto(b.json, job.version, b.input, meta, job.langMap);
+        else if (job.type == "DITL")
+            ok = DITL::ConvertInto(b.json, b.input, meta);
+        else if (job.type == "DLGE")
+            ok = DLGE::ConvertInto(b.json, job.version, b.input, meta, job.defaultLocale, job.hexPrecision, job.langMap);
+        else if (job.type == "LOCR")
+            ok = LOCR::ConvertInto(b.json, job.version, b.input, meta, job.langMap, job.symmetric);
+        else if (job.type == "RTLV")
+            ok = RTLV::ConvertInto(b.json, job.version, b.input, meta);
+        else
+            return {false, "Invalid type specified."};
+
+        statsScope.reset();
+
+        if (!ok)
+            return {false, "Failed to convert " + job.type + " to JSON!"};
+
+        if (!writeFileData(job.outputPath, b.json))
+            return {false, "Could not write " + job.outputPath.string() + "!"};
+
+        return {true, "Successfully converted " + job.type + " to JSON!"};
+    }
+
+    std::string_view json(b.input.data(), b.input.size());
+    Rebuilt &rebuilt = b.rebuilt;
+
+    // One snapshot of the hash list for the whole rebuild, so a reload in the meantime can't have the output of one
+    // list stored under the key of another.
+    HashListContext hashList;
+    hashList.Share(HashListContext::Default());
+
+    std::string key = cache ? cache->key(job, json, hashList) : std::string();
+    bool cached = cache && cache->get(key, rebuilt);
+
+    if (!cached)
+    {
+        if (stats)
+            statsScope.emplace(*stats);
+
+        if (job.type == "CLNG")
+            CLNG::RebuildInto(rebuilt, json);
+        else if (job.type == "DITL")
+            DITL::RebuildInto(rebuilt, json, hashList);
+        else if (job.type == "DLGE")
+            DLGE::RebuildInto(rebuilt, job.version, json, job.defaultLocale, job.langMap, hashList);
+        else if (job.type == "LOCR")
+            LOCR::RebuildInto(rebuilt, job.version, json, job.symmetric, hashList);
+        else if (job.type == "RTLV")
+            RTLV::RebuildInto(rebuilt, job.version, json, job.langMap);
+        else
+            return {false, "Invalid type specified."};
+
+        statsScope.reset();
+    }
+
+    if (rebuilt.file.empty() || rebuilt.meta.empty())
+        return {false, "Failed to convert JSON to " + job.type + "!"};
+
+    if (cache && !cached)
+        cache->put(key, rebuilt);
+
+    if (!writeFileData(job.outputPath, rebuilt.file) || !writeFileData(job.metaPath, rebuilt.meta))
+        return {false, "Could not write " + job.outputPath.string() + " or its meta!"};
+
+    return {true, cached ? "Copied the cached " + job.type + " + meta!" : "Successfully converted JSON to " + job.type + " + meta!"};
+}
+
+bool readFileData(const std::filesystem::path &path, std::vector<char> &data)
+{
+    std::error_code ec;
+    uintmax_t size = std::filesystem::file_size(path, ec);
+    if (ec)
+        return false;
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.good())
+        return false;
+
+    data.resize((size_t)size);
+    file.read(data.data(), (std::streamsize)size);
+    data.resize((size_t)file.gcount());
+
+    return true;
+}
+
+bool writeFileData(const std::filesystem::path &path, std::span<const char> data)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file.good())
+        return false;
+
+    file.write(data.data(), (std::streamsize)data.size());
+    return file.good();
+}
@@ -0,0 +1,206 @@
+#include "RebuildCache.h"
+#include "Jobs.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <hash/sha256.h>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+using namespace TonyTools::Language;
+
+namespace
+{
+    // Bumped whenever the entry layout (or what goes into the key) changes.
+    constexpr uint32_t cacheFormat = 1;
+    constexpr char entryMagic[4] = {'H', 'M', 'L', 'C'};
+    constexpr size_t headerSize = 12;
+
+    // Length prefixed, so no two different sets of fields hash the same bytes.
+    void addField(SHA256 &sha, std::string_view field)
+    {
+        uint64_t size = field.size();
+        sha.add(&size, sizeof(size));
+        sha.add(field.data(), field.size());
+    }
+
+    void putU32(char* ptr, uint32_t value)
+    {
+        for (int i = 0; i < 4; i++)
+            ptr[i] = (char)(value >> (i * 8));
+    }
+
+    uint32_t getU32(const char* ptr)
+    {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++)
+            value |= (uint32_t)(uint8_t)ptr[i] << (i * 8);
+        return value;
+    }
+} // namespace
+
+RebuildCache::RebuildCache(const std::filesystem::path &directory, uint64_t maxBytes)
+    : directory(directory), maxBytes(maxBytes)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+}
+
+std::string RebuildCache::key(const Job &job, std::string_view json, const HashListContext &hashList) const
+{
+    HashList::Status status = hashList.GetStatus();
+    std::string settings = std::to_string(cacheFormat) + " " + toolVersion + " " + std::to_string((int)job.version) + " "
+        + std::to_string(job.symmetric) + " " + std::to_string(status.loaded) + " " + std::to_string(status.version);
+
+    SHA256 sha;
+    addField(sha, settings);
+    addField(sha, job.type);
+    addField(sha, job.langMap.str());
+    addField(sha, job.defaultLocale);
+    addField(sha, json);
+    return sha.getHash();
+}
+
+// Spread over 256 directories, so none of them ends up with every entry.
+std::filesystem::path RebuildCache::entryPath(const std::string &key) const
+{
+    return directory / key.substr(0, 2) / (key + ".bin");
+}
+
+bool RebuildCache::get(const std::string &key, Rebuilt &output)
+{
+    std::filesystem::path path = entryPath(key);
+    std::vector<char> entry;
+    bool valid = readFileData(path, entry) && entry.size() >= headerSize && std::memcmp(entry.data(), entryMagic, 4) == 0
+        && (uint64_t)headerSize + getU32(&entry[4]) + getU32(&entry[8]) == entry.size() && getU32(&entry[4]) && getU32(&entry[8]);
+
+    {
+        std::lock_guard lock(mutex);
+        (valid ? counts.hits : counts.misses)++;
+    }
+
+    if (!valid)
+        return false;
+
+    uint32_t fileSize = getU32(&entry[4]);
+    output.file.assign(entry.begin() + headerSize, entry.begin() + headerSize + fileSize);
+    output.meta.assign(entry.begin() + headerSize + fileSize, entry.end());
+
+    // Marks it as recently used for eviction.
+    std::error_code ec;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+
+    return true;
+}
+
+void RebuildCache::put(const std::string &key, const Rebuilt &rebuilt)
+{
+    std::filesystem::path path = entryPath(key);
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    std::vector<char> entry(headerSize);
+    std::memcpy(entry.data(), entryMagic, 4);
+    putU32(&entry[4], (uint32_t)rebuilt.file.size());
+    putU32(&entry[8], (uint32_t)rebuilt.meta.size());
+    entry.insert(entry.end(), rebuilt.file.begin(), rebuilt.file.end());
+    entry.insert(entry.end(), rebuilt.meta.begin(), rebuilt.meta.end());
+
+    // Written under a name only this thread (of this process, as processes can share the cache) uses, then renamed,
+    // so a reader never sees half an entry.
+    std::ostringstream temp;
+    temp << key << "." << getpid() << "." << std::this_thread::get_id() << ".tmp";
+    std::filesystem::path tempPath = path.parent_path() / temp.str();
+    if (!writeFileData(tempPath, entry))
+    {
+        std::filesystem::remove(tempPath, ec);
+        return;
+    }
+
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec)
+    {
+        std::filesystem::remove(tempPath, ec);
+        return;
+    }
+
+    std::lock_guard lock(mutex);
+    counts.stored++;
+
+    if (!scanned)
+    {
+        // The entry just stored is counted by the scan.
+        scanned = true;
+        for (const auto &file : std::filesystem::recursive_directory_iterator(directory, ec))
+        {
+            if (file.is_regular_file(ec) && file.path().extension() == ".bin")
+                totalBytes += file.file_size(ec);
+        }
+    }
+    else
+        totalBytes += entry.size();
+
+    if (totalBytes > maxBytes)
+        evict();
+}
+
+// Called with the mutex held.
+void RebuildCache::evict()
+{
+    struct Entry
+    {
+        std::filesystem::file_time_type time;
+        uint64_t size;
+        std::filesystem::path path;
+    };
+
+    std::error_code ec;
+    std::vector<Entry> entries;
+    totalBytes = 0;
+    for (const auto &file : std::filesystem::recursive_directory_iterator(directory, ec))
+    {
+        if (!file.is_regular_file(ec) || file.path().extension() != ".bin")
+            continue;
+
+        Entry entry{file.last_write_time(ec), file.file_size(ec), file.path()};
+        totalBytes += entry.size;
+        entries.push_back(std::move(entry));
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.time < b.time; });
+
+    uint64_t target = maxBytes / 10 * 9;
+    for (const Entry &entry : entries)
+    {
+        if (totalBytes <= target)
+            break;
+
+        if (std::filesystem::remove(entry.path, ec))
+        {
+            totalBytes -= entry.size;
+            counts.evicted++;
+        }
+    }
+}
+
+RebuildCache::Stats RebuildCache::stats() const
+{
+    std::lock_guard lock(mutex);
+    return counts;
+}
+
+std::string RebuildCache::summary() const
+{
+    Stats s = stats();
+    return std::to_string(s.hits) + " hits, " + std::to_string(s.misses) + " misses, " + std::to_string(s.stored) + " stored, "
+        + std::to_string(s.evicted) + " evicted";
+}
@@ -0,0 +1,391 @@
+#include "Server.h"
+#include "Jobs.h"
+#include "RebuildCache.h"
+#include "WorkerPool.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <argparse/argparse.hpp>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <afunix.h>
+#include <fcntl.h>
+#include <io.h>
+using Socket = SOCKET;
+#define closeSocket closesocket
+#define SEND_FLAGS 0
+#define dup _dup
+#define dup2 _dup2
+#define fdopen _fdopen
+#define fileno _fileno
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+using Socket = int;
+constexpr Socket INVALID_SOCKET = -1;
+#define closeSocket close
+#define SEND_FLAGS MSG_NOSIGNAL
+#endif
+
+using namespace TonyTools::Language;
+
+#define LOG(x) std::cout << x << std::endl
+#define LOG_AND_EXIT(x) std::cout << x << std::endl; std::exit(0)
+
+namespace
+{
+    // Arguments are a few paths, anything bigger than this isn't a request.
+    constexpr uint32_t maxRequestSize = 1 << 20;
+
+    void putU32(std::string &out, uint32_t value)
+    {
+        for (int i = 0; i < 4; i++)
+            out.push_back((char)(value >> (i * 8)));
+    }
+
+    uint32_t getU32(const char* ptr)
+    {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++)
+            value |= (uint32_t)(uint8_t)ptr[i] << (i * 8);
+        return value;
+    }
+
+    bool fillSocketAddress(sockaddr_un &address, const std::string &path)
+    {
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+            return false;
+
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return true;
+    }
+
+    // The responses are written to the real stdout, which is kept for them alone. Anything else written to stdout
+    // (i.e. by the library while a job runs) goes to stderr instead, where it can't be mistaken for a frame.
+    FILE* takeStdout()
+    {
+        std::fflush(stdout);
+
+        int fd = dup(fileno(stdout));
+        if (fd == -1 || dup2(fileno(stderr), fileno(stdout)) == -1)
+            return nullptr;
+
+#ifdef _WIN32
+        _setmode(fd, _O_BINARY);
+#endif
+        return fdopen(fd, "wb");
+    }
+
+    // A socket connection, or stdin and the stdout from takeStdout when there is no socket.
+    class Connection
+    {
+    public:
+        explicit Connection(FILE* out) : out(out) {}
+        explicit Connection(Socket socket) : socket(socket) {}
+
+        ~Connection()
+        {
+            if (socket != INVALID_SOCKET)
+                closeSocket(socket);
+        }
+
+        bool read(char* ptr, size_t size)
+        {
+            while (size)
+            {
+                size_t got;
+                if (socket == INVALID_SOCKET)
+                    got = std::fread(ptr, 1, size, stdin);
+                else
+                {
+                    int count = recv(socket, ptr, (int)std::min<size_t>(size, 1 << 30), 0);
+                    got = count > 0 ? (size_t)count : 0;
+                }
+
+                if (!got)
+                    return false;
+
+                ptr += got;
+                size -= got;
+            }
+            return true;
+        }
+
+        // Frames are written whole under the lock, as jobs on the same connection finish on different threads.
+        bool write(const std::string &frame)
+        {
+            std::lock_guard lock(mutex);
+
+            if (socket == INVALID_SOCKET)
+                return std::fwrite(frame.data(), 1, frame.size(), out) == frame.size() && std::fflush(out) == 0;
+
+            const char* ptr = frame.data();
+            size_t size = frame.size();
+            while (size)
+            {
+                int sent = send(socket, ptr, (int)std::min<size_t>(size, 1 << 30), SEND_FLAGS);
+                if (sent <= 0)
+                    return false;
+
+                ptr += sent;
+                size -= sent;
+            }
+            return true;
+        }
+
+        bool readFrame(std::string &frame)
+        {
+            char size[4];
+            if (!read(size, 4))
+                return false;
+
+            uint32_t frameSize = getU32(size);
+            if (frameSize > maxRequestSize)
+                return false;
+
+            frame.resize(frameSize);
+            return read(frame.data(), frame.size());
+        }
+
+        void respond(uint32_t id, const JobResult &result)
+        {
+            std::string frame;
+            putU32(frame, (uint32_t)(5 + result.message.size()));
+            putU32(frame, id);
+            frame.push_back(result.ok ? 1 : 0);
+            frame += result.message;
+            write(frame);
+        }
+
+    private:
+        Socket socket = INVALID_SOCKET;
+        FILE* out = nullptr;
+        std::mutex mutex;
+    };
+
+    // Reads requests until the connection is closed, the jobs run on the pool and respond when they finish.
+    void serveConnection(std::shared_ptr<Connection> connection, WorkerPool &pool, RebuildCache *cache, const std::filesystem::path &hashListPath)
+    {
+        std::string frame;
+        while (connection->readFrame(frame))
+        {
+            if (frame.size() < 4)
+                return;
+
+            uint32_t id = getU32(frame.data());
+            std::vector<std::string> args;
+            for (size_t pos = 4; pos < frame.size();)
+            {
+                size_t end = frame.find('\0', pos);
+                if (end == std::string::npos)
+                    end = frame.size();
+
+                args.emplace_back(frame, pos, end - pos);
+                pos = end + 1;
+            }
+
+            // The jobs already running keep the hash list they started with, and a list that fails to load leaves
+            // the current one in place. It's read rather than mapped, so the file can be rewritten while serving.
+            if (!args.empty() && args[0] == "reload")
+            {
+                std::string path = args.size() > 1 ? args[1] : hashListPath.string();
+                std::vector<char> data;
+                bool ok = readFileData(path, data) && HashListContext::Default().Load(std::move(data));
+                connection->respond(id, {ok, ok ? "Reloaded the hash list (version " + std::to_string(HashList::GetStatus().version) + ")!"
+                                                : "Failed to load the hash list " + path + ", the current one is kept!"});
+                continue;
+            }
+
+            if (!args.empty() && args[0] == "stats")
+            {
+                connection->respond(id, {true, cache ? "Cache: " + cache->summary() + "." : "There is no cache."});
+                continue;
+            }
+
+            Job job;
+            std::string error;
+            if (!parseJob(args, job, error))
+            {
+                connection->respond(id, {false, error});
+                continue;
+            }
+
+            pool.submit([connection, cache, id, job = std::move(job)] { connection->respond(id, runJob(job, cache)); });
+        }
+    }
+} // namespace
+
+int runServer(int argc, char *argv[], const std::filesystem::path &hashListPath)
+{
+    argparse::ArgumentParser server("HMLanguageTools serve");
+
+    server.add_argument("--socket")
+        .help("path of the Unix domain socket to listen on, requests are read from stdin if not given")
+        .nargs(1);
+
+    server.add_argument("--cache")
+        .help("directory to cache rebuilt files in, JSONs that haven't changed are copied from it instead of rebuilt")
+        .nargs(1);
+
+    server.add_argument("--cachesize")
+        .help("the size (in MB) the cache is kept under, the least recently used files are removed past it")
+        .default_value(1024)
+        .scan<'i', int>()
+        .nargs(1);
+
+    server.add_argument("--threads")
+        .help("the number of threads to use, defaults to every core")
+        .default_value(0)
+        .scan<'i', int>()
+        .nargs(1);
+
+    try
+    {
+        server.parse_args(argc - 1, argv + 1);
+    }
+    catch (const std::runtime_error &err)
+    {
+        LOG(err.what());
+        LOG_AND_EXIT(server);
+    }
+
+    std::optional<RebuildCache> cache;
+    if (server.is_used("--cache"))
+        cache.emplace(server.get<std::string>("--cache"), (uint64_t)std::max(1, server.get<int>("--cachesize")) << 20);
+
+    WorkerPool pool((unsigned)std::max(0, server.get<int>("--threads")));
+
+    if (!server.is_used("--socket"))
+    {
+#ifdef _WIN32
+        _setmode(_fileno(stdin), _O_BINARY);
+#endif
+        FILE* out = takeStdout();
+        if (!out)
+        {
+            std::cerr << "Could not take stdout for the responses!" << std::endl;
+            return 1;
+        }
+
+        std::cerr << "Serving requests from stdin on " << pool.size() << " threads." << std::endl;
+
+        serveConnection(std::make_shared<Connection>(out), pool, cache ? &*cache : nullptr, hashListPath);
+        pool.wait();
+        return 0;
+    }
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+
+    std::string socketPath = server.get<std::string>("--socket");
+    sockaddr_un address;
+    if (!fillSocketAddress(address, socketPath))
+    {
+        LOG("The socket path is too long!");
+        return 1;
+    }
+
+    // A socket left behind by a server that didn't exit cleanly would make bind fail.
+    std::error_code ec;
+    std::filesystem::remove(socketPath, ec);
+
+    Socket listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener == INVALID_SOCKET || bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 64) != 0)
+    {
+        LOG("Could not listen on " << socketPath << "!");
+        return 1;
+    }
+
+    LOG("Serving requests on " << socketPath << " on " << pool.size() << " threads.");
+
+    while (true)
+    {
+        Socket client = accept(listener, nullptr, nullptr);
+        if (client == INVALID_SOCKET)
+            continue;
+
+        std::thread(serveConnection, std::make_shared<Connection>(client), std::ref(pool), cache ? &*cache : nullptr, std::cref(hashListPath)).detach();
+    }
+}
+
+int runClient(int argc, char *argv[])
+{
+    if (argc < 4)
+    {
+        LOG("usage: HMLanguageTools client socket_path mode game type input_path output_path [options]");
+        LOG("       HMLanguageTools client socket_path reload [hash_list_path]");
+        LOG("       HMLanguageTools client socket_path stats");
+        return 1;
+    }
+
+    std::vector<std::string> args(argv + 3, argv + argc);
+
+    // The server resolves paths from its own working directory, so they are sent absolute.
+    if (args[0] == "reload")
+    {
+        if (args.size() > 1)
+            args[1] = std::filesystem::absolute(args[1]).string();
+    }
+    else if (args[0] != "stats")
+    {
+        Job job;
+        std::string error;
+        if (!parseJob(args, job, error))
+        {
+            LOG(error);
+            return 1;
+        }
+
+        job.inputPath = std::filesystem::absolute(job.inputPath);
+        job.outputPath = std::filesystem::absolute(job.outputPath);
+        job.metaPath = std::filesystem::absolute(job.metaPath);
+        args = jobArguments(job);
+    }
+
+    std::string payload;
+    putU32(payload, 0);
+    for (const std::string &arg : args)
+        payload.append(arg.c_str(), arg.size() + 1);
+
+    std::string frame;
+    putU32(frame, (uint32_t)payload.size());
+    frame += payload;
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+
+    sockaddr_un address;
+    Socket server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (!fillSocketAddress(address, argv[2]) || server == INVALID_SOCKET || connect(server, (sockaddr*)&address, sizeof(address)) != 0)
+    {
+        LOG("Could not connect to the server at " << argv[2] << "!");
+        return 1;
+    }
+
+    Connection connection(server);
+    std::string response;
+    if (!connection.write(frame) || !connection.readFrame(response) || response.size() < 5)
+    {
+        LOG("The server closed the connection!");
+        return 1;
+    }
+
+    LOG(response.substr(5));
+    return response[4] ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+#include "Stats.h"
+
+#include <cstdlib>
+#include <format>
+#include <new>
+
+using namespace TonyTools::Language;
+
+// The library can't see allocations itself, so every allocation the tool makes is offered to the stats of the
+// thread making it (which only counts it inside a StatsScope). The other forms of new and delete forward to these.
+void* operator new(std::size_t size)
+{
+    if (countAllocations)
+        Stats::CountAllocation(size);
+
+    while (true)
+    {
+        if (void* ptr = std::malloc(size ? size : 1))
+            return ptr;
+
+        std::new_handler handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+
+        handler();
+    }
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+std::string formatStats(const Stats &stats, size_t files)
+{
+    auto ms = [](uint64_t ns) { return ns / 1e6; };
+    auto percent = [&](uint64_t ns) { return stats.totalNanoseconds ? ns * 100.0 / stats.totalNanoseconds : 0.0; };
+
+    std::string out = std::format("Stats for {} file{}:\n", files, files == 1 ? "" : "s");
+
+    uint64_t phases = 0;
+    for (size_t i = 0; i < (size_t)Stats::Phase::Count; i++)
+    {
+        uint64_t ns = stats.phaseNanoseconds[i];
+        phases += ns;
+        out += std::format("    {:<16}{:>12.3f} ms {:>6.1f}%\n", Stats::PhaseNames[i], ms(ns), percent(ns));
+    }
+
+    uint64_t other = stats.totalNanoseconds > phases ? stats.totalNanoseconds - phases : 0;
+    out += std::format("    {:<16}{:>12.3f} ms {:>6.1f}%\n", "other", ms(other), percent(other));
+    out += std::format("    {:<16}{:>12.3f} ms\n", "total", ms(stats.totalNanoseconds));
+
+    uint64_t lookups = stats.hashHits + stats.hashMisses;
+    out += std::format("    {:<16}{:>12} bytes\n", "decrypted", stats.bytesDecrypted);
+    out += std::format("    {:<16}{:>12} bytes\n", "encrypted", stats.bytesEncrypted);
+    out += std::format("    {:<16}{:>12}\n", "strings", stats.strings);
+    out += std::format("    {:<16}{:>12} hits, {} misses ({:.1f}% hit)\n", "hash list", stats.hashHits, stats.hashMisses,
+                       lookups ? stats.hashHits * 100.0 / lookups : 0.0);
+    out += std::format("    {:<16}{:>12} ({:.2f} MB)", "allocations", stats.allocations, stats.allocatedBytes / (1024.0 * 1024.0));
+
+    return out;
+}
@@ -0,0 +1,108 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+WorkerPool::WorkerPool(unsigned threadCount)
+{
+    if (!threadCount)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned i = 0; i < threadCount; i++)
+        queues.push_back(std::make_unique<Queue>());
+
+    for (unsigned i = 0; i < threadCount; i++)
+        threads.emplace_back(&WorkerPool::work, this, i);
+}
+
+WorkerPool::~WorkerPool()
+{
+    wait();
+
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+void WorkerPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard lock(mutex);
+        pending++;
+    }
+
+    Queue &queue = *queues[nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size()];
+    {
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    queued.fetch_add(1);
+
+    // Taking the lock orders this with a thread that just found nothing and is about to wait.
+    {
+        std::lock_guard lock(mutex);
+    }
+    wake.notify_one();
+}
+
+void WorkerPool::wait()
+{
+    std::unique_lock lock(mutex);
+    idle.wait(lock, [&] { return pending == 0; });
+}
+
+// A thread's own queue is worked from the front, the others are stolen from the back.
+bool WorkerPool::take(size_t index, std::function<void()> &task)
+{
+    for (size_t i = 0; i < queues.size(); i++)
+    {
+        Queue &queue = *queues[(index + i) % queues.size()];
+        std::lock_guard lock(queue.mutex);
+        if (queue.tasks.empty())
+            continue;
+
+        if (i == 0)
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        else
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+
+        queued.fetch_sub(1);
+        return true;
+    }
+
+    return false;
+}
+
+void WorkerPool::work(size_t index)
+{
+    std::function<void()> task;
+    while (true)
+    {
+        if (take(index, task))
+        {
+            task();
+            task = nullptr;
+
+            std::lock_guard lock(mutex);
+            if (--pending == 0)
+                idle.notify_all();
+
+            continue;
+        }
+
+        std::unique_lock lock(mutex);
+        wake.wait(lock, [&] { return stopping || queued.load() > 0; });
+        if (stopping && queued.load() == 0)
+            return;
+    }
+}
@@ -3,10 +3,18 @@
 #include <iostream>
 #include <cassert>
 #include <iterator>
+#include <format>
+#include <optional>
 
 #include <argparse/argparse.hpp>
 #include <TonyTools/Languages.h>
 
+#include "HashCracker.h"
+#include "Jobs.h"
+#include "RebuildCache.h"
+#include "Server.h"
+#include "Stats.h"
+
 using namespace TonyTools::Language;
 
 #define LOG(x) std::cout << x << std::endl
@@ -15,7 +23,7 @@ using namespace TonyTools::Language;
 #pragma region EXE File Path
 #ifdef _WIN32
 #include <windows.h>
-#elif
+#else
 #include <unistd.h>
 #endif
 
@@ -37,7 +45,7 @@ std::filesystem::path GetExeDirectory()
 }
 #pragma endregion
 
-argparse::ArgumentParser program("HMLanguageTools", "v1.8.2");
+argparse::ArgumentParser program("HMLanguageTools", toolVersion);
 
 void toUppercase(std::string &inputstr)
 {
@@ -60,10 +68,12 @@ std::vector<char> readFile(std::string path, bool isMeta = false)
         LOG_AND_EXIT(program);
     }
 
-    // Load file data into vector
-    std::ifstream FILE(path, std::ifstream::binary);
-    std::vector<char> fileData((std::istreambuf_iterator<char>(FILE)), std::istreambuf_iterator<char>());
-    FILE.close();
+    std::vector<char> fileData;
+    if (!readFileData(path, fileData))
+    {
+        LOG("Could not read " << path << "!");
+        LOG_AND_EXIT(program);
+    }
 
     return fileData;
 }
@@ -85,14 +95,269 @@ void writeFile(std::string path, const char* ptr, size_t size)
     FILE.write(ptr, size);
 }
 
-int main(int argc, char *argv[])
+// Hash lists are written next to the path and renamed over it, never rewritten in place: a process that has the old
+// one mapped (a conversion, or a running serve) keeps reading the old file instead of crashing on a truncated one.
+bool writeHashList(const std::string &path, std::span<const char> data)
+{
+    std::filesystem::path temp = path + ".tmp";
+    std::error_code ec;
+    if (writeFileData(temp, data))
+    {
+        std::filesystem::rename(temp, path, ec);
+        if (!ec)
+            return true;
+    }
+
+    std::filesystem::remove(temp, ec);
+    LOG("Could not write the hash list to " << path << "!");
+    return false;
+}
+
+// Converts a hash list to the precompiled (v2) format, it has its own arguments so is handled before the main parser.
+int compileHashList(int argc, char *argv[])
+{
+    argparse::ArgumentParser compiler("HMLanguageTools compilehashlist");
+
+    compiler.add_argument("input_path")
+        .help("path to the hash list")
+        .required();
+
+    compiler.add_argument("output_path")
+        .help("path to write the precompiled hash list to")
+        .required();
+
+    try
+    {
+        compiler.parse_args(argc - 1, argv + 1);
+    }
+    catch (const std::runtime_error &err)
+    {
+        LOG(err.what());
+        LOG_AND_EXIT(compiler);
+    }
+
+    std::vector<char> compiled = HashList::Compile(readFile(compiler.get<std::string>("input_path")));
+    if (compiled.empty())
+    {
+        LOG("Failed to compile the hash list! Make sure it is a valid (v1) hash list.");
+        return 1;
+    }
+
+    if (!writeHashList(compiler.get<std::string>("output_path"), compiled))
+        return 1;
+
+    LOG("Successfully compiled the hash list!");
+
+    return 0;
+}
+
+// One string per line, empty lines are only kept if asked for (an empty prefix or suffix means none).
+std::vector<std::string> readLines(const std::string &path, bool keepEmpty)
+{
+    std::vector<char> data = readFile(path);
+    std::vector<std::string> lines;
+
+    std::string_view view(data.data(), data.size());
+    while (!view.empty())
+    {
+        size_t end = std::min(view.find('\n'), view.size());
+        std::string_view line = view.substr(0, end);
+        if (line.ends_with('\r'))
+            line.remove_suffix(1);
+
+        if (keepEmpty || !line.empty())
+            lines.emplace_back(line);
+
+        view.remove_prefix(std::min(end + 1, view.size()));
+    }
+
+    return lines;
+}
+
+// Cracks the unknown hashes of a directory of converted files and writes the hash list with them added,
+// it has its own arguments so is handled before the main parser.
+int crackHashList(int argc, char *argv[])
+{
+    argparse::ArgumentParser cracker("HMLanguageTools crackhashes");
+
+    cracker.add_argument("corpus_path")
+        .help("path to a directory of converted DITL, DLGE, and LOCR JSON files")
+        .required();
+
+    cracker.add_argument("wordlist")
+        .help("path to the wordlist, one word per line")
+        .required();
+
+    cracker.add_argument("output_path")
+        .help("path to write the hash list with the cracked hashes to")
+        .required();
+
+    cracker.add_argument("--hashlist")
+        .help("path to the hash list to add to, defaults to the one next to the exe")
+        .nargs(1);
+
+    cracker.add_argument("--prefixes")
+        .help("path to a list of prefixes, an empty line is no prefix")
+        .nargs(1);
+
+    cracker.add_argument("--suffixes")
+        .help("path to a list of suffixes, an empty line is no suffix")
+        .nargs(1);
+
+    cracker.add_argument("--separator")
+        .help("what words are joined with")
+        .default_value(std::string(""))
+        .nargs(1);
+
+    cracker.add_argument("--depth")
+        .help("the most words to join together")
+        .default_value(1)
+        .scan<'i', int>()
+        .nargs(1);
+
+    cracker.add_argument("--threads")
+        .help("the number of threads to use, defaults to every core")
+        .default_value(0)
+        .scan<'i', int>()
+        .nargs(1);
+
+    try
+    {
+        cracker.parse_args(argc - 1, argv + 1);
+    }
+    catch (const std::runtime_error &err)
+    {
+        LOG(err.what());
+        LOG_AND_EXIT(cracker);
+    }
+
+    std::string hashListPath = cracker.is_used("--hashlist") ? cracker.get<std::string>("--hashlist") : (GetExeDirectory() / "hash_list.hmla").string();
+    std::vector<char> hashList;
+    if (std::filesystem::exists(hashListPath))
+        hashList = readFile(hashListPath);
+    else
+        LOG("[WARN] Hash list not found! A new one will be written with only the cracked hashes.");
+
+    std::string corpusPath = cracker.get<std::string>("corpus_path");
+    if (!std::filesystem::is_directory(corpusPath))
+    {
+        LOG("The corpus path is not a directory!");
+        return 1;
+    }
+
+    std::unordered_map<uint32_t, uint8_t> unknown = collectUnknownHashes(corpusPath);
+
+    size_t counts[3] = {};
+    std::vector<uint32_t> targets;
+    for (const auto &[hash, sections] : unknown)
+    {
+        targets.push_back(hash);
+        counts[0] += (sections & Soundtag) != 0;
+        counts[1] += (sections & Switch) != 0;
+        counts[2] += (sections & Line) != 0;
+    }
+    std::sort(targets.begin(), targets.end());
+
+    LOG("Found " << targets.size() << " unknown hashes (" << counts[0] << " soundtags, " << counts[1] << " switches, " << counts[2] << " lines).");
+
+    CrackOptions options;
+    options.words = readLines(cracker.get<std::string>("wordlist"), false);
+    if (cracker.is_used("--prefixes"))
+        options.prefixes = readLines(cracker.get<std::string>("--prefixes"), true);
+    if (cracker.is_used("--suffixes"))
+        options.suffixes = readLines(cracker.get<std::string>("--suffixes"), true);
+    options.separator = cracker.get<std::string>("--separator");
+    options.depth = (size_t)std::max(1, cracker.get<int>("--depth"));
+    options.threads = (unsigned)std::max(0, cracker.get<int>("--threads"));
+
+    CrackResult result = crackHashes(targets, options);
+
+    // Anything can collide with a CRC32, given enough candidates some hits will be chance.
+    double chance = (double)result.candidates * targets.size() / 4294967296.0;
+    LOG("Tried " << result.candidates << " candidates in " << result.seconds << "s (" << (uint64_t)(result.candidates / std::max(result.seconds, 1e-9)) << " candidates/s).");
+    if (chance >= 0.1)
+        LOG("[WARN] Around " << std::format("{:.1f}", chance) << " hits are expected by chance alone, check them before using the hash list!");
+
+    HashList::Entries entries;
+    size_t cracked = 0;
+    for (size_t i = 0; i < result.hits.size(); i++)
+    {
+        const CrackHit &hit = result.hits[i];
+        LOG(std::format("{:08X}", hit.hash) << " " << hit.value);
+
+        // A hash can be hit more than once, the first candidate is the one added.
+        if (i && result.hits[i - 1].hash == hit.hash)
+            continue;
+
+        uint8_t sections = unknown[hit.hash];
+        if (sections & Soundtag)
+            entries.soundtags.push_back({hit.hash, hit.value});
+        if (sections & Switch)
+            entries.switches.push_back({hit.hash, hit.value});
+        if (sections & Line)
+            entries.lines.push_back({hit.hash, hit.value});
+
+        cracked++;
+    }
+
+    LOG("Cracked " << cracked << " of " << targets.size() << " hashes.");
+
+    std::vector<char> extended = HashList::Extend(hashList, entries);
+    if (extended.empty())
+    {
+        LOG("Failed to add to the hash list! Make sure it is a valid hash list.");
+        return 1;
+    }
+
+    if (!writeHashList(cracker.get<std::string>("output_path"), extended))
+        return 1;
+
+    LOG("Successfully wrote the hash list!");
+
+    return 0;
+}
+
+// The serve mode answers on stdout, so it has the warnings written to stderr instead. It also reads the hash list
+// rather than mapping it, as the file may be replaced (or rewritten) while it runs.
+void loadHashList(std::ostream &log, bool mapped)
 {
     std::string HLPath = (GetExeDirectory() / "hash_list.hmla").string();
     if (std::filesystem::exists(HLPath)) {
-        HashList::Load(readFile(HLPath));
+        // Mapping it means only the sections a job actually uses get indexed.
+        std::vector<char> data;
+        bool loaded = mapped ? HashList::LoadFile(HLPath) : readFileData(HLPath, data) && HashList::Load(std::move(data));
+        if (!loaded)
+            log << "[WARN] Failed to load the hash list! It will not be used." << std::endl;
     } else {
-        LOG("[WARN] Hash list not found next to exe! It will not be loaded.");
+        log << "[WARN] Hash list not found next to exe! It will not be loaded." << std::endl;
     }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && std::string(argv[1]) == "compilehashlist")
+        return compileHashList(argc, argv);
+
+    if (argc > 1 && std::string(argv[1]) == "crackhashes")
+        return crackHashList(argc, argv);
+
+    // The client only sends the job, the server has the hash list.
+    if (argc > 1 && std::string(argv[1]) == "client")
+        return runClient(argc, argv);
+
+    if (argc > 1 && std::string(argv[1]) == "serve")
+    {
+        loadHashList(std::cerr, false);
+        return runServer(argc, argv, GetExeDirectory() / "hash_list.hmla");
+    }
+
+    loadHashList(std::cout, true);
+
+    if (argc > 1 && std::string(argv[1]) == "batch")
+        return runBatch(argc, argv);
+
+    if (argc > 1 && std::string(argv[1]) == "verify")
+        return runVerify(argc, argv);
 
     // Define arguments
     program.add_argument("mode")
@@ -137,6 +402,21 @@ int main(int argc, char *argv[])
         .help("if a symmetric cipher should be used, early H2016 LOCR only.")
         .default_value(false)
         .implicit_value(true);
+
+    program.add_argument("--cache")
+        .help("directory to cache rebuilt files in, JSONs that haven't changed are copied from it instead of rebuilt")
+        .nargs(1);
+
+    program.add_argument("--cachesize")
+        .help("the size (in MB) the cache is kept under, the least recently used files are removed past it")
+        .default_value(1024)
+        .scan<'i', int>()
+        .nargs(1);
+
+    program.add_argument("--stats")
+        .help("print where the time went (per phase), and the strings, hash lookups and allocations of the files")
+        .default_value(false)
+        .implicit_value(true);
     ///////////////////
 
     try
@@ -169,6 +449,14 @@ int main(int argc, char *argv[])
 
     auto symmetric = program.get<bool>("--symmetric");
 
+    LanguageMap langMap = program.is_used("--langmap") ? LanguageMap(program.get<std::string>("--langmap")) : LanguageMap();
+
+    // Only the library calls are inside the scope, the files are read before it.
+    bool showStats = program.get<bool>("--stats");
+    countAllocations = showStats;
+    Stats stats;
+    std::optional<StatsScope> statsScope;
+
     Version version;
     if (game == "H2016")
     {
@@ -203,33 +491,37 @@ int main(int argc, char *argv[])
         }
 
         std::vector<char> metaFileData = readFile(metaPath, true);
+        std::vector<char> inputFileData = readFile(inputPath);
         std::string output = "";
 
+        if (showStats)
+            statsScope.emplace(stats);
+
         if (type == "CLNG")
         {
-            output = CLNG::Convert(version, readFile(inputPath), std::string(metaFileData.begin(), metaFileData.end()),
-                program.is_used("--langmap") ? program.get<std::string>("--langmap") : ""
+            output = CLNG::Convert(version, inputFileData, std::string(metaFileData.begin(), metaFileData.end()),
+                langMap
             );
         }
         else if (type == "DITL")
         {
-            output = DITL::Convert(readFile(inputPath), std::string(metaFileData.begin(), metaFileData.end()));
+            output = DITL::Convert(inputFileData, std::string(metaFileData.begin(), metaFileData.end()));
         }
         else if (type == "DLGE")
         {
-            output = DLGE::Convert(version, readFile(inputPath), std::string(metaFileData.begin(), metaFileData.end()),
-                defLocale, hexPrecision, program.is_used("--langmap") ? program.get<std::string>("--langmap") : ""
+            output = DLGE::Convert(version, inputFileData, std::string(metaFileData.begin(), metaFileData.end()),
+                defLocale, hexPrecision, langMap
             );
         }
         else if (type == "LOCR")
         {
-            output = LOCR::Convert(version, readFile(inputPath), std::string(metaFileData.begin(), metaFileData.end()),
-                program.is_used("--langmap") ? program.get<std::string>("--langmap") : "", symmetric
+            output = LOCR::Convert(version, inputFileData, std::string(metaFileData.begin(), metaFileData.end()),
+                langMap, symmetric
             );
         }
         else if (type == "RTLV")
         {
-            output = RTLV::Convert(version, readFile(inputPath), std::string(metaFileData.begin(), metaFileData.end()));
+            output = RTLV::Convert(version, inputFileData, std::string(metaFileData.begin(), metaFileData.end()));
         }
         else
         {
@@ -238,6 +530,8 @@ int main(int argc, char *argv[])
             return 1;
         }
 
+        statsScope.reset();
+
         if (output.empty()) {
             LOG("Failed to convert " << type << " to JSON!");
             return 1;
@@ -252,7 +546,31 @@ int main(int argc, char *argv[])
         std::vector<char> inputFileData = readFile(inputPath);
         Rebuilt output{};
 
-        if (type == "CLNG")
+        std::optional<RebuildCache> cache;
+        std::string cacheKey;
+        if (program.is_used("--cache"))
+        {
+            Job job;
+            job.version = version;
+            job.type = type;
+            job.langMap = langMap;
+            job.defaultLocale = defLocale;
+            job.symmetric = symmetric;
+
+            cache.emplace(program.get<std::string>("--cache"), (uint64_t)std::max(1, program.get<int>("--cachesize")) << 20);
+            // Nothing reloads the hash list during a single run, the default context is the one the rebuild uses.
+            cacheKey = cache->key(job, std::string_view(inputFileData.data(), inputFileData.size()), HashListContext::Default());
+        }
+
+        bool cached = cache && cache->get(cacheKey, output);
+        if (showStats && !cached)
+            statsScope.emplace(stats);
+
+        if (cached)
+        {
+            LOG("Found " << type << " in the cache!");
+        }
+        else if (type == "CLNG")
         {
             output = CLNG::Rebuild(std::string(inputFileData.begin(), inputFileData.end()));
         }
@@ -263,7 +581,7 @@ int main(int argc, char *argv[])
         else if (type == "DLGE")
         {
             output = DLGE::Rebuild(version, std::string(inputFileData.begin(), inputFileData.end()), defLocale,
-                program.is_used("--langmap") ? program.get<std::string>("--langmap") : ""
+                langMap
             );
         }
         else if (type == "LOCR")
@@ -273,7 +591,7 @@ int main(int argc, char *argv[])
         else if (type == "RTLV")
         {
             output = RTLV::Rebuild(version, std::string(inputFileData.begin(), inputFileData.end()),
-                program.is_used("--langmap") ? program.get<std::string>("--langmap") : ""
+                langMap
             );
         }
         else
@@ -282,11 +600,16 @@ int main(int argc, char *argv[])
             return 1;
         }
 
+        statsScope.reset();
+
         if (output.file.empty() || output.meta.empty()) {
             LOG("Failed to convert JSON to " << type << "!");
             return 1;
         }
 
+        if (cache && !cached)
+            cache->put(cacheKey, output);
+
         writeFile(outPath, output.file.data(), output.file.size());
         writeFile(metaPath, output.meta.data(), output.meta.size());
 
@@ -298,5 +621,8 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    if (showStats)
+        LOG(formatStats(stats, 1));
+
     return 0;
 }
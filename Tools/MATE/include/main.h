@@ -5,5 +5,5 @@
 #include <vector>
 #include <format>
 
-#include "buffer.hpp"
+#include <TonyTools/BinaryIO.h>
 #include "glob.h"
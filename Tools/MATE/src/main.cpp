@@ -3,10 +3,12 @@
 #include <vector>
 #include <format>
 
-#include "buffer.hpp"
+#include <TonyTools/BinaryIO.h>
 #include "glob.h"
 #include <assert.h>
 
+using namespace TonyTools;
+
 #pragma pack(push, 1)
 enum FXShaderType : uint32_t {
     FX_SHADER_TYPE_VERTEX_SHADER = 0,
@@ -69,7 +71,7 @@ public:
     uint8_t unk2; // Presumed to be unused
     uint32_t nMagicEnd;
 
-    FX2ProgramHeader(buffer& buff, bool tags = false) {
+    FX2ProgramHeader(BinaryIO::Reader& buff, bool tags = false) {
         hasTags = tags;
 
         nMagicStart = buff.read<uint32_t>();
@@ -120,7 +122,7 @@ public:
     uint64_t unk6 = 0; // Only in patch2+ // Only in patch2+
     uint32_t nMagicEnd;
 
-    FX3ProgramHeader(buffer& buff) {
+    FX3ProgramHeader(BinaryIO::Reader& buff) {
         nMagicStart = buff.read<uint32_t>();
         nNameOffset = buff.read<uint32_t>();
         eProgramType = buff.read<FXShaderType>();
@@ -182,9 +184,9 @@ public:
     uint32_t nOffset;
     uint32_t nSize;
 
-    FX2Desc(buffer& buff) {
+    FX2Desc(BinaryIO::Reader& buff) {
         FX2ConstantDesc desc = buff.read<FX2ConstantDesc>();
-        name = buff.read<std::string>(desc.nNameOffset);
+        name = buff.readStringAt(desc.nNameOffset);
         nType = desc.nType;
         nOffset = desc.nOffset;
         nSize = desc.nSize;
@@ -208,18 +210,18 @@ public:
     std::string name;
     std::vector<uint32_t> shaders;
 
-    FXPass(buffer& buff, bool isNewPass = false) {
+    FXPass(BinaryIO::Reader& buff, bool isNewPass = false) {
         if (isNewPass) {
             isNewVer = true;
 
             // Technically we should read the header and then go from there,
             // but our buffer library allows us to read a u32 first, then a vector
             // of that amount.
-            name = buff.read<std::string>(buff.read<uint32_t>());
-            shaders = buff.read<std::vector<uint32_t>>();
+            name = buff.readStringAt(buff.read<uint32_t>());
+            shaders = buff.readVector<uint32_t>();
         } else {
             FX2PassDesc bin = buff.read<FX2PassDesc>();
-            name = buff.read<std::string>(bin.nNameOffset);
+            name = buff.readStringAt(bin.nNameOffset);
             for (uint32_t shader : bin.pShader) {
                 if (shader != -1)
                     shaders.push_back(shader);
@@ -239,14 +241,14 @@ public:
     std::vector<FX2Desc> constants;
     std::vector<FX2Desc> textures;
 
-    FX2Program(buffer& buff, bool tags = false) {
+    FX2Program(BinaryIO::Reader& buff, bool tags = false) {
         FX2ProgramHeader hdr = FX2ProgramHeader(buff, tags);
         
-        buff.save();
+        size_t oldIndex = buff.index;
 
-        name = buff.read<std::string>(hdr.nNameOffset);
+        name = buff.readStringAt(hdr.nNameOffset);
         type = hdr.eProgramType;
-        bytecode = buff.read<std::vector<char>>(hdr.nProgramOffset, hdr.nProgramSize);
+        bytecode = buff.readArrayAt<char>(hdr.nProgramOffset, hdr.nProgramSize);
 
         if (hdr.nNumConstants) {
             buff.index = hdr.nConstantDescOffset;
@@ -262,7 +264,7 @@ public:
                 textures.push_back(FX2Desc(buff));
         }
 
-        buff.load();
+        buff.index = oldIndex;
     }
 };
 
@@ -271,19 +273,19 @@ public:
     std::string name;
     std::vector<FXPass> passes;
 
-    FXTechnique(buffer& buff, bool isNewPass = false) {
+    FXTechnique(BinaryIO::Reader& buff, bool isNewPass = false) {
         FXTechniqueHeader hdr = buff.read<FXTechniqueHeader>();
         
-        buff.save();
+        size_t oldIndex = buff.index;
 
-        name = buff.read<std::string>(hdr.nNameOffset);
+        name = buff.readStringAt(hdr.nNameOffset);
         
         buff.index = hdr.nPassStartOffset;
 
         for (int i = 0; i < hdr.nPasses; i++)
             passes.push_back(FXPass(buff, isNewPass));
     
-        buff.load();
+        buff.index = oldIndex;
     }
 };
 
@@ -295,16 +297,16 @@ public:
     std::vector<FX2Desc> constants;
     std::vector<FX2Desc> textures;
 
-    FX3Program(buffer& buff) {
+    FX3Program(BinaryIO::Reader& buff) {
         FX3ProgramHeader hdr(buff);
 
         // We have to skip 4 bytes otherwise the next read will be wrong.
         // This is probably down to alignment of some sort as the value is always 0.
         buff.index += 4;
         
-        buff.save();
+        size_t oldIndex = buff.index;
 
-        name = buff.read<std::string>(hdr.nNameOffset);
+        name = buff.readStringAt(hdr.nNameOffset);
 
         if (hdr.eProgramType > 6) {
             printf("%s %d\n", "New shader type found!", hdr.eProgramType);
@@ -312,7 +314,7 @@ public:
         }
 
         type = hdr.eProgramType;
-        bytecode = buff.read<std::vector<char>>(hdr.nProgramOffset, hdr.nProgramSize);
+        bytecode = buff.readArrayAt<char>(hdr.nProgramOffset, hdr.nProgramSize);
 
         if (hdr.nNumConstants) {
             buff.index = hdr.nConstantDescOffset;
@@ -328,7 +330,7 @@ public:
                 textures.push_back(FX2Desc(buff));
         }
 
-        buff.load();
+        buff.index = oldIndex;
     }
 };
 
@@ -339,7 +341,7 @@ public:
     uint32_t texStatesOffset;
 
     // The tags variable is equivalent to the use of the new pass format.
-    FX2Shader(buffer& buff, bool tags = false) {
+    FX2Shader(BinaryIO::Reader& buff, bool tags = false) {
         FX2Header hdr = buff.read<FX2Header>();
         
         texStatesOffset = hdr.nTextureStatesOffset;
@@ -364,7 +366,7 @@ public:
     std::vector<FXTechnique> techniques;
     std::vector<std::string> textureStates;
 
-    FX3Shader(buffer& buff) {
+    FX3Shader(BinaryIO::Reader& buff) {
         FX3Header hdr = buff.read<FX3Header>();
 
         if (hdr.nShaders) {
@@ -383,7 +385,7 @@ public:
         if (hdr.nTextureStates) {
             buff.index = hdr.nTextureStatesOffset;
             for (int i = 0; i < hdr.nTextureStates; i++)
-                textureStates.push_back(buff.read<std::string>(buff.read<uint32_t>()));
+                textureStates.push_back(buff.readStringAt(buff.read<uint32_t>()));
         }
     }
 };
@@ -403,14 +405,14 @@ int main(int argc, char *argv[])
     glob.use_full_paths(true);
     uint32_t shdrCount = 0;
     while (glob) {
-        file_buffer buff;
         std::string path = glob.current_match();
-        buff.loadf(path);
+        std::vector<char> file = BinaryIO::ReadFile(path);
+        BinaryIO::Reader fileBuff(file);
 
-        Header hdr = buff.read<Header>();
+        Header hdr = fileBuff.read<Header>();
 
-        buff.rebase(hdr.effectOffset);
-        buff.resize(hdr.effectSize);
+        // Offsets in the effect are relative to its start.
+        BinaryIO::Reader buff = fileBuff.sub(hdr.effectOffset, hdr.effectSize);
 
         FX3Shader shdr(buff);
 
@@ -11,4 +11,6 @@
 #include <cassert>
 #include <cmath>
 
-#include "buffer.hpp"
\ No newline at end of file
+#include <TonyTools/BinaryIO.h>
+
+using namespace TonyTools;
\ No newline at end of file
@@ -117,7 +117,7 @@ AnimDataOffsets generateOffsets(AnimDataHdr hdr)
     return offsets;
 }
 
-std::vector<Quaternion> readQuantQuatArr(file_buffer &buff, int numOfQuat)
+std::vector<Quaternion> readQuantQuatArr(BinaryIO::Reader &buff, int numOfQuat)
 {
     std::vector<Quaternion> quatArr;
     for (int i = 0; i < numOfQuat; i++)
@@ -131,7 +131,7 @@ std::vector<Quaternion> readQuantQuatArr(file_buffer &buff, int numOfQuat)
     return quatArr;
 }
 
-std::vector<Transform> readQuantTransArr(file_buffer &buff, int numOfTrans, Vector3 transScale)
+std::vector<Transform> readQuantTransArr(BinaryIO::Reader &buff, int numOfTrans, Vector3 transScale)
 {
     std::vector<Transform> transArr;
     for (int i = 0; i < numOfTrans; i++)
@@ -147,8 +147,8 @@ std::vector<Transform> readQuantTransArr(file_buffer &buff, int numOfTrans, Vect
 
 int main(int argc, char *argv[])
 {
-    file_buffer buff;
-    buff.load(argv[1]);
+    std::vector<char> file = BinaryIO::ReadFile(argv[1]);
+    BinaryIO::Reader buff(file);
 
     AnimDataHdr hdr = buff.read<AnimDataHdr>();
 
@@ -9,4 +9,6 @@
     std::cout << x << std::endl; \
     std::exit(0)
 
-#include "buffer.hpp"
\ No newline at end of file
+#include <TonyTools/BinaryIO.h>
+
+using namespace TonyTools;
\ No newline at end of file
@@ -34,8 +34,8 @@ struct SCDA
 
 int main(int argc, char *argv[])
 {
-    file_buffer buff;
-    buff.load(argv[1]);
+    std::vector<char> file = BinaryIO::ReadFile(argv[1]);
+    BinaryIO::Reader buff(file);
 
     SCDA scda{};
 
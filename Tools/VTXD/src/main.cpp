@@ -33,8 +33,8 @@ struct VTXD
 
 int main(int argc, char *argv[])
 {
-    file_buffer buff;
-    buff.load(argv[1]);
+    std::vector<char> file = BinaryIO::ReadFile(argv[1]);
+    BinaryIO::Reader buff(file);
 
     VTXD vtxd{};
 